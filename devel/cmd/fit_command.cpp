@@ -1,9 +1,11 @@
 // $Id:$
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 
+# include <cstring>
+# include <algorithm>
 # include <dismod_at/fit_command.hpp>
 # include <dismod_at/error_exit.hpp>
 # include <dismod_at/get_prior_sim_table.hpp>
@@ -16,6 +18,7 @@
 # include <dismod_at/blob_table.hpp>
 # include <dismod_at/pack_warm_start.hpp>
 # include <dismod_at/get_str_map.hpp>
+# include <dismod_at/process_team.hpp>
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 /*
@@ -37,6 +40,7 @@ Syntax
 | ``dismod_at`` *database* ``fit`` *variables* *simulate_index*
 | ``dismod_at`` *database* ``fit`` *variables* ``warm_start``
 | ``dismod_at`` *database* ``fit`` *variables* *simulate_index* ``warm_start``
+| ``dismod_at`` *database* ``fit`` *variables* ``sim_range`` *first* *last*
 
 database
 ********
@@ -111,6 +115,37 @@ All the rest of the prior table values
 are the same as when *simulated_index* is not present; e.g.,
 :ref:`prior_table@std` comes from the prior table.
 
+sim_range
+*********
+If ``sim_range`` *first* *last* is present,
+the simulated data sets with
+*simulate_index* equal to *first* through *last* (inclusive) are fit.
+It must hold that *first* <= *last* and
+*last* is less than :ref:`simulate_command@number_simulate` .
+The database is read, and the data and prior models are constructed, once.
+The :ref:`data_sim_table@data_sim_value` and
+:ref:`prior_sim_table@prior_sim_value` are replaced for each simulated
+data set (as in the *simulate_index* case above).
+
+#.  The option table :ref:`option_table@thread_count` is the number of
+    simulated data sets that are fit at the same time.
+    If it is greater than one, the fits are run by that many
+    child processes (because cppad_mixed and Ipopt are not thread safe).
+    Each process has its own copy of the data and prior models
+    and runs its fits in order of *simulate_index* .
+#.  The functions that cppad_mixed uses are recorded for each fit
+    because they depend on the simulated data values.
+    They are recorded the same way for any *thread_count* ; e.g.,
+    :ref:`option_table@tape_by_child` applies to each fit.
+    The :ref:`option_table@tape_cache` option is not used when
+    the fits are run by child processes.
+#.  The results are written to the :ref:`fit_var_sim_table-name`
+    in order of *simulate_index* (for any number of processes).
+    None of the other output tables are written.
+    If a fit fails, the error for the smallest *simulate_index*
+    that failed is reported.
+#.  The ``warm_start`` argument cannot be used with ``sim_range`` .
+
 warm_start
 **********
 If ``warm_start`` is at the end of the command, the
@@ -242,6 +277,109 @@ using this command.
 {xrst_end fit_command}
 */
 
+namespace { // BEGIN_EMPTY_NAMESPACE
+    using std::string;
+    using CppAD::vector;
+    //
+    // check_variables
+    void check_variables(const string& variables)
+    {   bool ok = variables == "fixed";
+        ok     |= variables == "random";
+        ok     |= variables == "both";
+        if( ! ok )
+        {   string msg = "dismod_at fit command variables = ";
+            msg += variables + "\nis not 'fixed', 'random' or 'both'";
+            dismod_at::error_exit(msg);
+        }
+    }
+    //
+    // get_bound_random
+    double get_bound_random(
+        const string&                            variables  ,
+        const std::map<string, string>&          option_map )
+    {   double bound_random = 0.0;
+        if( variables != "fixed" )
+        {   // null corresponds to infinity
+            string tmp_str = dismod_at::get_str_map(option_map, "bound_random");
+            if( tmp_str == "" )
+                bound_random = std::numeric_limits<double>::infinity();
+            else
+                bound_random = std::atof( tmp_str.c_str() );
+        }
+        return bound_random;
+    }
+    //
+    // get_zero_sum_child_rate
+    vector<bool> get_zero_sum_child_rate(
+        const std::map<string, string>&          option_map )
+    {   const string& option =
+            dismod_at::get_str_map(option_map, "zero_sum_child_rate");
+        size_t n_rate      = size_t(dismod_at::number_rate_enum);
+        vector<bool> zero_sum_child_rate(n_rate);
+        for(size_t rate_id = 0; rate_id < n_rate; rate_id++)
+        {   string rate_name = dismod_at::get_rate_name(rate_id);
+            size_t found     = option.find( rate_name );
+            zero_sum_child_rate[rate_id] = found < option.size();
+        }
+        return zero_sum_child_rate;
+    }
+    //
+    // get_zero_sum_mulcov_group
+    vector<bool> get_zero_sum_mulcov_group(
+        const std::map<string, string>&          option_map     ,
+        const dismod_at::pack_info&              pack_object    ,
+        const vector<dismod_at::subgroup_struct>& subgroup_table )
+    {   const string& option =
+            dismod_at::get_str_map(option_map, "zero_sum_mulcov_group");
+        size_t n_group = pack_object.group_size();
+        vector<bool> zero_sum_mulcov_group(n_group);
+        for(size_t group_id = 0; group_id < n_group; group_id++)
+        {   size_t first_subgroup_id = pack_object.first_subgroup_id(group_id);
+            string group_name = subgroup_table[first_subgroup_id].group_name;
+            size_t found      = option.find(group_name);
+            zero_sum_mulcov_group[group_id] = found < option.size();
+        }
+        return zero_sum_mulcov_group;
+    }
+    //
+    // get_random_const
+    dismod_at::remove_const get_random_const(
+        const dismod_at::pack_info&              pack_object ,
+        const dismod_at::pack_prior&             var2prior   ,
+        const vector<dismod_at::prior_struct>&   prior_table )
+    {   size_t n_var    = pack_object.size();
+        size_t n_random = pack_object.random_size();
+        CppAD::mixed::d_vector var_lower(n_var), var_upper(n_var);
+        dismod_at::get_var_limits(
+            var_lower, var_upper, var2prior, prior_table
+        );
+        CppAD::mixed::d_vector random_lower(n_random);
+        CppAD::mixed::d_vector random_upper(n_random);
+        dismod_at::unpack_random(pack_object, var_lower, random_lower);
+        dismod_at::unpack_random(pack_object, var_upper, random_upper);
+        return dismod_at::remove_const(random_lower, random_upper);
+    }
+    //
+    // get_prior_sim_mean
+    // prior means corresponding to one simulate index
+    vector<double> get_prior_sim_mean(
+        size_t                                       sim_index       ,
+        const vector<dismod_at::prior_sim_struct>&   prior_sim_table ,
+        size_t                                       n_var           )
+    {   vector<double> prior_mean(n_var * 3);
+        for(size_t var_id = 0; var_id < n_var; ++var_id)
+        {   size_t prior_sim_id = sim_index * n_var + var_id;
+            prior_mean[var_id * 3 + 0] =
+                prior_sim_table[prior_sim_id].prior_sim_value;
+            prior_mean[var_id * 3 + 1] =
+                prior_sim_table[prior_sim_id].prior_sim_dage;
+            prior_mean[var_id * 3 + 2] =
+                prior_sim_table[prior_sim_id].prior_sim_dtime;
+        }
+        return prior_mean;
+    }
+} // END_EMPTY_NAMESPACE
+
 // ----------------------------------------------------------------------------
 // subset_data_obj and prior_object are const when simulate_index == ""
 void fit_command(
@@ -262,14 +400,7 @@ void fit_command(
     using CppAD::to_string;
     using CppAD::vector;
     // -----------------------------------------------------------------------
-    bool ok = variables == "fixed";
-    ok     |= variables == "random";
-    ok     |= variables == "both";
-    if( ! ok )
-    {   string msg = "dismod_at fit command variables = ";
-        msg += variables + "\nis not 'fixed', 'random' or 'both'";
-        dismod_at::error_exit(msg);
-    }
+    check_variables(variables);
     if( use_warm_start && variables == "random" )
     {   string msg = "dismod_at fit command: cannot warm start when ";
         msg       += "only optimizing random effects";
@@ -277,15 +408,7 @@ void fit_command(
     }
     //
     // bound_random
-    double bound_random = 0.0;
-    if( variables != "fixed" )
-    {   // null corresponds to infinity
-        std::string tmp_str = get_str_map(option_map, "bound_random");
-        if( tmp_str == "" )
-            bound_random = std::numeric_limits<double>::infinity();
-        else
-            bound_random = std::atof( tmp_str.c_str() );
-    }
+    double bound_random = get_bound_random(variables, option_map);
     // random_only
     bool random_only = variables == "random";
     // simulation index corresponding to data
@@ -311,16 +434,8 @@ void fit_command(
             dismod_at::error_exit(msg, table_name);
         }
         // vector used for replacement of prior means
-        vector<double> prior_mean(n_var * 3);
-        for(size_t var_id = 0; var_id < n_var; ++var_id)
-        {   size_t prior_sim_id = sim_index * n_var + var_id;
-            prior_mean[var_id * 3 + 0] =
-                prior_sim_table[prior_sim_id].prior_sim_value;
-            prior_mean[var_id * 3 + 1] =
-                prior_sim_table[prior_sim_id].prior_sim_dage;
-            prior_mean[var_id * 3 + 2] =
-                prior_sim_table[prior_sim_id].prior_sim_dtime;
-        }
+        vector<double> prior_mean =
+            get_prior_sim_mean(sim_index, prior_sim_table, n_var);
         prior_object.replace_mean(prior_mean);
 
         // replace meas_value in subset_data_obj
@@ -353,42 +468,17 @@ void fit_command(
     dismod_at::get_table_column(db, table_name, column_name, scale_var);
     // ----------------------------------------------------------------------
     // zero_sum_child_rate
-    size_t n_rate      = size_t(dismod_at::number_rate_enum);
-    size_t option_size = get_str_map(option_map, "zero_sum_child_rate").size();
-    vector<bool> zero_sum_child_rate(n_rate);
-    for(size_t rate_id = 0; rate_id < n_rate; rate_id++)
-    {   string rate_name = dismod_at::get_rate_name(rate_id);
-        size_t found     =
-            get_str_map(option_map, "zero_sum_child_rate").find( rate_name );
-        zero_sum_child_rate[rate_id] = found < option_size;
-    }
+    vector<bool> zero_sum_child_rate = get_zero_sum_child_rate(option_map);
     // ----------------------------------------------------------------------
     // zero_sum_mulcov_group
-    size_t n_group = pack_object.group_size();
-    option_size    = get_str_map(option_map, "zero_sum_mulcov_group").size();
-    vector<bool> zero_sum_mulcov_group(n_group);
-    for(size_t group_id = 0; group_id < n_group; group_id++)
-    {   const vector<subgroup_struct>&
-            subgroup_table( db_input.subgroup_table );
-        size_t first_subgroup_id = pack_object.first_subgroup_id(group_id);
-        string group_name = subgroup_table[first_subgroup_id].group_name;
-        size_t found =
-            get_str_map(option_map, "zero_sum_mulcov_group").find(group_name);
-        zero_sum_mulcov_group[group_id] = found < option_size;
-    }
+    vector<bool> zero_sum_mulcov_group = get_zero_sum_mulcov_group(
+        option_map, pack_object, db_input.subgroup_table
+    );
     // ----------------------------------------------------------------------
     // random_const
-    size_t n_var    = pack_object.size();
-    size_t n_random = pack_object.random_size();
-    CppAD::mixed::d_vector var_lower(n_var), var_upper(n_var);
-    get_var_limits(
-        var_lower, var_upper, var2prior, db_input.prior_table
-    );
-    CppAD::mixed::d_vector random_lower(n_random);
-    CppAD::mixed::d_vector random_upper(n_random);
-    unpack_random(pack_object, var_lower, random_lower);
-    unpack_random(pack_object, var_upper, random_upper);
-    remove_const random_const(random_lower, random_upper);
+    size_t n_var = pack_object.size();
+    remove_const random_const =
+        get_random_const(pack_object, var2prior, db_input.prior_table);
     //
     // warm_start_in
     CppAD::mixed::warm_start_struct warm_start_in;
@@ -418,6 +508,10 @@ void fit_command(
     // warn_on_stderr
     bool warn_on_stderr = get_str_map(option_map, "warn_on_stderr") == "true";
     //
+    // tape_by_child, tape_cache
+    bool tape_by_child = get_str_map(option_map, "tape_by_child") == "true";
+    bool tape_cache    = get_str_map(option_map, "tape_cache") == "true";
+    //
     dismod_at::fit_model fit_object(
         db                   ,
         simulation_index     ,
@@ -434,7 +528,9 @@ void fit_command(
         zero_sum_child_rate  ,
         zero_sum_mulcov_group,
         data_object          ,
-        trace_init
+        trace_init           ,
+        tape_by_child        ,
+        tape_cache
     );
     fit_object.run_fit(random_only, option_map, warm_start_in);
     vector<double> opt_value, lag_value, lag_dage, lag_dtime;
@@ -641,18 +737,15 @@ void fit_command(
     col_type[1]   = "real";
     col_unique[1] = false;
     //
+    // average integrand and residual for each data item
+    vector<double> avg_vec, not_used;
+    vector< dismod_at::residual_struct<double> > residual_vec;
+    data_object.like_all_avg(opt_value, avg_vec, not_used, residual_vec);
     for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
-    {   // compute average integrand for this data item
-        double avg = data_object.average(subset_id, opt_value);
-        assert( ! CppAD::isnan(avg) );
-
-        // compute its residual and log likelihood
-        double not_used;
-        dismod_at::residual_struct<double> residual =
-            data_object.like_one(subset_id, opt_value, avg, not_used);
-        //
-        row_value[ subset_id * n_col + 0] = to_string( avg );
-        row_value[ subset_id * n_col + 1] = to_string( residual.wres );
+    {   assert( ! CppAD::isnan( avg_vec[subset_id] ) );
+        row_value[ subset_id * n_col + 0] = to_string( avg_vec[subset_id] );
+        row_value[ subset_id * n_col + 1] =
+            to_string( residual_vec[subset_id].wres );
     }
     dismod_at::create_table(
         db, table_name, col_name, col_type, col_unique, row_value
@@ -716,5 +809,200 @@ void fit_command(
 
     return;
 }
+// ----------------------------------------------------------------------------
+// fit a range of simulated data sets
+void fit_sim_range_command(
+    const std::string&                                  variables        ,
+    const std::string&                                  first_str        ,
+    const std::string&                                  last_str         ,
+    sqlite3*                                            db               ,
+    const CppAD::vector<dismod_at::subset_data_struct>& subset_data_obj  ,
+    const dismod_at::data_model&                        data_object      ,
+    const dismod_at::prior_model&                       prior_object     ,
+    const dismod_at::pack_info&                         pack_object      ,
+    const dismod_at::pack_prior&                        var2prior        ,
+    const dismod_at::db_input_struct&                   db_input         ,
+    const std::map<std::string, std::string>&           option_map
+)
+{   using std::string;
+    using CppAD::vector;
+    // -----------------------------------------------------------------------
+    check_variables(variables);
+    //
+    // data_sim_table, prior_sim_table
+    vector<dismod_at::data_sim_struct> data_sim_table =
+        dismod_at::get_data_sim_table(db);
+    vector<dismod_at::prior_sim_struct> prior_sim_table =
+        dismod_at::get_prior_sim_table(db);
+    //
+    // n_var, n_subset, n_simulate
+    size_t n_var      = pack_object.size();
+    size_t n_subset   = subset_data_obj.size();
+    size_t n_simulate = prior_sim_table.size() / n_var;
+    //
+    // first, last
+    int first = std::atoi( first_str.c_str() );
+    int last  = std::atoi( last_str.c_str() );
+    if( first < 0 || last < first || size_t(last) >= n_simulate )
+    {   string msg = "dismod_at fit command: sim_range first = ";
+        msg += first_str + ", last = " + last_str + "\n";
+        msg += "is not a valid range of simulate_index values ";
+        msg += "for the data_sim table.";
+        string table_name = "data_sim";
+        dismod_at::error_exit(msg, table_name);
+    }
+    size_t n_fit = size_t(last - first + 1);
+    //
+    // start_var, scale_var
+    vector<double> start_var, scale_var;
+    dismod_at::get_table_column(db, "start_var", "start_var_value", start_var);
+    dismod_at::get_table_column(db, "scale_var", "scale_var_value", scale_var);
+    //
+    // bound_random, random_only
+    double bound_random = get_bound_random(variables, option_map);
+    bool   random_only  = variables == "random";
+    //
+    // zero_sum_child_rate, zero_sum_mulcov_group
+    vector<bool> zero_sum_child_rate = get_zero_sum_child_rate(option_map);
+    vector<bool> zero_sum_mulcov_group = get_zero_sum_mulcov_group(
+        option_map, pack_object, db_input.subgroup_table
+    );
+    //
+    // random_const
+    remove_const random_const =
+        get_random_const(pack_object, var2prior, db_input.prior_table);
+    //
+    // quasi_fixed, trace_init, warn_on_stderr, tape_by_child, tape_cache
+    bool quasi_fixed = get_str_map(option_map, "quasi_fixed") == "true";
+    bool trace_init  =
+        get_str_map(option_map, "trace_init_fit_model") == "true";
+    bool warn_on_stderr = get_str_map(option_map, "warn_on_stderr") == "true";
+    bool tape_by_child  = get_str_map(option_map, "tape_by_child") == "true";
+    bool tape_cache     = get_str_map(option_map, "tape_cache") == "true";
+    //
+    // n_process
+    size_t n_process = std::atoi(
+        get_str_map(option_map, "thread_count").c_str()
+    );
+    n_process = std::max( size_t(1), std::min(n_process, n_fit) );
+    //
+    // fit_subset, fit_data, fit_prior
+    // each child process has its own copy of these objects
+    vector<dismod_at::subset_data_struct> fit_subset(subset_data_obj);
+    dismod_at::data_model  fit_data(data_object);
+    dismod_at::prior_model fit_prior(prior_object);
+    fit_data.set_thread_count(1);
+    //
+    // work
+    // fit one simulated data set and return the optimal variable values
+    auto work = [&](size_t i_fit, sqlite3* fit_db)
+    {   size_t sim_index = size_t(first) + i_fit;
+        //
+        // fit_prior
+        vector<double> prior_mean =
+            get_prior_sim_mean(sim_index, prior_sim_table, n_var);
+        fit_prior.replace_mean(prior_mean);
+        //
+        // fit_data
+        for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
+        {   size_t data_sim_id = n_subset * sim_index + subset_id;
+            fit_subset[subset_id].data_sim_value =
+                data_sim_table[data_sim_id].data_sim_value;
+        }
+        fit_data.replace_like(fit_subset);
+        //
+        // fit_object
+        dismod_at::fit_model fit_object(
+            fit_db               ,
+            int(sim_index)       ,
+            warn_on_stderr       ,
+            bound_random         ,
+            pack_object          ,
+            var2prior            ,
+            start_var            ,
+            scale_var            ,
+            db_input.prior_table ,
+            fit_prior            ,
+            random_const         ,
+            quasi_fixed          ,
+            zero_sum_child_rate  ,
+            zero_sum_mulcov_group,
+            fit_data             ,
+            trace_init           ,
+            tape_by_child        ,
+            tape_cache
+        );
+        CppAD::mixed::warm_start_struct warm_start_in;
+        fit_object.run_fit(random_only, option_map, warm_start_in);
+        //
+        // opt_value
+        vector<double> opt_value, lag_value, lag_dage, lag_dtime;
+        vector<CppAD::mixed::trace_struct> trace_vec;
+        CppAD::mixed::warm_start_struct warm_start_out;
+        fit_object.get_solution(
+            opt_value, lag_value, lag_dage, lag_dtime, trace_vec, warm_start_out
+        );
+        assert( opt_value.size() == n_var );
+        return string(
+            reinterpret_cast<const char*>( opt_value.data() ),
+            n_var * sizeof(double)
+        );
+    };
+    vector<string>                result;
+    dismod_at::log_message_struct error;
+    size_t error_task = dismod_at::process_team(
+        db, n_process, n_fit, work, result, error
+    );
+    if( error_task < n_fit )
+        dismod_at::error_exit(error.message, error.table_name, error.row_id);
+    //
+    // fit_var_value
+    vector<double> fit_var_value(n_fit * n_var);
+    for(size_t i_fit = 0; i_fit < n_fit; ++i_fit)
+    {   assert( result[i_fit].size() == n_var * sizeof(double) );
+        std::memcpy(
+            fit_var_value.data() + i_fit * n_var,
+            result[i_fit].data(),
+            n_var * sizeof(double)
+        );
+    }
+    // -------------------- fit_var_sim table ---------------------------------
+    string sql_cmd = "drop table if exists fit_var_sim";
+    dismod_at::exec_sql_cmd(db, sql_cmd);
+    //
+    string table_name = "fit_var_sim";
+    size_t n_col      = 3;
+    size_t n_row      = n_fit * n_var;
+    vector<string> col_name(n_col), col_type(n_col);
+    vector<bool>   col_unique(n_col);
+    vector<dismod_at::column_value_struct> col_value(n_col);
+    //
+    col_name[0]   = "simulate_index";
+    col_type[0]   = "integer";
+    col_unique[0] = false;
+    //
+    col_name[1]   = "var_id";
+    col_type[1]   = "integer";
+    col_unique[1] = false;
+    //
+    col_name[2]   = "fit_var_value";
+    col_type[2]   = "real";
+    col_unique[2] = false;
+    //
+    col_value[0].int_value.resize(n_row);
+    col_value[1].int_value.resize(n_row);
+    for(size_t i_fit = 0; i_fit < n_fit; ++i_fit)
+    {   for(size_t var_id = 0; var_id < n_var; ++var_id)
+        {   size_t fit_var_sim_id = i_fit * n_var + var_id;
+            col_value[0].int_value[fit_var_sim_id] = first + int(i_fit);
+            col_value[1].int_value[fit_var_sim_id] = int(var_id);
+        }
+    }
+    col_value[2].real_value = fit_var_value;
+    dismod_at::create_table(
+        db, table_name, col_name, col_type, col_unique, col_value
+    );
+    return;
+}
 
 } // END_DISMOD_AT_NAMESPACE
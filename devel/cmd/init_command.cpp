@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 
 # include <dismod_at/init_command.hpp>
@@ -195,11 +195,13 @@ void init_command(
         "depend_var",
         "fit_data_subset",
         "fit_var",
+        "fit_var_sim",
         "hes_fixed",
         "hes_random",
         "ipopt_info",
         "mixed_info",
         "predict",
+        "predict_summary",
         "prior_sim",
         "sample",
         "scale_var",
@@ -3,14 +3,112 @@
 // SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 
+# include <algorithm>
+# include <cmath>
+# include <cstdlib>
+# include <limits>
+# include <vector>
 # include <cppad/mixed/exception.hpp>
 # include <dismod_at/predict_command.hpp>
 # include <dismod_at/error_exit.hpp>
 # include <dismod_at/get_table_column.hpp>
-# include <dismod_at/get_sample_table.hpp>
+# include <dismod_at/check_table_id.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
 # include <dismod_at/create_table.hpp>
 # include <dismod_at/censor_var_limit.hpp>
+# include <dismod_at/null_int.hpp>
+# include <dismod_at/p2_quantile.hpp>
+# include <dismod_at/split_space.hpp>
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    // summary_statistics
+    // mean, standard deviation, and quantiles for a sequence of values
+    // that are computed without storing the sequence
+    class summary_statistics {
+    private:
+        size_t count_;
+        double mean_;
+        double sum_sq_;
+    public:
+        // quantile[i] estimates the quantile for level[i]
+        std::vector<dismod_at::p2_quantile> quantile;
+        summary_statistics(const CppAD::vector<double>& level)
+        : count_(0), mean_(0.0), sum_sq_(0.0)
+        {   for(size_t i = 0; i < level.size(); ++i)
+                quantile.push_back( dismod_at::p2_quantile( level[i] ) );
+        }
+        // add the next value (Welford's method for mean and variance)
+        void add(double x)
+        {   ++count_;
+            double delta = x - mean_;
+            mean_       += delta / double(count_);
+            sum_sq_     += delta * (x - mean_);
+            for(size_t i = 0; i < quantile.size(); ++i)
+                quantile[i].add(x);
+        }
+        double mean(void) const
+        {   if( count_ == 0 )
+                return std::numeric_limits<double>::quiet_NaN();
+            return mean_;
+        }
+        double std_dev(void) const
+        {   if( count_ < 2 )
+                return std::numeric_limits<double>::quiet_NaN();
+            return std::sqrt( sum_sq_ / double(count_ - 1) );
+        }
+    };
+    //
+    // max_chunk_value
+    // maximum number of variable values read from the source table,
+    // and of predicted values, for one chunk of samples
+    const size_t max_chunk_value = 1 << 20;
+    //
+    // zero_meas_value_var
+    // censor pack_vec to its limits and zero its meas_value covariate
+    // multipliers
+    void zero_meas_value_var(
+        CppAD::vector<double>&            pack_vec    ,
+        const dismod_at::db_input_struct& db_input    ,
+        const dismod_at::pack_info&       pack_object ,
+        const dismod_at::pack_prior&      var2prior   )
+    {   //
+        // pack_vec
+        dismod_at::censor_var_limit(
+            pack_vec,
+            pack_vec,
+            var2prior,
+            db_input.prior_table
+        );
+        //
+        // pack_vec
+        dismod_at::pack_info::subvec_info info;
+        size_t n_int = db_input.integrand_table.size();
+        for(size_t integrand_id = 0; integrand_id < n_int; ++integrand_id)
+        {   size_t n_cov = pack_object.group_meas_value_n_cov(integrand_id);
+            for(size_t j = 0; j < n_cov; ++j)
+            {   info = pack_object.group_meas_value_info(integrand_id, j);
+                for(size_t k = 0; k < info.n_var; ++k)
+                {   size_t var_id = info.offset + k;
+                    pack_vec[var_id] = 0.0;
+                }
+            }
+            n_cov = pack_object.subgroup_meas_value_n_cov(integrand_id);
+            for(size_t j = 0; j < n_cov; ++j)
+            {   size_t n_sub =
+                    pack_object.subgroup_meas_value_n_sub(integrand_id, j);
+                for(size_t k = 0; k < n_sub; ++k)
+                {   info = pack_object.subgroup_meas_value_info(
+                        integrand_id, j, k
+                    );
+                    for(size_t ell = 0; ell < info.n_var; ++ell)
+                    {   size_t var_id = info.offset + ell;
+                        pack_vec[var_id] = 0.0;
+                    }
+                }
+            }
+        }
+    }
+} // END_EMPTY_NAMESPACE
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 /*
@@ -27,6 +125,7 @@ Syntax
 | ``dismod_at`` *database* ``predict`` *source*  ``fit_var`` *scale*
 | ``dismod_at`` *database* ``predict`` *source* ``fit_var`` *scale*
   ``zero_meas_value``
+| ``dismod_at`` *database* ``predict`` *source* ... ``summary``
 
 database
 ********
@@ -89,10 +188,26 @@ The scaled samples are defined by
 
     scaled_sample(i,j) = fit_var(j)  + scale * ( sample(i,j)  - fit_var(j) )
 
+summary
+*******
+If ``summary`` is the last argument,
+*source* must be ``sample`` and ``...`` above denotes the other
+optional arguments (if any); i.e., ``fit_var`` *scale*
+and ``zero_meas_value`` .
+In this case the predict table is not created or modified.
+Instead, a new :ref:`predict_summary_table-name` is created.
+It contains the mean, standard deviation and quantiles,
+across the samples, of the average integrand for each *avgint_id* .
+The quantile levels are specified by the
+:ref:`option_table@predict_quantile` option.
+These statistics are computed as the samples are processed;
+i.e., the average integrand for each sample is not stored.
+This makes the output smaller by a factor of the number of samples.
 
 predict_table
 *************
-A new :ref:`predict_table-name` is created each time this command is run.
+A new :ref:`predict_table-name` is created each time this command is run
+(unless ``summary`` is present).
 It contains the
 :ref:`average integrand<avg_integrand@Average Integrand, A_i>`
 values for set of model variables
@@ -100,6 +215,24 @@ and each
 :ref:`predict_table@avgint_id`
 in the
 :ref:`predict_table@Avgint Subset` .
+
+thread_count
+************
+The samples are divided between the number of threads specified by
+:ref:`option_table@thread_count` .
+The predict table does not depend on the number of threads.
+
+Memory
+******
+The *source* table is read, and the predict table is written,
+in chunks of samples.
+Each chunk contains at most :math:`2^{20}` model variable values
+and at most :math:`2^{20}` predicted values
+(and at least one set of model variables).
+Thus the memory used by this command is bounded by the chunk size
+instead of growing with the number of samples.
+The predict table does not depend on the chunk size.
+
 {xrst_toc_hidden
     example/get_started/predict_command.py
 }
@@ -117,6 +250,8 @@ void predict_command(
     const std::string&                                    source              ,
     bool                                                  zero_meas_value     ,
     double                                                fit_var_scale       ,
+    bool                                                  summary             ,
+    const std::string&                                    predict_quantile    ,
     sqlite3*                                              db                  ,
     const dismod_at::db_input_struct&                     db_input            ,
     const dismod_at::pack_info&                           pack_object         ,
@@ -127,7 +262,6 @@ void predict_command(
 {
     using std::string;
     using CppAD::vector;
-    using CppAD::to_string;
     //
     if( source != "sample"
     &&  source != "fit_var"
@@ -142,6 +276,11 @@ void predict_command(
         msg        += "and source is not sample";
         dismod_at::error_exit(msg);
     }
+    if ( summary && source != "sample" )
+    {   string msg  = "dismod_at predict command: summary is present ";
+        msg        += "and source is not sample";
+        dismod_at::error_exit(msg);
+    }
 
     // ------------------------------------------------------------------------
     // n_var
@@ -161,8 +300,7 @@ void predict_command(
         );
     }
     // ------------------------------------------------------------------------
-    // n_sample, variable_value
-    vector<double> variable_value;
+    // table_name, column_name
     string table_name = source;
     string column_name;
     if( source == "sample" )
@@ -171,108 +309,24 @@ void predict_command(
         column_name = "fit_var_value";
     else
         column_name = "truth_var_value";
-    dismod_at::get_table_column(
-        db, table_name, column_name, variable_value
-    );
-    size_t n_sample = variable_value.size() / n_var;
-    assert( n_sample * n_var == variable_value.size() );
-    //
-    // variable_value
-    if( fit_var_scale != 1.0 )
-    {   size_t sample_id = 0;
-        for(size_t sample_index = 0; sample_index < n_sample; ++sample_index)
-        {   for(size_t var_id = 0; var_id < n_var; ++var_id)
-            {   double sample               = variable_value[sample_id];
-                double fit                  = fit_var_value[var_id];
-                variable_value[sample_id++] = fit + fit_var_scale * (sample - fit);
-            }
-        }
-    }
     //
-    // variable_value
-    if( zero_meas_value )
-    {   size_t sample_id = 0;
-        for(size_t sample_index = 0; sample_index < n_sample; ++sample_index)
-        {   //
-            // pack_vec
-            for(size_t var_id = 0; var_id < n_var; ++var_id)
-                pack_vec[var_id] = variable_value[sample_id++];
-            //
-            // pack_vec
-            censor_var_limit(
-                pack_vec,
-                pack_vec,
-                var2prior,
-                db_input.prior_table
-            );
-            //
-            // pack_vec
-            pack_info::subvec_info info;
-            size_t n_int = db_input.integrand_table.size();
-            for(size_t integrand_id = 0; integrand_id < n_int; ++integrand_id)
-            {   size_t n_cov = pack_object.group_meas_value_n_cov(integrand_id);
-                for(size_t j = 0; j < n_cov; ++j)
-                {   info = pack_object.group_meas_value_info(integrand_id, j);
-                    for(size_t k = 0; k < info.n_var; ++k)
-                    {   size_t var_id = info.offset + k;
-                        pack_vec[var_id] = 0.0;
-                    }
-                }
-                n_cov = pack_object.subgroup_meas_value_n_cov(integrand_id);
-                for(size_t j = 0; j < n_cov; ++j)
-                {   size_t n_sub =
-                        pack_object.subgroup_meas_value_n_sub(integrand_id, j);
-                    for(size_t k = 0; k < n_sub; ++k)
-                    {   info =
-                            pack_object.subgroup_meas_value_info(integrand_id, j, k);
-                            for(size_t ell = 0; ell < info.n_var; ++ell)
-                            {   size_t var_id = info.offset + ell;
-                                pack_vec[var_id] = 0.0;
-                            }
-                    }
-                }
-            }
-            //
-            // variable_value
-            for(size_t var_id = 0; var_id < n_var; ++var_id)
-                variable_value[var_id + sample_index * n_var] = pack_vec[var_id];
-        }
-    }
-    // ------------------------------------------------------------------------
-# ifndef NDEBUG
-    // check sample table
-    if( source == "sample" )
-    {   // sample table
-        vector<dismod_at::sample_struct> sample_table =
-            dismod_at::get_sample_table(db);
-        size_t sample_id = 0;
-        for(size_t sample_index = 0; sample_index < n_sample; sample_index++)
-        {   for(size_t var_id = 0; var_id < n_var; var_id++)
-            {   size_t sample_check =
-                    size_t( sample_table[sample_id].sample_index);
-                size_t var_check =
-                    size_t( sample_table[sample_id].var_id);
-                if( sample_check != sample_index || var_check != var_id )
-                {   string msg = "database modified, restart with init command";
-                    table_name = "sample";
-                    dismod_at::error_exit(msg, table_name, sample_id);
-                }
-                ++sample_id;
-            }
-        }
+    // n_sample
+    // (also checks that the primary key for the source table is
+    // zero through the number of rows minus one)
+    size_t n_source  = dismod_at::check_table_id(db, table_name);
+    size_t n_sample  = n_source / n_var;
+    if( n_sample * n_var != n_source )
+    {   string msg = "database modified, restart with init command";
+        dismod_at::error_exit(msg, table_name);
     }
-# endif
     // -----------------------------------------------------------------------
-    // create a new predict table
-    string sql_cmd = "drop table if exists predict";
-    dismod_at::exec_sql_cmd(db, sql_cmd);
-    //
-    table_name = "predict";
+    // predict_name, n_subset, col_name, col_type, col_unique, col_value
+    string predict_name = "predict";
     size_t n_col      = 3;
     size_t n_subset   = avgint_subset_obj.size();
-    size_t n_row      = n_sample * n_subset;
-    vector<string> col_name(n_col), col_type(n_col), row_value(n_col * n_row);
+    vector<string> col_name(n_col), col_type(n_col);
     vector<bool>   col_unique(n_col);
+    vector<dismod_at::column_value_struct> col_value(n_col);
     //
     col_name[0]   = "sample_index";
     col_type[0]   = "integer";
@@ -286,43 +340,226 @@ void predict_command(
     col_type[2]   = "real";
     col_unique[2] = false;
     //
-    size_t sample_id = 0;
-    for(size_t sample_index = 0; sample_index < n_sample; sample_index++)
-    {   // copy the variable values for this sample index into pack_vec
-        for(size_t var_id = 0; var_id < n_var; var_id++)
-            pack_vec[var_id] = variable_value[sample_id++];
+    // n_chunk
+    // maximum number of samples (sets of model variables) in one chunk
+    size_t n_chunk = max_chunk_value / std::max(n_var, n_subset);
+    n_chunk        = std::max(size_t(1), n_chunk);
+    //
+    // db
+    // create a new predict table (with no rows)
+    if( ! summary )
+    {   string sql_cmd = "drop table if exists predict";
+        dismod_at::exec_sql_cmd(db, sql_cmd);
+        dismod_at::create_table(
+            db, predict_name, col_name, col_type, col_unique, col_value
+        );
+    }
+    //
+    // quantile_name, quantile_level
+    // a level 0.digits corresponds to the column quantile_0_digits
+    vector<string> quantile_name  = dismod_at::split_space(predict_quantile);
+    size_t         n_quantile     = quantile_name.size();
+    vector<double> quantile_level(n_quantile);
+    for(size_t i = 0; i < n_quantile; ++i)
+    {   quantile_level[i] = std::atof( quantile_name[i].c_str() );
+        quantile_name[i]  = "quantile_0_" + quantile_name[i].substr(2);
+    }
+    //
+    // statistics
+    std::vector<summary_statistics> statistics;
+    if( summary )
+        statistics.resize(n_subset, summary_statistics(quantile_level) );
+    // -----------------------------------------------------------------------
+    // variable_value, avg_vec
+    vector<double> variable_value, avg_vec;
+    //
+    // first_sample
+    size_t first_sample = 0;
+    while( first_sample < n_sample )
+    {   //
+        // end_sample, n_this
+        size_t end_sample = std::min(first_sample + n_chunk, n_sample);
+        size_t n_this     = end_sample - first_sample;
         //
-        for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
-        {
-            int avgint_id  = avgint_subset_obj[subset_id].original_id;
-            double avg     = 0.0;
-            try
-            {   avg = avgint_object.average(subset_id, pack_vec);
+        // variable_value
+        size_t first_id = first_sample * n_var;
+        size_t end_id   = end_sample * n_var;
+        variable_value.clear();
+        dismod_at::get_table_column(
+            db, table_name, column_name, first_id, end_id, variable_value
+        );
+        //
+        // variable_value
+        if( fit_var_scale != 1.0 )
+        {   for(size_t i = 0; i < n_this * n_var; ++i)
+            {   double sample     = variable_value[i];
+                double fit        = fit_var_value[i % n_var];
+                variable_value[i] = fit + fit_var_scale * (sample - fit);
+            }
+        }
+        //
+        // variable_value
+        if( zero_meas_value )
+        {   for(size_t sample_index = 0; sample_index < n_this; ++sample_index)
+            {   //
+                // pack_vec
+                for(size_t var_id = 0; var_id < n_var; ++var_id)
+                    pack_vec[var_id] =
+                        variable_value[sample_index * n_var + var_id];
+                //
+                // pack_vec
+                zero_meas_value_var(
+                    pack_vec, db_input, pack_object, var2prior
+                );
+                //
+                // variable_value
+                for(size_t var_id = 0; var_id < n_var; ++var_id)
+                    variable_value[sample_index * n_var + var_id] =
+                        pack_vec[var_id];
+            }
+        }
+        // --------------------------------------------------------------------
+# ifndef NDEBUG
+        // check sample table
+        if( source == "sample" )
+        {   vector<int> sample_index_vec, var_id_vec;
+            dismod_at::get_table_column(
+                db, "sample", "sample_index", first_id, end_id, sample_index_vec
+            );
+            dismod_at::get_table_column(
+                db, "sample", "var_id", first_id, end_id, var_id_vec
+            );
+            size_t sample_id = first_id;
+            for(size_t sample_index = first_sample;
+                sample_index < end_sample; sample_index++)
+            {   for(size_t var_id = 0; var_id < n_var; var_id++)
+                {   size_t sample_check =
+                        size_t( sample_index_vec[sample_id - first_id] );
+                    size_t var_check =
+                        size_t( var_id_vec[sample_id - first_id] );
+                    if( sample_check != sample_index || var_check != var_id )
+                    {   string msg =
+                            "database modified, restart with init command";
+                        dismod_at::error_exit(msg, "sample", sample_id);
+                    }
+                    ++sample_id;
+                }
             }
-            catch(const std::exception& e)
-            {   string message("predict_command: std::exception: ");
-                message += e.what();
-                dismod_at::error_exit(message);
+        }
+# endif
+        // --------------------------------------------------------------------
+        // avg_vec
+        // The samples are divided between the threads and the results are
+        // in the same order as when one thread is used.
+        size_t error_id = n_subset;
+        try
+        {   avgint_object.average_all(
+                n_this, variable_value, avg_vec, error_id
+            );
+        }
+        catch(const std::exception& e)
+        {   string message("predict_command: std::exception: ");
+            message += e.what();
+            dismod_at::error_exit(message);
+        }
+        catch(const CppAD::mixed::exception& e)
+        {   assert( error_id < n_subset );
+            int avgint_id     = avgint_subset_obj[error_id].original_id;
+            string catcher    = "predict_command";
+            string message    = e.message(catcher);
+            dismod_at::error_exit(message, "avgint", avgint_id);
+        }
+        //
+        // statistics
+        if( summary )
+        {   for(size_t k = 0; k < n_this; k++)
+            {   for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
+                {   size_t row = k * n_subset + subset_id;
+                    statistics[subset_id].add( avg_vec[row] );
+                }
             }
-            catch(const CppAD::mixed::exception& e)
-            {   string catcher    = "predict_command";
-                string message    = e.message(catcher);
-                table_name        = "avgint";
-                dismod_at::error_exit(message, table_name, avgint_id);
+        }
+        else
+        {   // col_value
+            size_t n_row = n_this * n_subset;
+            col_value[0].int_value.resize(n_row);
+            col_value[1].int_value.resize(n_row);
+            col_value[2].real_value.resize(n_row);
+            for(size_t k = 0; k < n_this; k++)
+            {   size_t sample_index = first_sample + k;
+                for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
+                {   int avgint_id  = avgint_subset_obj[subset_id].original_id;
+                    size_t row     = k * n_subset + subset_id;
+                    if( source == "sample" )
+                        col_value[0].int_value[row] = int( sample_index );
+                    else
+                        col_value[0].int_value[row] = DISMOD_AT_NULL_INT;
+                    col_value[1].int_value[row]  = avgint_id;
+                    col_value[2].real_value[row] = avg_vec[row];
+                }
             }
             //
-            size_t predict_id = sample_index * n_subset + subset_id;
-            if( source == "sample" )
-                row_value[n_col * predict_id + 0] = to_string( sample_index );
-            else
-                row_value[n_col * predict_id + 0] = "";
-            row_value[n_col * predict_id + 1] = to_string( avgint_id );
-            row_value[n_col * predict_id + 2] = to_string( avg );
+            // db
+            // predict_id = sample_index * n_subset + subset_id
+            size_t first_predict_id = first_sample * n_subset;
+            dismod_at::insert_table(
+                db,
+                predict_name,
+                col_name,
+                col_type,
+                col_value,
+                first_predict_id
+            );
         }
+        //
+        // first_sample
+        first_sample = end_sample;
+    }
+    //
+    // db
+    // create a new predict_summary table
+    if( summary )
+    {   string sql_cmd = "drop table if exists predict_summary";
+        dismod_at::exec_sql_cmd(db, sql_cmd);
+        //
+        vector<string> stat_name(2);
+        stat_name[0] = "mean";
+        stat_name[1] = "std";
+        for(size_t i = 0; i < n_quantile; ++i)
+            stat_name.push_back( quantile_name[i] );
+        size_t n_stat = stat_name.size();
+        n_col         = 1 + n_stat;
+        col_name.resize(n_col);
+        col_type.resize(n_col);
+        col_unique.resize(n_col);
+        col_value.resize(n_col);
+        //
+        col_name[0]   = "avgint_id";
+        col_type[0]   = "integer";
+        col_unique[0] = true;
+        col_value[0].int_value.resize(n_subset);
+        for(size_t j = 0; j < n_stat; ++j)
+        {   col_name[j+1]   = stat_name[j];
+            col_type[j+1]   = "real";
+            col_unique[j+1] = false;
+            col_value[j+1].int_value.resize(0);
+            col_value[j+1].real_value.resize(n_subset);
+        }
+        for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
+        {   const summary_statistics& stat = statistics[subset_id];
+            col_value[0].int_value[subset_id] =
+                avgint_subset_obj[subset_id].original_id;
+            col_value[1].real_value[subset_id] = stat.mean();
+            col_value[2].real_value[subset_id] = stat.std_dev();
+            for(size_t i = 0; i < n_quantile; ++i)
+                col_value[i+3].real_value[subset_id] =
+                    stat.quantile[i].value();
+        }
+        string summary_name = "predict_summary";
+        dismod_at::create_table(
+            db, summary_name, col_name, col_type, col_unique, col_value
+        );
     }
-    dismod_at::create_table(
-        db, table_name, col_name, col_type, col_unique, row_value
-    );
     return;
 }
 } // END_DISMOD_AT_NAMESPACE
@@ -1,8 +1,10 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 
+# include <algorithm>
+# include <cstring>
 # include <dismod_at/sample_command.hpp>
 # include <dismod_at/error_exit.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
@@ -14,6 +16,7 @@
 # include <dismod_at/get_var_limits.hpp>
 # include <dismod_at/remove_const.hpp>
 # include <dismod_at/get_str_map.hpp>
+# include <dismod_at/process_team.hpp>
 
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
@@ -91,6 +94,24 @@ This requires running *number_sample* fits of the model variables
 See :ref:`posterior@Simulation` in the discussion of the
 posterior distribution of maximum likelihood estimates.
 
+#.  The option table :ref:`option_table@thread_count` is the number of
+    simulated data sets that are fit at the same time.
+    If it is greater than one, the fits are run by that many
+    child processes (because cppad_mixed and Ipopt are not thread safe).
+    Each process has its own copy of the data and prior models
+    and runs its fits in order of *sample_index* .
+#.  The fits for a *sample_index* only depend on the corresponding
+    simulated data and prior means; i.e., they do not use random numbers.
+    The functions that cppad_mixed uses are recorded for each fit
+    because they depend on these values.
+    They are recorded the same way for any *thread_count* ; e.g.,
+    :ref:`option_table@tape_by_child` applies to each fit.
+    Hence the sample table does not depend on *thread_count* .
+    The :ref:`option_table@tape_cache` option is not used when
+    the fits are run by child processes.
+#.  If a fit fails, the error for the smallest *sample_index*
+    that failed is reported.
+
 asymptotic
 **********
 If *method* is ``asymptotic`` or ``censor_asymptotic``
@@ -104,6 +125,8 @@ The asymptotic statistics of the model variables is used to generate
 *number_sample* samples of the model variables
 The samples with different values of *sample_index* are independent.
 All of the Laplace density terms are ignored by the asymptotic statistics.
+The Hessians are evaluated, and the random effects are optimized,
+once (at the values in the fit_var table) for all of the samples.
 
 If *method* is ``asymptotic`` ,
 the constraints are also ignored, except the constraints were
@@ -281,9 +304,16 @@ void sample_command(
     size_t n_col      = 3;
     size_t n_var      = pack_object.size();
     size_t n_row      = n_sample * n_var;
-    vector<string> col_name(n_col), col_type(n_col), row_value(n_col * n_row);
+    vector<string> col_name(n_col), col_type(n_col), row_value;
     vector<bool>   col_unique(n_col);
     //
+    // col_value
+    // values in the sample table
+    vector<dismod_at::column_value_struct> col_value(n_col);
+    col_value[0].int_value.resize(n_row);
+    col_value[1].int_value.resize(n_row);
+    col_value[2].real_value.resize(n_row);
+    //
     col_name[0]   = "sample_index";
     col_type[0]   = "integer";
     col_unique[0] = false;
@@ -328,6 +358,10 @@ void sample_command(
     bool trace_init =
         get_str_map(option_map, "trace_init_fit_model") == "true";
     //
+    // tape_by_child, tape_cache
+    bool tape_by_child = get_str_map(option_map, "tape_by_child") == "true";
+    bool tape_cache    = get_str_map(option_map, "tape_cache") == "true";
+    //
     //
     // warn_on_stderr
     bool warn_on_stderr = get_str_map(option_map, "warn_on_stderr") == "true";
@@ -427,17 +461,32 @@ void sample_command(
                 }
             }
         }
+        //
+        // n_process
+        size_t n_process = std::atoi(
+            get_str_map(option_map, "thread_count").c_str()
+        );
+        n_process = std::max( size_t(1), std::min(n_process, n_sample) );
+        //
+        // sample_subset, sample_data, sample_prior
+        // each child process has its own copy of these objects
+        vector<dismod_at::subset_data_struct> sample_subset(subset_data_obj);
+        dismod_at::data_model  sample_data(data_object);
+        dismod_at::prior_model sample_prior(prior_object);
+        sample_data.set_thread_count(1);
+        //
         // Vector used to replacement of the prior means:
         // wor each variable it has a mean for value, dage and  dtime.
         vector<double> prior_mean(n_var * 3);
         //
-        // for each simulated data set
-        for(size_t sample_index = 0; sample_index < n_sample; sample_index++)
+        // work
+        // fit one simulated data set and return the sample for it
+        auto work = [&](size_t sample_index, sqlite3* sample_db)
         {   // --------------------------------------------------------------
             // estimate fixed effects for this sample_index
             // --------------------------------------------------------------
             //
-            // replace data_sim_value in subset_data_obj
+            // replace data_sim_value in sample_subset
             size_t offset = n_subset * sample_index;
             for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
             {   size_t data_sim_id = offset + subset_id;
@@ -452,16 +501,12 @@ void sample_command(
                     table_name = "data_sim";
                     dismod_at::error_exit(msg, table_name, data_sim_id);
                 }
-# ifndef NDEBUG
-                double old_value = subset_data_obj[subset_id].data_sim_value;
-# endif
                 double new_value =data_sim_table[data_sim_id].data_sim_value;
-                assert(   std::isnan(old_value) || sample_index > 0 );
                 assert( ! std::isnan(new_value) );
-                subset_data_obj[subset_id].data_sim_value = new_value;
+                sample_subset[subset_id].data_sim_value = new_value;
             }
             // replace_like
-            data_object.replace_like(subset_data_obj);
+            sample_data.replace_like(sample_subset);
             //
             // replace prior means for fixed effects
             for(size_t var_id = 0; var_id < n_var; ++var_id)
@@ -509,13 +554,13 @@ void sample_command(
                     prior_mean[var_id * 3 + 2] = 0.0;
                 }
             }
-            prior_object.replace_mean(prior_mean);
+            sample_prior.replace_mean(prior_mean);
             //
             // fit both fixed and random effects
             bool random_only   = false;
             int  sim_index_int = int(sample_index);
             dismod_at::fit_model fit_object_both(
-                db                   ,
+                sample_db            ,
                 sim_index_int        ,
                 warn_on_stderr       ,
                 bound_random         ,
@@ -524,13 +569,15 @@ void sample_command(
                 start_var_value      ,
                 scale_var_value      ,
                 db_input.prior_table ,
-                prior_object         ,
+                sample_prior         ,
                 random_const         ,
                 quasi_fixed          ,
                 zero_sum_child_rate  ,
                 zero_sum_mulcov_group,
-                data_object          ,
-                trace_init
+                sample_data          ,
+                trace_init           ,
+                tape_by_child        ,
+                tape_cache
             );
             // input empty warm_start information
             CppAD::mixed::warm_start_struct warm_start_1;
@@ -544,16 +591,12 @@ void sample_command(
             );
             assert( opt_value.size() == n_var );
             //
-            // solution for fixed effects and this sample_index -> row_value
-            string sample_index_str = to_string( sample_index );
+            // sample
+            // solution for fixed effects and this sample_index
+            vector<double> sample(n_var);
             for(size_t var_id = 0; var_id < n_var; var_id++)
             if( ! is_random_effect[var_id] )
-            {   size_t sample_id = sample_index * n_var + var_id;
-                row_value[n_col * sample_id + 0] = sample_index_str;
-                row_value[n_col * sample_id + 1] = to_string( var_id );
-                row_value[n_col * sample_id + 2] =
-                    to_string(opt_value[var_id] );
-            }
+                sample[var_id] = opt_value[var_id];
             // --------------------------------------------------------------
             // estimate random effects for this sample_index
             // --------------------------------------------------------------
@@ -574,14 +617,14 @@ void sample_command(
                 prior_mean[var_id * 3 + 2] =
                     prior_sim_table[prior_sim_id].prior_sim_dtime;
             }
-            prior_object.replace_mean(prior_mean);
+            sample_prior.replace_mean(prior_mean);
             //
             // Only fit random effects.
             // 2DO: add replacement of prior_object and start_var to fit_model
             // and then use the same fit_model object for random effects.
             random_only = true;
             dismod_at::fit_model fit_object_random(
-                db                   ,
+                sample_db            ,
                 sim_index_int        ,
                 warn_on_stderr       ,
                 bound_random         ,
@@ -590,13 +633,15 @@ void sample_command(
                 opt_value            , // use optimal value for fixed effects
                 scale_var_value      ,
                 db_input.prior_table ,
-                prior_object         ,
+                sample_prior         ,
                 random_const         ,
                 quasi_fixed          ,
                 zero_sum_child_rate  ,
                 zero_sum_mulcov_group,
-                data_object          ,
-                trace_init
+                sample_data          ,
+                trace_init           ,
+                tape_by_child        ,
+                tape_cache
             );
             // empty warm_start information
             CppAD::mixed::warm_start_struct warm_start_2;
@@ -607,19 +652,46 @@ void sample_command(
             opt_value, lag_value, lag_dage, lag_dtime, trace_vec, warm_start_2
             );
             //
-            // solution for random effects and this sample_index -> row_value
+            // sample
+            // solution for random effects and this sample_index
             for(size_t var_id = 0; var_id < n_var; var_id++)
             if( is_random_effect[var_id] )
+                sample[var_id] = opt_value[var_id];
+            //
+            return string(
+                reinterpret_cast<const char*>( sample.data() ),
+                n_var * sizeof(double)
+            );
+        };
+        vector<string>                result;
+        dismod_at::log_message_struct error;
+        size_t error_index = dismod_at::process_team(
+            db, n_process, n_sample, work, result, error
+        );
+        if( error_index < n_sample )
+        {   msg = error.message;
+            dismod_at::error_exit(msg, error.table_name, error.row_id);
+        }
+        //
+        // col_value
+        vector<double> sample(n_var);
+        for(size_t sample_index = 0; sample_index < n_sample; ++sample_index)
+        {   assert( result[sample_index].size() == n_var * sizeof(double) );
+            std::memcpy(
+                sample.data(),
+                result[sample_index].data(),
+                n_var * sizeof(double)
+            );
+            for(size_t var_id = 0; var_id < n_var; var_id++)
             {   size_t sample_id = sample_index * n_var + var_id;
-                row_value[n_col * sample_id + 0] = sample_index_str;
-                row_value[n_col * sample_id + 1] = to_string( var_id );
-                row_value[n_col * sample_id + 2] =
-                    to_string(opt_value[var_id] );
+                col_value[0].int_value[sample_id]  = int( sample_index );
+                col_value[1].int_value[sample_id]  = int( var_id );
+                col_value[2].real_value[sample_id] = sample[var_id];
             }
         }
         table_name = "sample";
         dismod_at::create_table(
-            db, table_name, col_name, col_type, col_unique, row_value
+            db, table_name, col_name, col_type, col_unique, col_value
         );
         return;
     }
@@ -691,7 +763,9 @@ void sample_command(
         zero_sum_child_rate  ,
         zero_sum_mulcov_group,
         data_object          ,
-        trace_init
+        trace_init           ,
+        tape_by_child        ,
+        tape_cache
     );
     //
     // hes_fixed_obj_out, hes_random_obj_out, sample_out
@@ -711,23 +785,22 @@ void sample_command(
     if( sample_out.size() != 0 )
     {   assert( sample_out.size() == n_sample * n_var );
         for(size_t sample_index = 0; sample_index < n_sample; sample_index++)
-        {   string sample_index_str = to_string( sample_index );
-            for(size_t var_id = 0; var_id < n_var; var_id++)
+        {   for(size_t var_id = 0; var_id < n_var; var_id++)
             {   size_t sample_id = sample_index * n_var + var_id;
-                row_value[n_col * sample_id + 0] = sample_index_str;
-                row_value[n_col * sample_id + 1] = to_string( var_id );
+                col_value[0].int_value[sample_id] = int( sample_index );
+                col_value[1].int_value[sample_id] = int( var_id );
                 //
                 double var_value = sample_out[ sample_index * n_var + var_id];
                 if( method == "censor_asymptotic" )
                 {   var_value        = std::max(var_value, var_lower[var_id] );
                     var_value        = std::min(var_value, var_upper[var_id] );
                 }
-                row_value[n_col * sample_id + 2] = to_string(var_value);
+                col_value[2].real_value[sample_id] = var_value;
             }
         }
         table_name = "sample";
         dismod_at::create_table(
-            db, table_name, col_name, col_type, col_unique, row_value
+            db, table_name, col_name, col_type, col_unique, col_value
         );
     }
     // ----------------------------------------------------------------------
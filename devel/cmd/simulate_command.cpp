@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 
 # include <dismod_at/simulate_command.hpp>
@@ -119,8 +119,9 @@ void simulate_command(
     size_t n_col    = 3;
     size_t n_subset = subset_data_obj.size();
     size_t n_row    = n_simulate * n_subset;
-    vector<string> col_name(n_col), col_type(n_col), row_value(n_col * n_row);
+    vector<string> col_name(n_col), col_type(n_col), row_value;
     vector<bool>   col_unique(n_col);
+    vector<column_value_struct> col_value(n_col);
     //
     col_name[0]   = "simulate_index";
     col_type[0]   = "integer";
@@ -134,15 +135,9 @@ void simulate_command(
     col_type[2]   = "real";
     col_unique[2] = false;
     //
-    // for each measurement in the data_subset table
+    // check for densities that are not yet implemented
     for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
-    {
-        //
-        // compute the average integrand, avg
-        double avg = data_object.average(subset_id, truth_var);
-        //
-        // density corresponding to this data point
-        density_enum density = subset_data_obj[subset_id].density;
+    {   density_enum density = subset_data_obj[subset_id].density;
         assert( density != uniform_enum );
         if( density == binomial_enum )
         {   msg           = "dismod_at simulate command: ";
@@ -151,14 +146,32 @@ void simulate_command(
             size_t row_id = subset_data_obj[subset_id].original_id;
             error_exit(msg, table_name, row_id);
         }
+    }
+    //
+    // avg_vec, delta_vec
+    // average integrand and adjusted standard deviation for each data point
+    vector<double> avg_vec, delta_vec;
+    vector< residual_struct<double> > residual_vec;
+    data_object.like_all_avg(truth_var, avg_vec, delta_vec, residual_vec);
+    //
+    // col_value
+    col_value[0].int_value.resize(n_row);
+    col_value[1].int_value.resize(n_row);
+    col_value[2].real_value.resize(n_row);
+    //
+    // for each measurement in the data_subset table
+    for(size_t subset_id = 0; subset_id < n_subset; subset_id++)
+    {   //
+        // density corresponding to this data point
+        density_enum density = subset_data_obj[subset_id].density;
         //
         // data table information
         double eta          = subset_data_obj[subset_id].eta;
         double nu           = subset_data_obj[subset_id].nu;
         //
-        // data table adjusted standard deviation, delta
-        double delta;
-        data_object.like_one(subset_id, truth_var, avg, delta);
+        // average integrand and adjusted standard deviation
+        double avg          = avg_vec[subset_id];
+        double delta        = delta_vec[subset_id];
         //
         for(size_t sim_index = 0; sim_index < n_simulate; sim_index++)
         {   // for each simulate_index
@@ -167,13 +180,13 @@ void simulate_command(
             double sim_value   = sim_random(density, avg, delta, eta, nu);
             //
             size_t data_sim_id = sim_index * n_subset + subset_id;
-            row_value[data_sim_id * n_col + 0] = to_string( sim_index );
-            row_value[data_sim_id * n_col + 1] = to_string( subset_id );
-            row_value[data_sim_id * n_col + 2] = to_string( sim_value );
+            col_value[0].int_value[data_sim_id]  = int( sim_index );
+            col_value[1].int_value[data_sim_id]  = int( subset_id );
+            col_value[2].real_value[data_sim_id] = sim_value;
         }
     }
     create_table(
-        db, table_name, col_name, col_type, col_unique, row_value
+        db, table_name, col_name, col_type, col_unique, col_value
     );
     // ----------------- prior_sim_table ----------------------------------
     sql_cmd = "drop table if exists prior_sim";
@@ -1,12 +1,28 @@
 // $Id:$
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
+# include <algorithm>
 # include <map>
+# include <memory>
+# include <set>
+# include <list>
+# include <chrono>
 # include <cassert>
+# include <cerrno>
+# include <csignal>
+# include <cstring>
 # include <string>
 # include <filesystem>
+# include <fstream>
+
+# include <poll.h>
+# include <unistd.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <sys/wait.h>
 
 # include <cppad/utility/vector.hpp>
 # include <cppad/mixed/exception.hpp>
@@ -22,6 +38,7 @@
 # include <dismod_at/configure.hpp>
 # include <dismod_at/cov2weight_map.hpp>
 # include <dismod_at/create_table.hpp>
+# include <dismod_at/db_input_cache.hpp>
 # include <dismod_at/data_density_command.hpp>
 # include <dismod_at/depend.hpp>
 # include <dismod_at/depend_command.hpp>
@@ -51,91 +68,60 @@
 # include <dismod_at/pack_prior.hpp>
 # include <dismod_at/predict_command.hpp>
 # include <dismod_at/sample_command.hpp>
+# include <dismod_at/server_request.hpp>
 # include <dismod_at/set_command.hpp>
+# include <dismod_at/set_db_profile.hpp>
 # include <dismod_at/sim_random.hpp>
 # include <dismod_at/simulate_command.hpp>
+# include <dismod_at/split_space.hpp>
 // END_SORT_THIS_LINE_MINUS_1
 
 # define DISMOD_AT_TRACE 0
 
+namespace { // BEGIN_EMPTY_NAMESPACE
 
-int main(int n_arg, const char** argv)
-{   // ---------------- using statements ----------------------------------
-    using std::cerr;
-    using std::endl;
-    using std::string;
-    using CppAD::vector;
-    // ---------------- command line arguments ---------------------------
-    //
-    // --version
-    if( n_arg == 2 )
-    {   if( strcmp( argv[1] , "--version" ) == 0 )
-        {   std::cout << "dismod_at-" DISMOD_AT_VERSION "\n";
-            return 0;
-        }
-    }
-    // command_info
-    // BEGIN_SORT_THIS_LINE_PLUS_2
-    struct { const char* name; int n_arg; } command_info[] = {
-        {"bnd_mulcov",   4},
-        {"bnd_mulcov",   5},
-        {"data_density", 3},
-        {"data_density", 7},
-        {"depend",       3},
-        {"fit",          4},
-        {"fit",          5},
-        {"fit",          6},
-        {"hold_out",     5},
-        {"hold_out",     6},
-        {"hold_out",     8},
-        {"hold_out",     9},
-        {"init",         3},
-        {"old2new",      3},
-        {"predict",      4},
-        {"predict",      5},
-        {"predict",      6},
-        {"predict",      7},
-        {"sample",       6},
-        {"sample",       7},
-        {"set",          5},
-        {"set",          6},
-        {"simulate",     4}
-    };
-    // END_SORT_THIS_LINE_MINUS_2
-    size_t n_command = sizeof( command_info ) / sizeof( command_info[0] );
-    //
-    string program = "dismod_at-";
-    program       += DISMOD_AT_VERSION;
-# ifndef NDEBUG
-    program       += " debug build";
-# else
-    program       += " release build";
-# endif
-    if( n_arg < 3 )
-    {   cerr << program << endl
-        << "usage:    dismod_at database command [arguments]\n"
-        << "database: sqlite database\n"
-        << "command:  " << command_info[0].name;
-        size_t column = 10 + std::strlen( command_info[0].name );
-        for(size_t i = 1; i < n_command; i++)
-        {   string name = command_info[i].name;
-            if( name != command_info[i-1].name )
-            {   column += 2 + name.size();
-                if( column < 80 )
-                    cerr << ", ";
-                else
-                {   cerr << "\n          ";
-                    column = 10 + name.size();
-                }
-                cerr << name;
-            }
-        }
-        cerr << "\n"
-        << "arguments: optional arguments depending on particular command\n";
-        std::exit(1);
-    }
-    // check if command matches one of the cases in command_info
-    const string database_arg  = argv[1];
+using std::cerr;
+using std::endl;
+using std::string;
+using CppAD::vector;
+// ---------------------------------------------------------------------------
+// command_info
+// BEGIN_SORT_THIS_LINE_PLUS_2
+const struct { const char* name; int n_arg; } command_info[] = {
+    {"batch",        4},
+    {"bnd_mulcov",   4},
+    {"bnd_mulcov",   5},
+    {"data_density", 3},
+    {"data_density", 7},
+    {"depend",       3},
+    {"fit",          4},
+    {"fit",          5},
+    {"fit",          6},
+    {"fit",          7},
+    {"hold_out",     5},
+    {"hold_out",     6},
+    {"hold_out",     8},
+    {"hold_out",     9},
+    {"init",         3},
+    {"old2new",      3},
+    {"predict",      4},
+    {"predict",      5},
+    {"predict",      6},
+    {"predict",      7},
+    {"predict",      8},
+    {"sample",       6},
+    {"sample",       7},
+    {"set",          5},
+    {"set",          6},
+    {"simulate",     4}
+};
+// END_SORT_THIS_LINE_MINUS_2
+const size_t n_command = sizeof( command_info ) / sizeof( command_info[0] );
+// ---------------------------------------------------------------------------
+// check_command_arg
+// If argv is not a valid command, print an error message and exit.
+void check_command_arg(const string& program, int n_arg, const char** argv)
+{   // check if command matches one of the cases in command_info
     const string command_arg   = argv[2];
     vector<size_t> command_match;
     bool match = false;
@@ -175,9 +161,13 @@ int main(int n_arg, const char** argv)
         cerr << " arguments to follow " << command_arg << endl;
         std::exit(1);
     }
-    string message;
-    // --------------- open connection to database ---------------------------
-    bool new_file = false;
+}
+// ---------------------------------------------------------------------------
+// open_database
+// Open a connection to the database, use it for error_exit messages,
+// and change into the directory where the database is located.
+sqlite3* open_database(const string& database_arg)
+{   bool new_file = false;
     sqlite3* db   = dismod_at::open_connection(database_arg, new_file);
     //
     // set error_exit database so it can log fatal errors
@@ -192,6 +182,74 @@ int main(int n_arg, const char** argv)
     database_path.remove_filename();
     if( ! database_path.empty() )
         std::filesystem::current_path( database_path );
+    return db;
+}
+// ---------------------------------------------------------------------------
+// set_db_setting
+// Use the db_profile option to set the sqlite settings for db and
+// set db_input_cache to the value of the db_input_cache option.
+// The return value is true if all the input tables are in the primary
+// database; i.e., other_database is empty. If it is false,
+// db_input_cache is also false.
+bool set_db_setting(sqlite3* db, bool& db_input_cache)
+{   CppAD::vector<dismod_at::option_struct> option_table =
+        dismod_at::get_option_table(db);
+    string db_profile, other_database;
+    db_input_cache = false;
+    for(size_t option_id = 0; option_id < option_table.size(); ++option_id)
+    {   const string& name  = option_table[option_id].option_name;
+        const string& value = option_table[option_id].option_value;
+        if( name == "db_profile" )
+            db_profile = value;
+        if( name == "db_input_cache" )
+            db_input_cache = value == "true";
+        if( name == "other_database" )
+            other_database = value;
+    }
+    dismod_at::set_db_profile(db, db_profile);
+    //
+    // the cache key does not include the tables in other_database
+    bool primary_only = other_database == "";
+    db_input_cache   &= primary_only;
+    return primary_only;
+}
+// ---------------------------------------------------------------------------
+// input_cache_struct
+struct input_cache_struct {
+    // is db_input the current value of the input tables
+    bool                       valid;
+    // the input tables
+    dismod_at::db_input_struct db_input;
+    //
+    // are the objects below the current value for db_input
+    // (derived_valid true implies valid true)
+    bool                                      derived_valid = false;
+    std::unique_ptr<dismod_at::child_info>    child_info4data;
+    std::unique_ptr<dismod_at::child_info>    child_info4avgint;
+    vector<dismod_at::smooth_info>            s_info_vec;
+    std::unique_ptr<dismod_at::pack_info>     pack_object;
+    vector<double>                            prior_mean;
+};
+// ---------------------------------------------------------------------------
+// run_command
+// Run one command using the database connection db. The arguments argv have
+// the same meaning as for main and have already been checked. If
+// input_cache.valid is true, input_cache.db_input is the current value of
+// the input tables; otherwise they are read and input_cache.valid is set to
+// true. The commands that change the input tables set input_cache.valid to
+// false. The other input_cache objects only depend on the input tables and
+// are recomputed when input_cache.derived_valid is false.
+void run_command(
+    int                 n_arg          ,
+    const char**        argv           ,
+    sqlite3*            db             ,
+    bool                db_input_cache ,
+    input_cache_struct& input_cache    )
+{   const string database_arg  = argv[1];
+    const string command_arg   = argv[2];
+    string message;
+    // all the changes to the database by this command are one transaction
+    dismod_at::exec_sql_cmd(db, "begin");
     // --------------- log start of this command -----------------------------
     message = "begin";
     for(int i_arg = 2; i_arg < n_arg; i_arg++)
@@ -208,8 +266,8 @@ int main(int n_arg, const char** argv)
     if( command_arg == "old2new" )
     {   dismod_at::old2new_command(db);
         dismod_at::log_message(db, DISMOD_AT_NULL_PTR, "command", end_message);
-        sqlite3_close(db);
-        return 0;
+        dismod_at::exec_sql_cmd(db, "commit");
+        return;
     }
     // ----------------------------------------------------------------------
     // The "set option" commands must be done before get_db_input can be run
@@ -227,12 +285,27 @@ int main(int n_arg, const char** argv)
         dismod_at::set_option_command(db, option_table, name, value);
         //
         dismod_at::log_message(db, DISMOD_AT_NULL_PTR, "command", end_message);
-        sqlite3_close(db);
-        return 0;
+        dismod_at::exec_sql_cmd(db, "commit");
+        //
+        // the option table is one of the input tables
+        input_cache.valid = false;
+        return;
     }
     // --------------- get the input tables ---------------------------------
-    dismod_at::db_input_struct db_input;
-    get_db_input(db, db_input);
+    if( ! input_cache.valid )
+    {   input_cache.db_input = dismod_at::db_input_struct();
+        bool found = false;
+        if( db_input_cache )
+            found = dismod_at::read_db_input_cache(db, input_cache.db_input);
+        if( ! found )
+        {   get_db_input(db, input_cache.db_input);
+            if( db_input_cache )
+                dismod_at::write_db_input_cache(db, input_cache.db_input);
+        }
+        input_cache.valid         = true;
+        input_cache.derived_valid = false;
+    }
+    const dismod_at::db_input_struct& db_input = input_cache.db_input;
     // ----------------------------------------------------------------------
     // option_map
     std::map<string, string> option_map;
@@ -247,6 +320,10 @@ int main(int n_arg, const char** argv)
     double ode_step_size  = std::atof( option_map["ode_step_size"].c_str() );
     assert( ode_step_size > 0.0 );
     // ---------------------------------------------------------------------
+    // thread_count
+    size_t thread_count = std::atoi( option_map["thread_count"].c_str() );
+    assert( thread_count > 0 );
+    // ---------------------------------------------------------------------
     // initialize random number generator
     size_t random_seed = std::atoi( option_map["random_seed"].c_str() );
     if( random_seed == 0 )
@@ -339,72 +416,88 @@ int main(int n_arg, const char** argv)
         else
             bound_random = std::atof( tmp_str.c_str() );
     }
-    // ------------------------------------------------------------------------
-    // child_info4data
-    dismod_at::child_info child_info4data(
-        parent_node_id          ,
-        db_input.node_table     ,
-        db_input.data_table
-    );
-    // child_info4avgint
-    dismod_at::child_info child_info4avgint(
-        parent_node_id          ,
-        db_input.node_table     ,
-        db_input.avgint_table
-    );
-    // n_child, n_integrand, n_weight, n_smooth
-    size_t n_child     = child_info4data.child_size();
+    // n_integrand, n_weight, n_smooth
     size_t n_integrand = db_input.integrand_table.size();
     size_t n_weight    = db_input.weight_table.size();
     size_t n_smooth    = db_input.smooth_table.size();
-    // ---------------------------------------------------------------------
-    //
-    // s_info_vec
-    vector<dismod_at::smooth_info> s_info_vec(n_smooth);
-    for(size_t smooth_id = 0; smooth_id < n_smooth; smooth_id++)
-    {   s_info_vec[smooth_id] = dismod_at::smooth_info(
-            smooth_id                  ,
-            db_input.age_table         ,
-            db_input.time_table        ,
-            db_input.prior_table       ,
-            db_input.smooth_table      ,
-            db_input.smooth_grid_table
-        );
-    }
-    // child_id2node_id
-    vector<size_t> child_id2node_id(n_child);
-    for(size_t child_id = 0; child_id < n_child; child_id++)
-    {   size_t node_id = child_info4data.child_id2node_id(child_id);
-        assert( node_id == child_info4avgint.child_id2node_id(child_id) );
-        child_id2node_id[child_id] = node_id;
-    }
-    // pack_object
-    dismod_at::pack_info pack_object(
-        n_integrand                 ,
-        child_id2node_id            ,
-        db_input.subgroup_table     ,
-        db_input.smooth_table       ,
-        db_input.mulcov_table       ,
-        db_input.rate_table         ,
-        db_input.nslist_pair_table
-    );
-    //
-    // prior_mean
-    vector<double> prior_mean;
-    {   vector<size_t> one(n_child);
+    // ------------------------------------------------------------------------
+    // input_cache: child_info4data, child_info4avgint, s_info_vec,
+    // pack_object, prior_mean. These only depend on the input tables
+    // so the commands in a batch share them until the input tables change.
+    if( ! input_cache.derived_valid )
+    {   // child_info4data
+        input_cache.child_info4data.reset( new dismod_at::child_info(
+            parent_node_id          ,
+            db_input.node_table     ,
+            db_input.data_table
+        ) );
+        // child_info4avgint
+        input_cache.child_info4avgint.reset( new dismod_at::child_info(
+            parent_node_id          ,
+            db_input.node_table     ,
+            db_input.avgint_table
+        ) );
+        // n_child
+        size_t n_child = input_cache.child_info4data->child_size();
+        //
+        // s_info_vec
+        vector<dismod_at::smooth_info>& s_info_vec = input_cache.s_info_vec;
+        s_info_vec.resize(n_smooth);
+        for(size_t smooth_id = 0; smooth_id < n_smooth; smooth_id++)
+        {   s_info_vec[smooth_id] = dismod_at::smooth_info(
+                smooth_id                  ,
+                db_input.age_table         ,
+                db_input.time_table        ,
+                db_input.prior_table       ,
+                db_input.smooth_table      ,
+                db_input.smooth_grid_table
+            );
+        }
+        // child_id2node_id
+        vector<size_t> child_id2node_id(n_child);
+        for(size_t child_id = 0; child_id < n_child; child_id++)
+        {   size_t node_id =
+                input_cache.child_info4data->child_id2node_id(child_id);
+            assert( node_id ==
+                input_cache.child_info4avgint->child_id2node_id(child_id)
+            );
+            child_id2node_id[child_id] = node_id;
+        }
+        // pack_object
+        input_cache.pack_object.reset( new dismod_at::pack_info(
+            n_integrand                 ,
+            child_id2node_id            ,
+            db_input.subgroup_table     ,
+            db_input.smooth_table       ,
+            db_input.mulcov_table       ,
+            db_input.rate_table         ,
+            db_input.nslist_pair_table
+        ) );
+        //
+        // prior_mean (does not depend on bound_random)
+        vector<size_t> one(n_child);
         for(size_t child = 0; child < n_child; ++child)
             one[child] = 1;
         dismod_at::pack_prior var2prior_temp(
             bound_random,
             one,
             db_input.prior_table,
-            pack_object,
+            *input_cache.pack_object,
             s_info_vec
         );
-        prior_mean  = get_prior_mean(
+        input_cache.prior_mean  = get_prior_mean(
             db_input.prior_table, var2prior_temp
         );
+        input_cache.derived_valid = true;
     }
+    const dismod_at::child_info& child_info4data =
+        *input_cache.child_info4data;
+    const dismod_at::child_info& child_info4avgint =
+        *input_cache.child_info4avgint;
+    const vector<dismod_at::smooth_info>& s_info_vec = input_cache.s_info_vec;
+    const dismod_at::pack_info&           pack_object =
+        *input_cache.pack_object;
+    const vector<double>&                 prior_mean = input_cache.prior_mean;
     //
     // meas_noise_effect
     string meas_noise_effect = option_map["meas_noise_effect"];
@@ -446,7 +539,7 @@ int main(int n_arg, const char** argv)
     if( command_arg == "fit" )
     {   if( n_arg == 5 )
             fit_simulated_data = string(argv[4]) != "warm_start";
-        if( n_arg == 6 )
+        if( n_arg == 6 || n_arg == 7 )
             fit_simulated_data = true;
     }
     if( command_arg == "sample" )
@@ -632,17 +725,29 @@ int main(int n_arg, const char** argv)
             pack_object              ,
             child_info4avgint
         );
+        avgint_object.set_thread_count(thread_count);
         //
         // source
         std::string source   = argv[3];
         //
+        // summary, n_last
+        // n_last is the number of arguments not counting summary
+        bool summary = strcmp(argv[n_arg - 1], "summary") == 0;
+        int  n_last  = summary ? n_arg - 1 : n_arg;
+        if( n_last == 8 )
+        {   message  = "dismod_at database predict command ";
+            message += "expected the last argument to be summary\n";
+            dismod_at::error_exit(message);
+        }
+        //
         // zero_meas_value
         bool zero_meas_value = false;
-        if( n_arg == 5 || n_arg == 7 )
-        {   const char* last_arg = argv[ n_arg - 1 ];
+        if( n_last == 5 || n_last == 7 )
+        {   const char* last_arg = argv[ n_last - 1 ];
             if( strcmp(last_arg, "zero_meas_value") != 0 )
             {   message  = "dismod_at database predict command ";
-                message += "expected the last argument to be zero_meas_value\n";
+                message += "expected the last argument to be zero_meas_value";
+                message += " or summary\n";
                 dismod_at::error_exit(message);
             }
             zero_meas_value = true;
@@ -650,7 +755,7 @@ int main(int n_arg, const char** argv)
         //
         // fit_var scale
         double fit_var_scale = 1.0;
-        if( n_arg > 5 )
+        if( n_last > 5 )
         {   string argv_4 = argv[4];
             if( strcmp(argv[4], "fit_var") != 0 )
             {   message  = "dismod_at database predict " + source + " " + argv_4;
@@ -659,10 +764,16 @@ int main(int n_arg, const char** argv)
             }
             fit_var_scale = std::atof( argv[5] );
         }
+        //
+        // predict_quantile
+        string predict_quantile = option_map["predict_quantile"];
+        //
         dismod_at::predict_command(
             source               ,
             zero_meas_value      ,
             fit_var_scale        ,
+            summary              ,
+            predict_quantile     ,
             db                   ,
             db_input             ,
             pack_object          ,
@@ -754,6 +865,7 @@ int main(int n_arg, const char** argv)
             pack_object              ,
             child_info4data
         );
+        data_object.set_thread_count(thread_count);
         //
         if( command_arg == "depend" )
         {   depend_command(
@@ -764,6 +876,26 @@ int main(int n_arg, const char** argv)
                 prior_object
             );
         }
+        else if( command_arg == "fit" && n_arg == 7 )
+        {   string variables = argv[3];
+            if( string( argv[4] ) != "sim_range" )
+            {   message = "dismod_at fit command syntax error";
+                dismod_at::error_exit(message);
+            }
+            fit_sim_range_command(
+                variables        ,
+                argv[5]          , // first
+                argv[6]          , // last
+                db               ,
+                subset_data_obj  ,
+                data_object      ,
+                prior_object     ,
+                pack_object      ,
+                var2prior        ,
+                db_input         ,
+                option_map
+            );
+        }
         else if( command_arg == "fit" )
         {   string variables      = argv[3];
             string simulate_index = "";
@@ -855,6 +987,632 @@ int main(int n_arg, const char** argv)
 # endif
     // ---------------------------------------------------------------------
     dismod_at::log_message(db, DISMOD_AT_NULL_PTR, "command", end_message);
+    dismod_at::exec_sql_cmd(db, "commit");
+    //
+    // the next command in a batch creates a new random number generator
+    CppAD::mixed::free_gsl_rng();
+    //
+    // the set avgint command changes one of the input tables
+    if( command_arg == "set" && strcmp(argv[3], "avgint") == 0 )
+        input_cache.valid = false;
+    return;
+}
+// ---------------------------------------------------------------------------
+// write_all
+// write all of str to the file descriptor fd (ignore errors)
+void write_all(int fd, const string& str)
+{   size_t pos = 0;
+    while( pos < str.size() )
+    {   ssize_t n = ::write(fd, str.data() + pos, str.size() - pos);
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+            return;
+        pos += size_t(n);
+    }
+}
+// ---------------------------------------------------------------------------
+// read_once
+// Append the characters that are available from the file descriptor fd to
+// str. The return value is false if fd is at end of file or has an error.
+bool read_once(int fd, string& str)
+{   char buffer[65536];
+    ssize_t n = ::read(fd, buffer, sizeof(buffer) );
+    if( n < 0 && errno == EINTR )
+        return true;
+    if( n <= 0 )
+        return false;
+    str.append(buffer, size_t(n) );
+    return true;
+}
+// ---------------------------------------------------------------------------
+// server_cache_struct
+struct server_cache_struct {
+    // db_input_cache_key for the input tables in input_cache
+    string             cache_key;
+    // the input tables for one database
+    input_cache_struct input_cache;
+};
+// ---------------------------------------------------------------------------
+// server_job_struct
+// One request for the server; from when its connection is accepted
+// until its response is written.
+struct server_job_struct {
+    // connection to the client
+    int                                   client_fd;
+    // time by which the request must be received
+    std::chrono::steady_clock::time_point deadline;
+    // characters received so far and true when the request is complete
+    string                                request;
+    bool                                  received;
+    // database and command in the request
+    string                                database;
+    vector<string>                        command;
+    // absolute path for database; i.e., its key in cache_map
+    string                                path;
+    // child process running the command (-1 before it is started)
+    pid_t                                 pid;
+    // was the input cache valid for the command (set when job is done)
+    bool                                  hit;
+    // stderr and snapshot pipes for the child (-1 after end of file);
+    // see server_child for the contents of snapshot
+    int                                   error_fd;
+    int                                   snapshot_fd;
+    string                                error_text;
+    string                                snapshot;
+    // response for the client (empty until the job is done)
+    string                                response;
+};
+// maximum number of characters in a request
+const size_t server_max_request = 1048576;
+// number of seconds a client has to send its request
+const int    server_timeout     = 10;
+// ---------------------------------------------------------------------------
+// server_child
+// Run one command for the server; this routine is run in a child process
+// and does not return. The input tables in input_cache correspond to the
+// db_input_cache_key value cache_key. The child computes the key for the
+// database and writes h (hit) or m (miss), the key, and a newline to
+// snapshot_fd. If the command reads the input tables, and they are all in
+// the primary database, the corresponding snapshot is written next.
+void server_child(
+    const string&         program     ,
+    const char*           argv_0      ,
+    const string&         database    ,
+    const vector<string>& command     ,
+    const string&         cache_key   ,
+    input_cache_struct&   input_cache ,
+    int                   snapshot_fd )
+{   vector<const char*> arg_ptr(command.size() + 2);
+    arg_ptr[0] = argv_0;
+    arg_ptr[1] = database.c_str();
+    for(size_t i = 0; i < command.size(); ++i)
+        arg_ptr[i + 2] = command[i].c_str();
+    int n_ptr = int( arg_ptr.size() );
+    check_command_arg(program, n_ptr, arg_ptr.data());
+    if( command[0] == "batch" || command[0] == "old2new" )
+    {   cerr << command[0] << " cannot be run by the server\n";
+        std::exit(1);
+    }
+    //
+    sqlite3* db = open_database(database);
+    //
+    // report
+    // another process may have changed the input tables
+    string key = dismod_at::db_input_cache_key(db);
+    if( key != cache_key )
+    {   input_cache.valid         = false;
+        input_cache.derived_valid = false;
+        input_cache.db_input      = dismod_at::db_input_struct();
+    }
+    string report = input_cache.valid ? "h" : "m";
+    report       += key + "\n";
+    //
+    bool db_input_cache = false;
+    bool primary_only   = set_db_setting(db, db_input_cache);
+    bool cold           = ! input_cache.valid;
+    run_command(n_ptr, arg_ptr.data(), db, db_input_cache, input_cache);
+    dismod_at::log_message_finalize(db);
+    sqlite3_close(db);
+    //
+    if( cold && input_cache.valid && primary_only )
+        report += dismod_at::db_input2snapshot(input_cache.db_input);
+    write_all(snapshot_fd, report);
+    std::exit(0);
+}
+// ---------------------------------------------------------------------------
+// server_receive
+// Read more of the request for job. When the request is complete,
+// job.received is set to true and the request is parsed.
+// A stop request sets stop to true. After that, other requests are errors.
+// A stop request, or an error, sets job.response.
+void server_receive(server_job_struct& job, bool& stop)
+{   string error_response = "{\"status\":\"error\",\"message\":";
+    //
+    // job.request: the characters up to the first newline or end of file
+    bool   more    = read_once(job.client_fd, job.request);
+    size_t newline = job.request.find('\n');
+    if( std::min(newline, job.request.size()) > server_max_request )
+    {   string msg   = "request is longer than ";
+        msg         += std::to_string(server_max_request) + " characters";
+        job.response = error_response + dismod_at::json_string(msg) + "}\n";
+        return;
+    }
+    if( more && newline == string::npos )
+        return;
+    job.request  = job.request.substr(0, newline);
+    job.received = true;
+    //
+    // job.database, job.command
+    string msg = dismod_at::parse_server_request(
+        job.request, job.database, job.command
+    );
+    if( msg == "" && stop )
+        msg = "the server is stopping";
+    if( msg != "" )
+    {   job.response = error_response + dismod_at::json_string(msg) + "}\n";
+        return;
+    }
+    //
+    // stop
+    if( job.command.size() == 1 && job.command[0] == "stop" )
+    {   stop         = true;
+        job.response = "{\"status\":\"ok\"}\n";
+        return;
+    }
+    //
+    // job.path
+    job.path = std::filesystem::absolute(job.database).lexically_normal();
+}
+// ---------------------------------------------------------------------------
+// server_start
+// Start the command for job in a child process so that an error_exit does
+// not terminate the server; stderr for the child goes to job.error_fd.
+// The database is only opened by the child, so the server does not wait
+// for it and a database error does not terminate the server.
+// The file descriptors in parent_fd are closed in the child.
+// If the command cannot be started, job.response is set.
+void server_start(
+    const string&                          program   ,
+    const char*                            argv_0    ,
+    const vector<int>&                     parent_fd ,
+    std::map<string, server_cache_struct>& cache_map ,
+    server_job_struct&                     job       )
+{   string error_response = "{\"status\":\"error\",\"message\":";
+    //
+    std::error_code error_code;
+    if( ! std::filesystem::is_regular_file(job.database, error_code) )
+    {   string msg   = "cannot find the database " + job.database;
+        job.response = error_response + dismod_at::json_string(msg) + "}\n";
+        return;
+    }
+    //
+    // cache
+    server_cache_struct& cache = cache_map[job.path];
+    //
+    int error_pipe[2], snapshot_pipe[2];
+    if( ::pipe(error_pipe) != 0 )
+    {   job.response = error_response + "\"pipe failed\"}\n";
+        return;
+    }
+    if( ::pipe(snapshot_pipe) != 0 )
+    {   ::close(error_pipe[0]);
+        ::close(error_pipe[1]);
+        job.response = error_response + "\"pipe failed\"}\n";
+        return;
+    }
+    std::cout.flush();
+    cerr.flush();
+    pid_t pid = ::fork();
+    if( pid == 0 )
+    {   for(size_t i = 0; i < parent_fd.size(); ++i)
+            ::close( parent_fd[i] );
+        ::close(error_pipe[0]);
+        ::close(snapshot_pipe[0]);
+        ::dup2(error_pipe[1], 2);
+        ::close(error_pipe[1]);
+        server_child(
+            program, argv_0, job.database, job.command,
+            cache.cache_key, cache.input_cache, snapshot_pipe[1]
+        );
+    }
+    ::close(error_pipe[1]);
+    ::close(snapshot_pipe[1]);
+    if( pid < 0 )
+    {   ::close(error_pipe[0]);
+        ::close(snapshot_pipe[0]);
+        job.response = error_response + "\"fork failed\"}\n";
+        return;
+    }
+    job.pid         = pid;
+    job.error_fd    = error_pipe[0];
+    job.snapshot_fd = snapshot_pipe[0];
+}
+// ---------------------------------------------------------------------------
+// server_finish
+// Set job.response after the child running its command has been reaped;
+// exit_ok is true if the child exited with status zero.
+void server_finish(
+    std::map<string, server_cache_struct>& cache_map ,
+    server_job_struct&                     job       ,
+    bool                                   exit_ok   )
+{   if( ! exit_ok )
+    {   if( job.error_text == "" )
+            job.error_text = "command terminated abnormally";
+        job.response  = "{\"status\":\"error\",\"message\":";
+        job.response += dismod_at::json_string(job.error_text) + "}\n";
+        return;
+    }
+    //
+    // job.hit, cache_key
+    size_t newline = job.snapshot.find('\n');
+    if( newline == string::npos || newline == 0 )
+    {   job.response  = "{\"status\":\"error\",\"message\":";
+        job.response += "\"command did not report its input cache\"}\n";
+        return;
+    }
+    job.hit          = job.snapshot[0] == 'h';
+    string cache_key = job.snapshot.substr(1, newline - 1);
+    //
+    // cache
+    server_cache_struct& cache = cache_map[job.path];
+    if( cache_key != cache.cache_key )
+    {   cache.cache_key            = cache_key;
+        cache.input_cache.valid    = false;
+        cache.input_cache.db_input = dismod_at::db_input_struct();
+    }
+    size_t n_byte = job.snapshot.size() - newline - 1;
+    if( n_byte > 0 )
+    {   assert( ! job.hit );
+        cache.input_cache.valid = dismod_at::snapshot2db_input(
+            job.snapshot.data() + newline + 1,
+            n_byte,
+            cache.input_cache.db_input
+        );
+    }
+    //
+    job.response  = "{\"status\":\"ok\",\"input_cache\":";
+    job.response += job.hit ? "\"hit\"}\n" : "\"miss\"}\n";
+}
+// ---------------------------------------------------------------------------
+// run_server
+// Listen for requests on the Unix domain socket socket_file until a
+// stop request is received and the commands that were started are done;
+// see command@Server Mode.
+int run_server(
+    const string& program     ,
+    const char*   argv_0      ,
+    const string& socket_file )
+{   typedef std::chrono::steady_clock             clock;
+    typedef std::list<server_job_struct>::iterator job_itr;
+    //
+    // a client that disconnects should not terminate the server
+    std::signal(SIGPIPE, SIG_IGN);
+    //
+    // address
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address) );
+    address.sun_family = AF_UNIX;
+    if( socket_file.size() >= sizeof(address.sun_path) )
+    {   cerr << program << endl;
+        cerr << "the socket_file name " << socket_file << " is too long\n";
+        return 1;
+    }
+    std::strcpy(address.sun_path, socket_file.c_str() );
+    //
+    // remove a socket left by a previous server
+    std::error_code error_code;
+    if( std::filesystem::is_socket(socket_file, error_code) )
+        std::filesystem::remove(socket_file, error_code);
+    //
+    // listen_fd
+    // only the user that started the server can connect to socket_file
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    bool ok       = listen_fd >= 0;
+    if( ok )
+    {   mode_t old_mask = ::umask(0177);
+        ok = ::bind(listen_fd,
+            reinterpret_cast<struct sockaddr*>(&address), sizeof(address)
+        ) == 0;
+        ::umask(old_mask);
+    }
+    if( ok )
+        ok = ::chmod(socket_file.c_str(), 0600) == 0;
+    if( ok )
+        ok = ::listen(listen_fd, SOMAXCONN) == 0;
+    if( ! ok )
+    {   cerr << program << endl;
+        cerr << "cannot listen on " << socket_file << ": ";
+        cerr << std::strerror(errno) << endl;
+        return 1;
+    }
+    //
+    // cache_map
+    // maps the absolute path for a database to its cached input tables
+    std::map<string, server_cache_struct> cache_map;
+    //
+    // job_list
+    // requests that have been accepted and not yet responded to
+    std::list<server_job_struct> job_list;
+    //
+    bool stop = false;
+    while( true )
+    {   // reap the children that have closed their pipes (without blocking)
+        bool wait_child = false;
+        for(job_itr itr = job_list.begin(); itr != job_list.end(); ++itr)
+        if( itr->pid > 0 && itr->error_fd < 0 && itr->snapshot_fd < 0 )
+        {   int   status = 0;
+            pid_t result = ::waitpid(itr->pid, &status, WNOHANG);
+            if( result == 0 || (result < 0 && errno == EINTR) )
+                wait_child = true;
+            else
+            {   bool exit_ok = result == itr->pid;
+                exit_ok     &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                server_finish(cache_map, *itr, exit_ok);
+                itr->pid = -1;
+            }
+        }
+        //
+        // start the commands for databases that are not in use;
+        // commands for the same database run in the order received
+        std::set<string> in_use;
+        for(job_itr itr = job_list.begin(); itr != job_list.end(); ++itr)
+        if( itr->received && itr->response == "" )
+        {   if( itr->pid < 0 && in_use.count(itr->path) == 0 )
+            {   vector<int> parent_fd;
+                parent_fd.push_back(listen_fd);
+                for(job_itr jtr = job_list.begin();
+                    jtr != job_list.end(); ++jtr)
+                {   parent_fd.push_back(jtr->client_fd);
+                    if( jtr->error_fd >= 0 )
+                        parent_fd.push_back(jtr->error_fd);
+                    if( jtr->snapshot_fd >= 0 )
+                        parent_fd.push_back(jtr->snapshot_fd);
+                }
+                server_start(program, argv_0, parent_fd, cache_map, *itr);
+            }
+            if( itr->response == "" )
+                in_use.insert(itr->path);
+        }
+        //
+        // write the responses for the jobs that are done
+        job_itr itr = job_list.begin();
+        while( itr != job_list.end() )
+        {   if( itr->response == "" )
+                ++itr;
+            else
+            {   write_all(itr->client_fd, itr->response);
+                ::close(itr->client_fd);
+                itr = job_list.erase(itr);
+            }
+        }
+        if( stop && job_list.empty() )
+            break;
+        //
+        // poll_fd, poll_job, timeout
+        // poll_job[i] is job_list.end() for listen_fd
+        vector<struct pollfd> poll_fd;
+        vector<job_itr>       poll_job;
+        int                   timeout = -1;
+        auto add_fd = [&](int fd, job_itr job)
+        {   struct pollfd element;
+            element.fd      = fd;
+            element.events  = POLLIN;
+            element.revents = 0;
+            poll_fd.push_back(element);
+            poll_job.push_back(job);
+        };
+        if( ! stop )
+            add_fd(listen_fd, job_list.end());
+        clock::time_point now = clock::now();
+        for(itr = job_list.begin(); itr != job_list.end(); ++itr)
+        {   if( ! itr->received )
+            {   add_fd(itr->client_fd, itr);
+                int ms = int( std::chrono::duration_cast<
+                    std::chrono::milliseconds>(itr->deadline - now).count()
+                ) + 1;
+                ms      = std::max(ms, 0);
+                timeout = timeout < 0 ? ms : std::min(timeout, ms);
+            }
+            if( itr->error_fd >= 0 )
+                add_fd(itr->error_fd, itr);
+            if( itr->snapshot_fd >= 0 )
+                add_fd(itr->snapshot_fd, itr);
+        }
+        if( wait_child )
+            timeout = timeout < 0 ? 10 : std::min(timeout, 10);
+        //
+        if( ::poll(poll_fd.data(), nfds_t(poll_fd.size()), timeout) < 0 )
+        {   if( errno == EINTR )
+                continue;
+            cerr << program << endl;
+            cerr << "poll failed: " << std::strerror(errno) << endl;
+            break;
+        }
+        for(size_t i = 0; i < poll_fd.size(); ++i)
+        if( poll_fd[i].revents != 0 )
+        {   int fd = poll_fd[i].fd;
+            itr    = poll_job[i];
+            if( itr == job_list.end() )
+            {   int client_fd = ::accept(
+                    listen_fd, DISMOD_AT_NULL_PTR, DISMOD_AT_NULL_PTR
+                );
+                if( client_fd < 0 && errno != EINTR )
+                {   cerr << program << endl;
+                    cerr << "accept failed: " << std::strerror(errno) << endl;
+                    stop = true;
+                }
+                if( client_fd >= 0 )
+                {   server_job_struct job;
+                    job.client_fd   = client_fd;
+                    job.deadline    = clock::now() +
+                        std::chrono::seconds(server_timeout);
+                    job.received    = false;
+                    job.pid         = -1;
+                    job.hit         = false;
+                    job.error_fd    = -1;
+                    job.snapshot_fd = -1;
+                    job_list.push_back(job);
+                }
+            }
+            else if( fd == itr->client_fd )
+                server_receive(*itr, stop);
+            else if( fd == itr->error_fd )
+            {   if( ! read_once(fd, itr->error_text) )
+                {   ::close(fd);
+                    itr->error_fd = -1;
+                }
+            }
+            else if( fd == itr->snapshot_fd )
+            {   if( ! read_once(fd, itr->snapshot) )
+                {   ::close(fd);
+                    itr->snapshot_fd = -1;
+                }
+            }
+        }
+        //
+        // requests that were not received in time
+        now = clock::now();
+        for(itr = job_list.begin(); itr != job_list.end(); ++itr)
+        if( ! itr->received && itr->response == "" && itr->deadline <= now )
+        {   string msg    = "request was not received within ";
+            msg          += std::to_string(server_timeout) + " seconds";
+            itr->response = "{\"status\":\"error\",\"message\":";
+            itr->response += dismod_at::json_string(msg) + "}\n";
+        }
+    }
+    ::close(listen_fd);
+    std::filesystem::remove(socket_file, error_code);
+    return 0;
+}
+
+} // END_EMPTY_NAMESPACE
+
+
+int main(int n_arg, const char** argv)
+{   // ---------------- using statements ----------------------------------
+    using std::cerr;
+    using std::endl;
+    using std::string;
+    using CppAD::vector;
+    // ---------------- command line arguments ---------------------------
+    //
+    // --version
+    if( n_arg == 2 )
+    {   if( strcmp( argv[1] , "--version" ) == 0 )
+        {   std::cout << "dismod_at-" DISMOD_AT_VERSION "\n";
+            return 0;
+        }
+    }
+    //
+    string program = "dismod_at-";
+    program       += DISMOD_AT_VERSION;
+# ifndef NDEBUG
+    program       += " debug build";
+# else
+    program       += " release build";
+# endif
+    if( n_arg < 3 )
+    {   cerr << program << endl
+        << "usage:    dismod_at database command [arguments]\n"
+        << "          dismod_at --server socket_file\n"
+        << "database: sqlite database\n"
+        << "command:  " << command_info[0].name;
+        size_t column = 10 + std::strlen( command_info[0].name );
+        for(size_t i = 1; i < n_command; i++)
+        {   string name = command_info[i].name;
+            if( name != command_info[i-1].name )
+            {   column += 2 + name.size();
+                if( column < 80 )
+                    cerr << ", ";
+                else
+                {   cerr << "\n          ";
+                    column = 10 + name.size();
+                }
+                cerr << name;
+            }
+        }
+        cerr << "\n"
+        << "arguments: optional arguments depending on particular command\n";
+        std::exit(1);
+    }
+    //
+    // --server
+    if( n_arg == 3 && strcmp( argv[1], "--server" ) == 0 )
+        return run_server(program, argv[0], argv[2]);
+    //
+    check_command_arg(program, n_arg, argv);
+    const string database_arg  = argv[1];
+    const string command_arg   = argv[2];
+    //
+    // command_list
+    // the arguments that follow database for each command that is run
+    vector< vector<string> > command_list;
+    if( command_arg != "batch" )
+    {   vector<string> command(n_arg - 2);
+        for(int i_arg = 2; i_arg < n_arg; ++i_arg)
+            command[i_arg - 2] = argv[i_arg];
+        command_list.push_back(command);
+    }
+    else
+    {   // batch_file is relative to the current directory (not the database)
+        const string  batch_arg = argv[3];
+        std::ifstream batch_file( batch_arg );
+        if( ! batch_file )
+        {   cerr << program << endl;
+            cerr << "cannot open the batch file " << batch_arg << endl;
+            std::exit(1);
+        }
+        string line;
+        size_t line_number = 0;
+        while( std::getline(batch_file, line) )
+        {   ++line_number;
+            vector<string> command = dismod_at::split_space(line);
+            //
+            // skip empty lines and comment lines
+            bool skip = command.size() == 0;
+            if( ! skip )
+                skip = command[0][0] == '#';
+            if( ! skip )
+            {   if( command[0] == "batch" || command[0] == "old2new" )
+                {   cerr << program << endl;
+                    cerr << batch_arg << " line " << line_number << ": ";
+                    cerr << command[0] << " cannot be in a batch file\n";
+                    std::exit(1);
+                }
+                vector<const char*> arg_ptr(command.size() + 2);
+                arg_ptr[0] = argv[0];
+                arg_ptr[1] = argv[1];
+                for(size_t i = 0; i < command.size(); ++i)
+                    arg_ptr[i + 2] = command[i].c_str();
+                int n_ptr = int( arg_ptr.size() );
+                check_command_arg(program, n_ptr, arg_ptr.data());
+                command_list.push_back(command);
+            }
+        }
+    }
+    // --------------- open connection to database ---------------------------
+    sqlite3* db = open_database(database_arg);
+    // --------------- sqlite settings for all the commands ------------------
+    // old2new may need to fix the option table before it can be read
+    bool db_input_cache = false;
+    if( command_arg != "old2new" )
+        set_db_setting(db, db_input_cache);
+    // --------------- run the commands --------------------------------------
+    input_cache_struct input_cache;
+    input_cache.valid = false;
+    for(size_t i_command = 0; i_command < command_list.size(); ++i_command)
+    {   const vector<string>& command = command_list[i_command];
+        vector<const char*> arg_ptr(command.size() + 2);
+        arg_ptr[0] = argv[0];
+        arg_ptr[1] = argv[1];
+        for(size_t i = 0; i < command.size(); ++i)
+            arg_ptr[i + 2] = command[i].c_str();
+        int n_ptr = int( arg_ptr.size() );
+        run_command(n_ptr, arg_ptr.data(), db, db_input_cache, input_cache);
+    }
+    // ---------------------------------------------------------------------
+    dismod_at::log_message_finalize(db);
     sqlite3_close(db);
     return 0;
 }
@@ -1,14 +1,14 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
+# include <tuple>
 # include <cppad/mixed/exception.hpp>
 # include <dismod_at/adj_integrand.hpp>
 # include <dismod_at/null_int.hpp>
 # include <dismod_at/a1_double.hpp>
 # include <dismod_at/grid2line.hpp>
 # include <dismod_at/cohort_ode.hpp>
-# include <dismod_at/cohort_ode.hpp>
 # include <dismod_at/get_integrand_table.hpp>
 # include <dismod_at/get_subgroup_table.hpp>
 
@@ -42,10 +42,15 @@ Syntax
 | |tab| *s_info_vec* ,
 | |tab| *pack_object*
 | );
+| *set_index* = *adjint_obj* . ``interp_set`` ( *integrand_id* )
+| *adjint_obj* . ``interp_line`` (
+| |tab| *integrand_id* , *line_age* , *line_time* , *interp*
+| )
 | *adj_line* = *adjint_obj* . ``line`` (
 | |tab| *node_id* ,
 | |tab| *line_age* ,
 | |tab| *line_time* ,
+| |tab| *interp* ,
 | |tab| *integrand_id* ,
 | |tab| *n_child* ,
 | |tab| *child* ,
@@ -53,6 +58,7 @@ Syntax
 | |tab| *x* ,
 | |tab| *pack_vec*
 | )
+| *adjint_obj* . ``cohort_cache`` ( *on* )
 
 Prototype
 *********
@@ -60,10 +66,22 @@ Prototype
     // BEGIN_ADJ_INTEGRAND_PROTOTYPE
     // END_ADJ_INTEGRAND_PROTOTYPE
 }
+{xrst_literal
+    // BEGIN_INTERP_SET_PROTOTYPE
+    // END_INTERP_SET_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_INTERP_LINE_PROTOTYPE
+    // END_INTERP_LINE_PROTOTYPE
+}
 {xrst_literal
     // BEGIN_LINE_PROTOTYPE
     // END_LINE_PROTOTYPE
 }
+{xrst_literal
+    // BEGIN_COHORT_CACHE_PROTOTYPE
+    // END_COHORT_CACHE_PROTOTYPE
+}
 
 cov2weight_obj
 **************
@@ -175,6 +193,29 @@ In this case
 *cohort_age* and *cohort_time* are better names for the
 arguments *line_age* and *line_time* .
 
+interp
+******
+For each smoothing or weighting grid that ``line`` uses
+for the integrand corresponding to *integrand_id* ,
+this contains the
+:ref:`grid2line_matrix@matrix` that interpolates from the grid to
+*line_age* , *line_time* .
+The matrices for the other grids are empty.
+It is computed by ``interp_line`` (which only depends on the
+line, the grids in *s_info_vec* and *w_info_vec* ,
+and the grids used by the integrand).
+Interpolation from a grid to the line is then just the
+:ref:`grid2line_product-name` and does not need to search the
+age and time tables.
+Each line that is used many times should have its *interp* computed once;
+see :ref:`avg_integrand_plan_rectangle@Plan` .
+
+set_index
+=========
+Integrands that use the same grids have the same *set_index* .
+An *interp* computed for one integrand can be used for any
+integrand with the same *set_index* .
+
 integrand_id
 ************
 This is the :ref:`integrand_table@integrand_id`
@@ -211,6 +252,30 @@ and *adj_line* [ *i* ] is the
 :ref:`avg_integrand@Adjusted Integrand`
 at age *line_age* [ *i* ]
 and time *line_time* [ *i* ] .
+It is a reference to a vector in *adjint_obj* and is only valid until
+the next call to ``line`` with the same type for *pack_vec* .
+
+Memory
+======
+The temporary vectors used by ``line`` are stored in *adjint_obj* .
+Once they have reached their maximum size, for each type of *pack_vec* ,
+``line`` does not allocate any memory (except when the cohort cache is on).
+
+cohort_cache
+************
+If *on* is true (false), the cohort cache is turned on (off).
+In either case, the cache is cleared.
+When the cache is on, the adjusted rates and the ODE solution for each
+cohort (integrands that require solving the ODE)
+are saved using the key
+( *node_id* , *child* , *subgroup_id* , *x* , *line_time* [0] ).
+A subsequent call to ``line`` with the same key, and with
+*line_age* equal to a prefix of the saved *line_age* ,
+uses the saved values instead of solving the ODE again.
+This is the same as recomputing because the value of the ODE solution
+at an age only depends on the solution at the previous ages.
+The cache is only valid while *pack_vec* does not change.
+The cache is off when *adjint_obj* is constructed.
 {xrst_toc_hidden
     example/devel/model/adj_integrand_xam.cpp
 }
@@ -222,6 +287,89 @@ of using this routine.
 {xrst_end adj_integrand}
 */
 
+namespace { // BEGIN_EMPTY_NAMESPACE
+
+// does grid_a have the same age and time points as grid_b
+template <class Grid_a, class Grid_b>
+bool same_grid(const Grid_a& grid_a, const Grid_b& grid_b)
+{   size_t n_age  = grid_a.age_size();
+    size_t n_time = grid_a.time_size();
+    bool same = n_age == grid_b.age_size() && n_time == grid_b.time_size();
+    for(size_t i = 0; i < n_age && same; ++i)
+        same = grid_a.age_id(i) == grid_b.age_id(i);
+    for(size_t j = 0; j < n_time && same; ++j)
+        same = grid_a.time_id(j) == grid_b.time_id(j);
+    return same;
+}
+
+// which rates, the ODE, and a covariate multiplier does an integrand need
+void integrand_need(
+    dismod_at::integrand_enum   integrand   ,
+    bool&                       need_ode    ,
+    bool&                       need_mulcov ,
+    CppAD::vector<bool>&        need_rate   )
+{   using namespace dismod_at;
+    need_ode    = false;
+    need_mulcov = false;
+    for(size_t k = 0; k < number_rate_enum; ++k)
+        need_rate[k] = false;
+    switch( integrand )
+    {
+        // -----------------------------------------------------------------
+        // need_ode = true;
+        case susceptible_enum:
+        case withC_enum:
+        case prevalence_enum:
+        case Tincidence_enum:
+        case mtspecific_enum:
+        case mtall_enum:
+        case mtstandard_enum:
+        need_ode = true;
+        //
+        // need_rate = true
+        for(size_t k = 0; k < number_rate_enum; ++k)
+            need_rate[k] = true;
+        break;
+
+        // -----------------------------------------------------------------
+        case Sincidence_enum:
+        need_rate[iota_enum] = true;
+        break;
+
+        case remission_enum:
+        need_rate[rho_enum] = true;
+        break;
+
+        case mtexcess_enum:
+        need_rate[chi_enum] = true;
+        break;
+
+        case mtother_enum:
+        need_rate[omega_enum] = true;
+        break;
+
+        case mtwith_enum:
+        need_rate[omega_enum] = true;
+        need_rate[chi_enum]   = true;
+        break;
+
+        case relrisk_enum:
+        need_rate[chi_enum]   = true;
+        need_rate[omega_enum] = true;
+        break;
+
+        case mulcov_enum:
+        need_mulcov = true;
+        break;
+
+        // -----------------------------------------------------------------
+        default:
+        assert( false);
+    }
+}
+
+} // END_EMPTY_NAMESPACE
+
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 
 // BEGIN_ADJ_INTEGRAND_PROTOTYPE
@@ -239,7 +387,7 @@ adj_integrand::adj_integrand(
     const pack_info&                          pack_object      )
 // END_ADJ_INTEGRAND_PROTOTYPE
 :
-rate_case_         (rate_case)        ,
+rate_case_         (rate_case2enum(rate_case)) ,
 age_table_         (age_table)        ,
 time_table_        (time_table)       ,
 covariate_table_    (covariate_table) ,
@@ -249,9 +397,57 @@ s_info_vec_        (s_info_vec)       ,
 pack_object_       (pack_object)      ,
 cov2weight_obj_    (cov2weight_obj)   ,
 w_info_vec_        (w_info_vec)       ,
-double_rate_       (number_rate_enum) ,
-a1_double_rate_    (number_rate_enum)
-{   // set mulcov_pack_info_
+cohort_cache_on_   (false)
+{   // record the checkpoint function used by cohort_ode<a1_double>
+    cohort_ode_checkpoint(rate_case_);
+    //
+    // double_work_, a1_double_work_
+    double_work_.rate.resize(number_rate_enum);
+    double_work_.effect_mul.resize(number_rate_enum);
+    a1_double_work_.rate.resize(number_rate_enum);
+    a1_double_work_.effect_mul.resize(number_rate_enum);
+    //
+    // grid_is_weight_, grid_id_, smooth_grid_
+    smooth_grid_.resize( s_info_vec.size() );
+    for(size_t smooth_id = 0; smooth_id < s_info_vec.size(); ++smooth_id)
+    {   const smooth_info& s_info = s_info_vec[smooth_id];
+        size_t grid_index = 0;
+        bool   found      = false;
+        while( grid_index < grid_id_.size() && ! found )
+        {   found = same_grid(s_info, s_info_vec[ grid_id_[grid_index] ]);
+            if( ! found )
+                ++grid_index;
+        }
+        if( ! found )
+        {   grid_is_weight_.push_back(false);
+            grid_id_.push_back(smooth_id);
+        }
+        smooth_grid_[smooth_id] = grid_index;
+    }
+    //
+    // grid_is_weight_, grid_id_, weight_grid_
+    weight_grid_.resize( w_info_vec.size() );
+    for(size_t weight_id = 0; weight_id < w_info_vec.size(); ++weight_id)
+    {   const weight_info& w_info = w_info_vec[weight_id];
+        size_t grid_index = 0;
+        bool   found      = false;
+        while( grid_index < grid_id_.size() && ! found )
+        {   size_t grid_id = grid_id_[grid_index];
+            if( grid_is_weight_[grid_index] )
+                found = same_grid(w_info, w_info_vec[grid_id]);
+            else
+                found = same_grid(w_info, s_info_vec[grid_id]);
+            if( ! found )
+                ++grid_index;
+        }
+        if( ! found )
+        {   grid_is_weight_.push_back(true);
+            grid_id_.push_back(weight_id);
+        }
+        weight_grid_[weight_id] = grid_index;
+    }
+    //
+    // set mulcov_pack_info_
     size_t n_integrand = integrand_table.size();
     mulcov_pack_info_.resize( mulcov_table.size() );
     CppAD::vector<size_t> rate_value_index(number_rate_enum);
@@ -303,14 +499,170 @@ a1_double_rate_    (number_rate_enum)
         }
         assert( mulcov_pack_info_[mulcov_id].smooth_id == size_t(smooth_id) );
     }
+    //
+    // grid_set_, integrand_set_
+    size_t n_grid  = grid_id_.size();
+    size_t n_child = pack_object.child_size();
+    CppAD::vector<bool> need_grid(n_grid), need_rate(number_rate_enum);
+    auto need_smooth = [&](size_t smooth_id)
+    {   if( smooth_id != DISMOD_AT_NULL_SIZE_T )
+            need_grid[ smooth_grid_[smooth_id] ] = true;
+    };
+    integrand_set_.resize(n_integrand);
+    for(size_t integrand_id = 0; integrand_id < n_integrand; ++integrand_id)
+    {   bool need_ode, need_mulcov;
+        integrand_need(
+            integrand_table[integrand_id].integrand,
+            need_ode,
+            need_mulcov,
+            need_rate
+        );
+        for(size_t grid_index = 0; grid_index < n_grid; ++grid_index)
+            need_grid[grid_index] = false;
+        //
+        // covariate multiplier integrand
+        if( need_mulcov )
+        {   int mulcov_id = integrand_table[integrand_id].mulcov_id;
+            need_smooth( mulcov_pack_info_[mulcov_id].smooth_id );
+        }
+        //
+        // rates: parent and child rates, covariate multipliers,
+        // and covariate weightings
+        for(size_t rate_id = 0; rate_id < number_rate_enum; ++rate_id)
+        if( need_rate[rate_id] )
+        {   pack_info::subvec_info info;
+            for(size_t j = 0; j <= n_child; ++j)
+            {   info = pack_object.node_rate_value_info(rate_id, j);
+                need_smooth( info.smooth_id );
+            }
+            size_t n_group_cov = pack_object.group_rate_value_n_cov(rate_id);
+            for(size_t j = 0; j < n_group_cov; ++j)
+            {   info = pack_object.group_rate_value_info(rate_id, j);
+                need_smooth( info.smooth_id );
+            }
+            size_t n_sub_cov = pack_object.subgroup_rate_value_n_cov(rate_id);
+            for(size_t j = 0; j < n_sub_cov; ++j)
+            {   size_t n_sub =
+                    pack_object.subgroup_rate_value_n_sub(rate_id, j);
+                for(size_t k = 0; k < n_sub; ++k)
+                {   info = pack_object.subgroup_rate_value_info(rate_id, j, k);
+                    need_smooth( info.smooth_id );
+                }
+            }
+            if( need_ode && n_group_cov + n_sub_cov > 0 )
+            {   size_t n_weight = cov2weight_obj.n_weight();
+                for(size_t weight_id = 0; weight_id < n_weight; ++weight_id)
+                    need_grid[ weight_grid_[weight_id] ] = true;
+            }
+        }
+        //
+        // measurement value covariate multipliers
+        if( ! need_mulcov )
+        {   pack_info::subvec_info info;
+            size_t n_cov = pack_object.group_meas_value_n_cov(integrand_id);
+            for(size_t j = 0; j < n_cov; ++j)
+            {   info = pack_object.group_meas_value_info(integrand_id, j);
+                need_smooth( info.smooth_id );
+            }
+            n_cov = pack_object.subgroup_meas_value_n_cov(integrand_id);
+            for(size_t j = 0; j < n_cov; ++j)
+            {   size_t n_sub =
+                    pack_object.subgroup_meas_value_n_sub(integrand_id, j);
+                for(size_t k = 0; k < n_sub; ++k)
+                {   info =
+                    pack_object.subgroup_meas_value_info(integrand_id, j, k);
+                    need_smooth( info.smooth_id );
+                }
+            }
+        }
+        //
+        // integrand_set_[integrand_id]
+        size_t set_index = 0;
+        bool   found     = false;
+        while( set_index < grid_set_.size() && ! found )
+        {   found = true;
+            for(size_t grid_index = 0; grid_index < n_grid; ++grid_index)
+            {   bool need = need_grid[grid_index];
+                found    &= grid_set_[set_index][grid_index] == need;
+            }
+            if( ! found )
+                ++set_index;
+        }
+        if( ! found )
+            grid_set_.push_back(need_grid);
+        integrand_set_[integrand_id] = set_index;
+    }
+}
+
+// cohort_key::operator<
+bool adj_integrand::cohort_key::operator<(const cohort_key& other) const
+{   return
+        std::tie(node_id, child, subgroup_id, time_ini, x) <
+        std::tie(
+            other.node_id,
+            other.child,
+            other.subgroup_id,
+            other.time_ini,
+            other.x
+        );
+}
+
+// BEGIN_COHORT_CACHE_PROTOTYPE
+void adj_integrand::cohort_cache(bool on)
+// END_COHORT_CACHE_PROTOTYPE
+{   cohort_cache_on_ = on;
+    double_cohort_cache_.clear();
+    a1_double_cohort_cache_.clear();
+}
+
+// BEGIN_INTERP_SET_PROTOTYPE
+size_t adj_integrand::interp_set(size_t integrand_id) const
+// END_INTERP_SET_PROTOTYPE
+{   return integrand_set_[integrand_id];
+}
+
+// BEGIN_INTERP_LINE_PROTOTYPE
+void adj_integrand::interp_line(
+    size_t                                    integrand_id     ,
+    const CppAD::vector<double>&              line_age         ,
+    const CppAD::vector<double>&              line_time        ,
+    line_interp&                              interp           ) const
+// END_INTERP_LINE_PROTOTYPE
+{   const CppAD::vector<bool>& need_grid =
+        grid_set_[ integrand_set_[integrand_id] ];
+    size_t n_grid = grid_id_.size();
+    interp.resize(n_grid);
+    for(size_t grid_index = 0; grid_index < n_grid; ++grid_index)
+    {   size_t grid_id = grid_id_[grid_index];
+        if( ! need_grid[grid_index] )
+        {   interp[grid_index].start.resize(0);
+            interp[grid_index].col.resize(0);
+            interp[grid_index].val.resize(0);
+        }
+        else if( grid_is_weight_[grid_index] )
+        {   const weight_info& w_info = w_info_vec_[grid_id];
+            grid2line_matrix(
+                line_age, line_time, age_table_, time_table_,
+                w_info, interp[grid_index]
+            );
+        }
+        else
+        {   const smooth_info& s_info = s_info_vec_[grid_id];
+            grid2line_matrix(
+                line_age, line_time, age_table_, time_table_,
+                s_info, interp[grid_index]
+            );
+        }
+    }
 }
 
 // BEGIN_LINE_PROTOTYPE
 template <class Float>
-CppAD::vector<Float> adj_integrand::line(
+const CppAD::vector<Float>& adj_integrand::line(
     size_t                                             node_id          ,
     const CppAD::vector<double>&                       line_age         ,
     const CppAD::vector<double>&                       line_time        ,
+    const line_interp&                                 interp           ,
     size_t                                             integrand_id     ,
     size_t                                             n_child          ,
     size_t                                             child            ,
@@ -318,13 +670,15 @@ CppAD::vector<Float> adj_integrand::line(
     const CppAD::vector<double>&                       x                ,
     const CppAD::vector<Float>&                        pack_vec         ,
 // END_LINE_PROTOTYPE
-    CppAD::vector<Float>&                              mulcov           ,
-    CppAD::vector< CppAD::vector<Float> >&             rate             )
+    line_work<Float>&                                  work             ,
+    std::map< cohort_key, cohort_solution<Float> >&    cohort_cache     )
 {   using CppAD::vector;
     //
     // some temporaries
     pack_info::subvec_info info;
-    vector<Float> smooth_value;
+    vector<Float>&            smooth_value = work.smooth_value;
+    vector<Float>&            mulcov       = work.mulcov;
+    vector< vector<Float> >&  rate         = work.rate;
     // ---------------------------------------------------------------------
     // integrand for this average
     integrand_enum integrand = integrand_table_[integrand_id].integrand;
@@ -336,73 +690,24 @@ CppAD::vector<Float> adj_integrand::line(
     size_t first_subgroup_id = pack_object_.first_subgroup_id(group_id);
     assert( first_subgroup_id <= subgroup_id );
     //
-    // initialize other values for this average
-    bool need_ode     = false;
-    bool need_mulcov  = false;
+    // need_ode, need_mulcov, need_rate
+    bool need_ode, need_mulcov;
     vector<bool> need_rate(number_rate_enum);
-    for(size_t k = 0; k < number_rate_enum; ++k)
-        need_rate[k] = false;
-    switch( integrand )
-    {
-        // -----------------------------------------------------------------
-        // need_ode = true;
-        case susceptible_enum:
-        case withC_enum:
-        case prevalence_enum:
-        case Tincidence_enum:
-        case mtspecific_enum:
-        case mtall_enum:
-        case mtstandard_enum:
-        need_ode = true;
-        //
-        // need_rate = true
-        for(size_t k = 0; k < number_rate_enum; ++k)
-            need_rate[k] = true;
-        break;
-
-        // -----------------------------------------------------------------
-        case Sincidence_enum:
-        need_rate[iota_enum] = true;
-        break;
-
-        case remission_enum:
-        need_rate[rho_enum] = true;
-        break;
-
-        case mtexcess_enum:
-        need_rate[chi_enum] = true;
-        break;
-
-        case mtother_enum:
-        need_rate[omega_enum] = true;
-        break;
-
-        case mtwith_enum:
-        need_rate[omega_enum] = true;
-        need_rate[chi_enum]   = true;
-        break;
-
-        case relrisk_enum:
-        need_rate[chi_enum]   = true;
-        need_rate[omega_enum] = true;
-        break;
-
-        case mulcov_enum:
-        need_mulcov = true;
-        break;
-
-        // -----------------------------------------------------------------
-        default:
-        assert( false);
-    }
+    integrand_need(integrand, need_ode, need_mulcov, need_rate);
     // number of points in line
     size_t n_line = line_age.size();
+    assert( interp.size() == grid_id_.size() );
     //
     // vector of effects
-    vector<Float> effect(n_line), temp_1(n_line), temp_2(n_line), cov_grid;
+    vector<Float>& effect   = work.effect;
+    vector<Float>& temp_1   = work.temp_1;
+    vector<Float>& temp_2   = work.temp_2;
+    vector<Float>& cov_grid = work.cov_grid;
+    effect.resize(n_line);
+    temp_2.resize(n_line);
     //
     // Effect (for error reporting)
-    vector< vector<Float> > effect_mul(number_rate_enum);
+    vector< vector<Float> >& effect_mul = work.effect_mul;
     // -----------------------------------------------------------------------
     // mulcov is special case: no ode and no effects
     if( need_mulcov )
@@ -420,22 +725,59 @@ CppAD::vector<Float> adj_integrand::line(
             smooth_value.resize(info.n_var);
             for(size_t k = 0; k < info.n_var; ++k)
                 smooth_value[k] = pack_vec[info.offset + k];
-            const smooth_info& s_info = s_info_vec_[smooth_id];
-            mulcov = grid2line(
-                line_age,
-                line_time,
-                age_table_,
-                time_table_,
-                s_info,
-                smooth_value
+            grid2line_product(
+                interp[ smooth_grid_[smooth_id] ],
+                smooth_value,
+                mulcov
             );
         }
         return mulcov;
     }
     // -----------------------------------------------------------------------
+    // check for this cohort in the cohort cache
+    vector<Float>& s_out = work.s_out;
+    vector<Float>& c_out = work.c_out;
+    s_out.resize(n_line);
+    c_out.resize(n_line);
+    cohort_key key;
+    bool cache_hit = false;
+    if( need_ode && cohort_cache_on_ )
+    {   key.node_id     = node_id;
+        key.child       = child;
+        key.subgroup_id = subgroup_id;
+        key.time_ini    = line_time[0];
+        key.x.resize( x.size() );
+        for(size_t j = 0; j < x.size(); ++j)
+            key.x[j] = x[j];
+        //
+        typename std::map< cohort_key, cohort_solution<Float> >::iterator
+            itr = cohort_cache.find(key);
+        if( itr != cohort_cache.end() )
+        {   const cohort_solution<Float>& solution = itr->second;
+            cache_hit = n_line <= solution.line_age.size();
+            for(size_t k = 0; k < n_line && cache_hit; ++k)
+                cache_hit = line_age[k] == solution.line_age[k];
+            if( cache_hit )
+            {   for(size_t rate_id = 0; rate_id < number_rate_enum; ++rate_id)
+                {   rate[rate_id].resize(n_line);
+                    effect_mul[rate_id].resize(n_line);
+                    for(size_t k = 0; k < n_line; ++k)
+                    {   rate[rate_id][k] = solution.rate[rate_id][k];
+                        effect_mul[rate_id][k] =
+                            solution.effect_mul[rate_id][k];
+                    }
+                }
+                for(size_t k = 0; k < n_line; ++k)
+                {   s_out[k] = solution.s_out[k];
+                    c_out[k] = solution.c_out[k];
+                }
+            }
+        }
+    }
+    // -----------------------------------------------------------------------
     // get value for each rate that is needed
     for(size_t rate_id = 0; rate_id < number_rate_enum; ++rate_id)
-    if( need_rate[rate_id] )
+    if( need_rate[rate_id] && ! cache_hit )
     {   rate[rate_id].resize(n_line);
         effect_mul[rate_id].resize(n_line);
         //
@@ -452,14 +794,10 @@ CppAD::vector<Float> adj_integrand::line(
             smooth_value.resize(info.n_var);
             for(size_t k = 0; k < info.n_var; ++k)
                 smooth_value[k] = pack_vec[info.offset + k];
-            const smooth_info& s_info = s_info_vec_[smooth_id];
-            rate[rate_id] = grid2line(
-                line_age,
-                line_time,
-                age_table_,
-                time_table_,
-                s_info,
-                smooth_value
+            grid2line_product(
+                interp[ smooth_grid_[smooth_id] ],
+                smooth_value,
+                rate[rate_id]
             );
         }
         //
@@ -477,16 +815,12 @@ CppAD::vector<Float> adj_integrand::line(
                 smooth_value.resize(info.n_var);
                 for(size_t k = 0; k < info.n_var; ++k)
                     smooth_value[k] = pack_vec[info.offset + k];
-                const smooth_info& s_info = s_info_vec_[smooth_id];
                 //
                 // temp_1 = child random effect
-                temp_1 = grid2line(
-                    line_age,
-                    line_time,
-                    age_table_,
-                    time_table_,
-                    s_info,
-                    smooth_value
+                grid2line_product(
+                    interp[ smooth_grid_[smooth_id] ],
+                    smooth_value,
+                    temp_1
                 );
                 for(size_t k = 0; k < n_line; ++k)
                     effect[k] += temp_1[k];
@@ -503,16 +837,12 @@ CppAD::vector<Float> adj_integrand::line(
                 smooth_value.resize(info.n_var);
                 for(size_t k = 0; k < info.n_var; ++k)
                     smooth_value[k] = pack_vec[info.offset + k];
-                const smooth_info& s_info = s_info_vec_[smooth_id];
                 //
                 // temp_1 = covariate multiplier fixed effect
-                temp_1 = grid2line(
-                    line_age,
-                    line_time,
-                    age_table_,
-                    time_table_,
-                    s_info,
-                    smooth_value
+                grid2line_product(
+                    interp[ smooth_grid_[smooth_id] ],
+                    smooth_value,
+                    temp_1
                 );
                 //
                 // temp_2 = covariate value
@@ -535,13 +865,10 @@ CppAD::vector<Float> adj_integrand::line(
                             cov_grid[i * n_time + ell] =
                                 w_info.weight(i, ell) - reference;
                     }
-                    temp_2 = grid2line(
-                        line_age,
-                        line_time,
-                        age_table_,
-                        time_table_,
-                        w_info,
-                        cov_grid
+                    grid2line_product(
+                        interp[ weight_grid_[weight_id] ],
+                        cov_grid,
+                        temp_2
                     );
                 }
                 for(size_t k = 0; k < n_line; ++k)
@@ -562,16 +889,12 @@ CppAD::vector<Float> adj_integrand::line(
                 smooth_value.resize(info.n_var);
                 for(size_t ell = 0; ell < info.n_var; ++ell)
                     smooth_value[ell] = pack_vec[info.offset + ell];
-                const smooth_info& s_info = s_info_vec_[smooth_id];
                 //
                 // temp_1 = covariate multiplier random effect
-                temp_1 = grid2line(
-                    line_age,
-                    line_time,
-                    age_table_,
-                    time_table_,
-                    s_info,
-                    smooth_value
+                grid2line_product(
+                    interp[ smooth_grid_[smooth_id] ],
+                    smooth_value,
+                    temp_1
                 );
                 //
                 // temp_2 = covariate value
@@ -594,13 +917,10 @@ CppAD::vector<Float> adj_integrand::line(
                             cov_grid[i * n_time + ell] =
                                 w_info.weight(i, ell) - reference;
                     }
-                    temp_2 = grid2line(
-                        line_age,
-                        line_time,
-                        age_table_,
-                        time_table_,
-                        w_info,
-                        cov_grid
+                    grid2line_product(
+                        interp[ weight_grid_[weight_id] ],
+                        cov_grid,
+                        temp_2
                     );
                 }
                 for(size_t ell = 0; ell < n_line; ++ell)
@@ -617,8 +937,7 @@ CppAD::vector<Float> adj_integrand::line(
     }
     // -----------------------------------------------------------------------
     // solve the ode on the cohort specified by line_age and line_time[0]
-    vector<Float> s_out(n_line), c_out(n_line);
-    if( need_ode )
+    if( need_ode && ! cache_hit )
     {
 # ifndef NDEBUG
         Float eps99  = 99.0 * CppAD::numeric_limits<Float>::epsilon();
@@ -640,9 +959,28 @@ CppAD::vector<Float> adj_integrand::line(
             s_out,
             c_out
         );
+        //
+        // save this cohort in the cohort cache
+        if( cohort_cache_on_ )
+        {   cohort_solution<Float>& solution = cohort_cache[key];
+            solution.line_age.resize(n_line);
+            solution.rate.resize(number_rate_enum);
+            solution.effect_mul.resize(number_rate_enum);
+            solution.s_out.resize(n_line);
+            solution.c_out.resize(n_line);
+            for(size_t rate_id = 0; rate_id < number_rate_enum; ++rate_id)
+            {   solution.rate[rate_id].resize(n_line);
+                solution.effect_mul[rate_id].resize(n_line);
+            }
+            solution.line_age   = line_age;
+            solution.rate       = rate;
+            solution.effect_mul = effect_mul;
+            solution.s_out      = s_out;
+            solution.c_out      = c_out;
+        }
     }
 # ifndef NDEBUG
-    else
+    else if( ! need_ode )
     {   for(size_t k = 0; k < n_line; ++k)
         {   s_out[k] = CppAD::numeric_limits<Float>::quiet_NaN();
             c_out[k] = CppAD::numeric_limits<Float>::quiet_NaN();
@@ -651,7 +989,8 @@ CppAD::vector<Float> adj_integrand::line(
 # endif
     // -----------------------------------------------------------------------
     // value of the integrand on the line
-    vector<Float> result(n_line);
+    vector<Float>& result = work.result;
+    result.resize(n_line);
     Float infinity = std::numeric_limits<double>::infinity();
     Float zero     =  0.0;
     for(size_t k = 0; k < n_line; ++k)
@@ -778,16 +1117,12 @@ CppAD::vector<Float> adj_integrand::line(
             smooth_value.resize(info.n_var);
             for(size_t k = 0; k < info.n_var; ++k)
                 smooth_value[k] = pack_vec[info.offset + k];
-            const smooth_info& s_info = s_info_vec_[smooth_id];
             //
             // temp_1 = covariate multiplier fixed effects
-            temp_1 = grid2line(
-                line_age,
-                line_time,
-                age_table_,
-                time_table_,
-                s_info,
-                smooth_value
+            grid2line_product(
+                interp[ smooth_grid_[smooth_id] ],
+                smooth_value,
+                temp_1
             );
             for(size_t k = 0; k < n_line; ++k)
                 effect[k] += temp_1[k] * x_j;
@@ -807,16 +1142,12 @@ CppAD::vector<Float> adj_integrand::line(
             smooth_value.resize(info.n_var);
             for(size_t ell = 0; ell < info.n_var; ++ell)
                 smooth_value[ell] = pack_vec[info.offset + ell];
-            const smooth_info& s_info = s_info_vec_[smooth_id];
             //
             // temp_1 = covariate multiplier random effects
-            temp_1 = grid2line(
-                line_age,
-                line_time,
-                age_table_,
-                time_table_,
-                s_info,
-                smooth_value
+            grid2line_product(
+                interp[ smooth_grid_[smooth_id] ],
+                smooth_value,
+                temp_1
             );
             for(size_t ell = 0; ell < n_line; ++ell)
                 effect[ell] += temp_1[ell] * x_j;
@@ -832,24 +1163,26 @@ CppAD::vector<Float> adj_integrand::line(
 
 # define DISMOD_AT_INSTANTIATE_ADJ_INTEGTAND_LINE(Float)                  \
     template                                                               \
-    CppAD::vector<Float> adj_integrand::line(                              \
+    const CppAD::vector<Float>& adj_integrand::line(                       \
         size_t                                        node_id          ,    \
         const CppAD::vector<double>&                  line_age         ,    \
         const CppAD::vector<double>&                  line_time        ,    \
+        const line_interp&                            interp           ,    \
         size_t                                        integrand_id     ,    \
         size_t                                        n_child          ,    \
         size_t                                        child            ,    \
         size_t                                        subgroup_id      ,    \
         const CppAD::vector<double>&                  x                ,    \
         const CppAD::vector<Float>&                   pack_vec         ,    \
-        CppAD::vector<Float>&                         mulcov           ,    \
-        CppAD::vector< CppAD::vector<Float> >&        rate                  \
+        line_work<Float>&                             work             ,    \
+        std::map< cohort_key, cohort_solution<Float> >& cohort_cache        \
     );                                                                     \
 \
-    CppAD::vector<Float> adj_integrand::line(                              \
+    const CppAD::vector<Float>& adj_integrand::line(                       \
         size_t                                        node_id          ,    \
         const CppAD::vector<double>&                  line_age         ,    \
         const CppAD::vector<double>&                  line_time        ,    \
+        const line_interp&                            interp           ,    \
         size_t                                        integrand_id     ,    \
         size_t                                        n_child          ,    \
         size_t                                        child            ,    \
@@ -860,14 +1193,15 @@ CppAD::vector<Float> adj_integrand::line(
             node_id,                                                        \
             line_age,                                                       \
             line_time,                                                      \
+            interp,                                                         \
             integrand_id,                                                   \
             n_child,                                                        \
             child,                                                          \
             subgroup_id,                                                    \
             x,                                                              \
             pack_vec,                                                       \
-            Float ## _mulcov_,                                              \
-            Float ## _rate_                                                 \
+            Float ## _work_,                                                \
+            Float ## _cohort_cache_                                         \
         );                                                                 \
     }
 
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # include <cppad/mixed/exception.hpp>
 # include <dismod_at/avg_integrand.hpp>
@@ -145,8 +145,9 @@ age_table_                 ( age_table )       ,
 time_table_                ( time_table )      ,
 integrand_table_           ( integrand_table ) ,
 w_info_vec_                ( w_info_vec )      ,
-double_time_line_object_   ( age_avg_grid )    ,
-a1_double_time_line_object_( age_avg_grid )    ,
+plan_map_                  ( new plan_map )    ,
+n_plan_point_              ( 0 )               ,
+time_line_object_          ( age_avg_grid )    ,
 adjint_obj_(
     cov2weight_obj,
     w_info_vec,
@@ -163,6 +164,43 @@ adjint_obj_(
 { }
 /*
 ------------------------------------------------------------------------------
+{xrst_begin avg_integrand_cohort_cache dev}
+
+Turn the Cohort Cache On or Off
+###############################
+
+Syntax
+******
+*avgint_obj* . ``cohort_cache`` ( *on* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_COHORT_CACHE_PROTOTYPE
+    // END_COHORT_CACHE_PROTOTYPE
+}
+
+on
+**
+If *on* is true (false), the
+:ref:`adj_integrand@cohort_cache` used by *avgint_obj* is turned on (off).
+In either case the cache is cleared.
+While the cache is on, cohorts that are shared by different calls to
+:ref:`rectangle<avg_integrand_rectangle-name>` ,
+with the same node, child, subgroup, and covariate values,
+only solve the ODE once.
+The cache must be turned off, or on again,
+before *pack_vec* changes.
+
+{xrst_end avg_integrand_cohort_cache}
+*/
+// BEGIN_COHORT_CACHE_PROTOTYPE
+void avg_integrand::cohort_cache(bool on)
+// END_COHORT_CACHE_PROTOTYPE
+{   adjint_obj_.cohort_cache(on);
+}
+/*
+------------------------------------------------------------------------------
 {xrst_begin avg_integrand_rectangle dev}
 
 Computing One Average Integrand
@@ -254,6 +292,14 @@ avg
 ***
 The return value *avg* is the average of the integrand
 using the specified weighting over the specified rectangle
+
+Plan
+****
+The :ref:`plan<avg_integrand_plan_rectangle@Plan>` for this rectangle
+is computed the first time it is needed and then reused.
+If *Float* is ``a1_double`` , only the evaluation of the integrand
+on the plan lines, and the weighted sum of these values,
+is recorded.
 {xrst_toc_hidden
     example/devel/model/avg_integrand_xam.cpp
 }
@@ -280,12 +326,138 @@ Float avg_integrand::rectangle(
     size_t                           child            ,
     size_t                           subgroup_id      ,
     const CppAD::vector<double>&     x                ,
-    const CppAD::vector<Float>&      pack_vec         ,
+    const CppAD::vector<Float>&      pack_vec         )
 // END_RECTANGLE_PROTOTYPE
-    time_line_vec<Float>&            time_line_object ,
-    CppAD::vector<Float>&            line_adj         )
+{   // plan for this rectangle
+    const rectangle_plan& plan = get_plan(
+        age_lower, age_upper, time_lower, time_upper, weight_id, integrand_id
+    );
+    //
+    // avg
+    Float avg = Float(0);
+    size_t n_line = plan.line_age.size();
+    for(size_t ell = 0; ell < n_line; ++ell)
+    {   const CppAD::vector<double>& coefficient = plan.coefficient[ell];
+        //
+        // line_adj
+        const CppAD::vector<Float>& line_adj = adjint_obj_.line(
+            node_id,
+            plan.line_age[ell],
+            plan.line_time[ell],
+            plan.interp[ell],
+            integrand_id,
+            n_child,
+            child,
+            subgroup_id,
+            x,
+            pack_vec
+        );
+        for(size_t k = 0; k < coefficient.size(); ++k)
+        {   if( coefficient[k] != 0.0 )
+                avg += coefficient[k] * line_adj[k];
+        }
+    }
+    return avg;
+}
+/*
+-----------------------------------------------------------------------------
+{xrst_begin avg_integrand_plan_rectangle dev}
+
+Compute the Plan for One Average Integrand Rectangle
+####################################################
+
+Syntax
+******
+
+| *avgint_obj* . ``plan_rectangle`` (
+| |tab| *age_lower* ,
+| |tab| *age_upper* ,
+| |tab| *time_lower* ,
+| |tab| *time_upper* ,
+| |tab| *weight_id* ,
+| |tab| *integrand_id*
+| )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_PLAN_RECTANGLE_PROTOTYPE
+    // END_PLAN_RECTANGLE_PROTOTYPE
+}
+
+Arguments
+*********
+The arguments have the same meaning as in
+:ref:`rectangle<avg_integrand_rectangle-name>` .
+
+Plan
+****
+The ages and times at which the integrand is evaluated,
+the weighting, and the trapezoidal rule coefficients for a rectangle
+do not depend on the value of the model variables.
+They are computed once and stored in a plan.
+Each later call to ``rectangle`` , for any node, child, subgroup,
+covariate values, and model variables,
+evaluates the integrand on the lines in the plan and then
+computes the average as a weighted sum of these values.
+The plan also contains the
+:ref:`adj_integrand@interp` matrices for each line,
+so the interpolation from the smoothing grids to the lines
+does not search the age and time tables.
+It only contains matrices for the grids that are used by
+integrands with the same
+:ref:`adj_integrand@interp@set_index` as *integrand_id* .
+
+Memory
+******
+The plans are stored until the total number of points in their lines
+would exceed one million.
+After that, the plan for a rectangle that has not been stored is
+computed each time it is needed.
+Copies of *avgint_obj* share the plans that were stored
+before the copy was made.
+The map from rectangles to plans is also shared, so making a copy
+does not copy the map.
+If a copy stores a new plan, it first makes its own copy of the map.
+
+Purpose
+*******
+The plan is computed the first time it is needed by ``rectangle`` .
+This routine can be used to compute it before that; e.g.,
+so that copies of *avgint_obj* that are used by different threads
+share the plan instead of each computing it.
+If the plan for this rectangle has already been stored,
+or the plans are using their maximum memory,
+this routine does nothing.
+
+{xrst_end avg_integrand_plan_rectangle}
+*/
+// BEGIN_PLAN_RECTANGLE_PROTOTYPE
+void avg_integrand::plan_rectangle(
+    double                           age_lower        ,
+    double                           age_upper        ,
+    double                           time_lower       ,
+    double                           time_upper       ,
+    size_t                           weight_id        ,
+    size_t                           integrand_id     )
+// END_PLAN_RECTANGLE_PROTOTYPE
+{   if( n_plan_point_ >= max_plan_point_ )
+        return;
+    get_plan(
+        age_lower, age_upper, time_lower, time_upper, weight_id, integrand_id
+    );
+}
+// ---------------------------------------------------------------------------
+// get_plan
+const avg_integrand::rectangle_plan& avg_integrand::get_plan(
+    double                           age_lower        ,
+    double                           age_upper        ,
+    double                           time_lower       ,
+    double                           time_upper       ,
+    size_t                           weight_id        ,
+    size_t                           integrand_id     )
 {   using CppAD::vector;
-    typedef typename time_line_vec<Float>::time_point  time_point;
+    typedef time_line_vec<double>::time_point  time_point;
 
     // numerical precision
     double eps99 = 99.0 * std::numeric_limits<double>::epsilon();
@@ -299,18 +471,6 @@ Float avg_integrand::rectangle(
     }
     const weight_info& w_info( w_info_vec_[weight_index] );
 
-    // number of ages and time in the weight grid
-    size_t n_age  = w_info.age_size();
-    size_t n_time = w_info.time_size();
-
-    // weight_grid_
-    weight_grid_.resize(n_age * n_time);
-    for(size_t i = 0; i < n_age; i++)
-    {   for(size_t j = 0; j < n_time; ++j)
-            weight_grid_[i * n_time + j] = w_info.weight(i, j);
-    }
-
-
     // integrand for this average
     integrand_enum integrand = integrand_table_[integrand_id].integrand;
 
@@ -344,22 +504,58 @@ Float avg_integrand::rectangle(
         assert( false );
     }
 
+    // check if this plan has already been computed
+    size_t interp_set = adjint_obj_.interp_set(integrand_id);
+    plan_key key(
+        age_lower,
+        age_upper,
+        time_lower,
+        time_upper,
+        weight_index,
+        need_ode,
+        interp_set
+    );
+    auto itr = plan_map_->find(key);
+    if( itr != plan_map_->end() )
+        return *(itr->second);
+    //
+    // plan
+    std::shared_ptr<rectangle_plan> plan =
+        std::make_shared<rectangle_plan>();
+    //
+    // point_line_, point_index_
+    // the value for each point in time_line_object_ is its index in
+    // these vectors.
+    point_line_.resize(0);
+    point_index_.resize(0);
+
+    // number of ages and time in the weight grid
+    size_t n_age  = w_info.age_size();
+    size_t n_time = w_info.time_size();
+
+    // weight_grid_
+    weight_grid_.resize(n_age * n_time);
+    for(size_t i = 0; i < n_age; i++)
+    {   for(size_t j = 0; j < n_time; ++j)
+            weight_grid_[i * n_time + j] = w_info.weight(i, j);
+    }
+
     // specialize the time_line object for this rectangle
-    time_line_object.specialize(
+    time_line_object_.specialize(
         age_lower, age_upper, time_lower, time_upper
     );
 
     // The extended age grid
-    const vector<double>& extend_grid = time_line_object.extend_grid();
-    size_t                sub_lower   = time_line_object.sub_lower();
-    size_t                sub_upper   = time_line_object.sub_upper();
+    const vector<double>& extend_grid = time_line_object_.extend_grid();
+    size_t                sub_lower   = time_line_object_.sub_lower();
+    size_t                sub_upper   = time_line_object_.sub_upper();
     double                age_ini     = extend_grid[0];
 
     // age_lower == extend_grid[sub_lower]
-    assert(time_line_vec<Float>::near_equal(extend_grid[sub_lower],age_lower));
+    assert(time_line_vec<double>::near_equal(extend_grid[sub_lower],age_lower));
 
     // age_upper == extend_grid[sub_upper]
-    assert(time_line_vec<Float>::near_equal(extend_grid[sub_upper],age_upper));
+    assert(time_line_vec<double>::near_equal(extend_grid[sub_upper],age_upper));
 
     // n_age: number of ages (time line for each time line)
     n_age = sub_upper - sub_lower + 1;
@@ -382,56 +578,46 @@ Float avg_integrand::rectangle(
         }
         // n_line: total number of age, time points
         size_t n_line = n_age * n_time;
-        // resize temporaris
-        line_age_.resize(n_line);
-        line_time_.resize(n_line);
         //
-        // line_age_
-        // line_time_
+        // line_age, line_time
+        vector<double> line_age(n_line), line_time(n_line);
         for(size_t i = 0; i < n_age; ++i)
         {   for(size_t j = 0; j < n_time; ++j)
             {   size_t k =  i * n_time + j;
                 size_t age_index = sub_lower + i;
-                line_age_[k]     = extend_grid[age_index];
-                line_time_[k]    = time_lower + double(j) * d_time;
+                line_age[k]      = extend_grid[age_index];
+                line_time[k]     = time_lower + double(j) * d_time;
             }
         }
-        // line_adj
-        line_adj.resize(n_line);
-        line_adj = adjint_obj_.line(
-            node_id,
-            line_age_,
-            line_time_,
-            integrand_id,
-            n_child,
-            child,
-            subgroup_id,
-            x,
-            pack_vec
-        );
         // line_weight_
         line_weight_.resize(n_line);
         line_weight_ = grid2line(
-            line_age_,
-            line_time_,
+            line_age,
+            line_time,
             age_table_,
             time_table_,
             w_info,
             weight_grid_
         );
+        plan->line_age.push_back(line_age);
+        plan->line_time.push_back(line_time);
+        adjint_obj_.interp_line(integrand_id, line_age, line_time, interp_);
+        plan->interp.push_back(interp_);
         for(size_t i = 0; i < n_age; ++i)
         {   for(size_t j = 0; j < n_time; ++j)
             {   time_point point;
                 size_t k         = i * n_time + j;
                 size_t age_index = sub_lower + i;
-                point.time       = line_time_[k];
+                point.time       = line_time[k];
                 point.weight     = line_weight_[k];
-                point.value      = line_adj[k];
-                time_line_object.add_point(age_index, point);
+                point.value      = double( point_line_.size() );
+                point_line_.push_back(0);
+                point_index_.push_back(k);
+                time_line_object_.add_point(age_index, point);
             }
         }
-        Float avg = time_line_object.age_time_avg();
-        return avg;
+        plan_coefficient(*plan);
+        return store_plan(key, plan);
     }
     // -----------------------------------------------------------------------
     assert( need_ode );
@@ -442,166 +628,151 @@ Float avg_integrand::rectangle(
     {   // initial time for this cohort
         double time_ini = time_lower - extend_grid[age_index] + age_ini;
         //
-        // add_cohort
-        add_cohort(
-            node_id,
-            time_ini,
-            time_lower,
-            time_upper,
-            weight_id,
-            integrand_id,
-            n_child,
-            child,
-            subgroup_id,
-            x,
-            pack_vec,
-            time_line_object,
-            line_adj
+        // plan_cohort
+        plan_cohort(
+            *plan, integrand_id, time_ini, time_lower, time_upper, w_info
         );
     }
     // -----------------------------------------------------------------------
     if( one_time )
-    {   Float avg = time_line_object.age_time_avg();
-        return avg;
+    {   plan_coefficient(*plan);
+        return store_plan(key, plan);
     }
     // -----------------------------------------------------------------------
     // cohorts that go through extended age grid and rectangle at time_upper
     // -----------------------------------------------------------------------
     for(size_t age_index = sub_lower; age_index <= sub_upper; ++age_index)
     {   // current time_line for this age index
-        const vector<time_point>& time_line =
-            time_line_object.time_line(age_index);
+        size_t        n_time = time_line_object_.line_size(age_index);
+        const double* time   = time_line_object_.line_time(age_index);
 
         // maximum time currently in this time line
-        assert( time_line.size() > 0 );
-        double time_max = time_line[ time_line.size() - 1 ].time;
+        assert( n_time > 0 );
+        double time_max = time[n_time - 1];
 
         // check if this cohort has already been added
-        if( ! time_line_vec<Float>::near_equal(time_max, time_upper) )
+        if( ! time_line_vec<double>::near_equal(time_max, time_upper) )
         {
             // initial time for this cohort
             double time_ini = time_upper - extend_grid[age_index] + age_ini;
             //
-            // add_cohort
-            add_cohort(
-                node_id,
-                time_ini,
-                time_lower,
-                time_upper,
-                weight_id,
-                integrand_id,
-                n_child,
-                child,
-                subgroup_id,
-                x,
-                pack_vec,
-                time_line_object,
-                line_adj
+            // plan_cohort
+            plan_cohort(
+                *plan, integrand_id, time_ini, time_lower, time_upper, w_info
             );
         }
     }
 # ifndef NDEBUG
     for(size_t age_index = sub_lower; age_index <= sub_upper; ++age_index)
-    {   const vector<time_point>& time_line =
-            time_line_object.time_line(age_index);
-        assert( time_line.size() > 0 );
+    {   size_t        n_time = time_line_object_.line_size(age_index);
+        const double* time   = time_line_object_.line_time(age_index);
+        assert( n_time > 0 );
         //
-        double time = time_line[0].time;
-        assert( time_line_vec<Float>::near_equal(time_lower, time) );
+        assert( time_line_vec<double>::near_equal(time_lower, time[0]) );
         //
-        time = time_line[ time_line.size() - 1 ].time;
-        assert( time_line_vec<Float>::near_equal(time_upper, time) );
+        assert( time_line_vec<double>::near_equal(
+            time_upper, time[n_time - 1]
+        ) );
     }
 # endif
     // -----------------------------------------------------------------------
-    // ensure that time_line_object.max_time_diff <= ode_step_size_
+    // ensure that time_line_object_.max_time_diff <= ode_step_size_
     // -----------------------------------------------------------------------
     size_t age_index, time_index;
-    double max_diff = time_line_object.max_time_diff(age_index, time_index);
+    double max_diff = time_line_object_.max_time_diff(age_index, time_index);
     while( max_diff > (1.0 + eps99) * ode_step_size_ )
     {   assert( time_index > 0 );
 
         // time_line with maximum time difference
-        const vector<time_point>& time_line =
-            time_line_object.time_line(age_index);
+        const double* time = time_line_object_.line_time(age_index);
 # ifndef NDEBUG
-        double check =
-            time_line[time_index].time - time_line[time_index-1].time;
-        assert( time_line_vec<Float>::near_equal(check, max_diff) );
+        double check = time[time_index] - time[time_index-1];
+        assert( time_line_vec<double>::near_equal(check, max_diff) );
 # endif
 
         // time at the middle of the maximum difference
-        n_time               = time_line.size();
-        double time_left     = time_line[time_index - 1].time;
-        double time_right    = time_line[time_index].time;
+        double time_left     = time[time_index - 1];
+        double time_right    = time[time_index];
         double time_mid      = (time_left + time_right) / 2.0;
 
         // initial time for cohort that goes through this time line at time_mid
         double age           = extend_grid[age_index];
         double time_ini      = time_mid - age + age_ini;
 
-        // add_cohort
-        add_cohort(
-            node_id,
-            time_ini,
-            time_lower,
-            time_upper,
-            weight_id,
-            integrand_id,
-            n_child,
-            child,
-            subgroup_id,
-            x,
-            pack_vec,
-            time_line_object,
-            line_adj
+        // plan_cohort
+        plan_cohort(
+            *plan, integrand_id, time_ini, time_lower, time_upper, w_info
         );
         //
         // max_diff, age_index, time_index
-        max_diff = time_line_object.max_time_diff(age_index, time_index);
+        max_diff = time_line_object_.max_time_diff(age_index, time_index);
     }
     // -----------------------------------------------------------------------
-    Float avg = time_line_object.age_time_avg();
-    return avg;
+    plan_coefficient(*plan);
+    return store_plan(key, plan);
+}
+// ---------------------------------------------------------------------------
+// store_plan
+const avg_integrand::rectangle_plan& avg_integrand::store_plan(
+    const plan_key&                               key    ,
+    const std::shared_ptr<const rectangle_plan>&  plan   )
+{   // n_point
+    size_t n_point = 0;
+    for(size_t ell = 0; ell < plan->line_age.size(); ++ell)
+        n_point += plan->line_age[ell].size();
+    //
+    // plan_map_, n_plan_point_, extra_plan_
+    if( n_plan_point_ + n_point <= max_plan_point_ )
+    {   // other copies of this object may be using plan_map_
+        if( plan_map_.use_count() > 1 )
+            plan_map_ = std::make_shared<plan_map>( *plan_map_ );
+        (*plan_map_)[key] = plan;
+        n_plan_point_ += n_point;
+    }
+    else
+        extra_plan_ = plan;
+    //
+    return *plan;
 }
 /*
 -----------------------------------------------------------------------------
-{xrst_begin avg_integrand_add_cohort dev}
+{xrst_begin avg_integrand_plan_cohort dev}
 {xrst_spell
-  adj
   ini
 }
 
-Add ODE Solution for One Cohort To time_line_object
-###################################################
+Add One Cohort to a Rectangle Plan
+##################################
 
 Syntax
 ******
 
-| *avg* = *avgint_obj* . ``add_cohort`` (
-| |tab| *node_id* ,
+| *avgint_obj* . ``plan_cohort`` (
+| |tab| *plan* ,
+| |tab| *integrand_id* ,
 | |tab| *time_ini* ,
 | |tab| *time_lower* ,
 | |tab| *time_upper* ,
-| |tab| *weight_id* ,
-| |tab| *integrand_id* ,
-| |tab| *n_child* ,
-| |tab| *child* ,
-| |tab| *subgroup_id* ,
-| |tab| *x* ,
-| |tab| *pack_vec* ,
-| |tab| *extend_grid* ,
-| |tab| *time_line_object* ,
-| |tab| *line_adj*
+| |tab| *w_info*
 | )
 
 Prototype
 *********
 {xrst_literal
-    // BEGIN_ADD_COHORT_PROTOTYPE
-    // END_ADD_COHORT_PROTOTYPE
+    // BEGIN_PLAN_COHORT_PROTOTYPE
+    // END_PLAN_COHORT_PROTOTYPE
 }
 
+plan
+****
+The ages and times for this cohort are added to the end of
+the lines in *plan* .
+
+integrand_id
+************
+is the integrand for this rectangle.
+It determines which grids have interpolation matrices in the plan.
+
 time_ini
 ********
 is the initial time for this cohort; i.e., the time
@@ -610,117 +781,63 @@ corresponding to :ref:`rate_table@rate_name@pini` .
 time_lower
 **********
 lower time for the rectangle restricting which points are added
-to *time_line_object* .
+to *time_line_object_* .
 
 time_upper
 **********
 upper time for the rectangle restricting which points are added
-to *time_line_object* .
-
-weight_id
-*********
-This is the :ref:`weight_table@weight_id`
-in the weight table corresponding to this average integrand.
+to *time_line_object_* .
 
-integrand_id
-************
-This is the :ref:`integrand_table@integrand_id`
-in the integrand table corresponding to this average integrand.
-
-n_child\_
-*********
-set to number of :ref:`option_table@Parent Node@Children` .
-
-child
-*****
-Is the :ref:`child_info@table_id2child@child` corresponding
-to this average.
-
-subgroup_id
-***********
-Is the :ref:`avgint_table@subgroup_id` for this average integrand.
-
-x
-*
-This is the vector of covariates for this average.
-
-Float
-=====
-The type *Float* must be ``double`` or
-:ref:`a1_double-name` .
-
-pack_vec
-********
-is all the :ref:`model_variables-name` in the order
-specified by *pack_object* .
+w_info
+******
+is the weighting for this rectangle.
 
-time_line_object
+Member Variables
 ****************
-This is the object that are adding the cohort to.
+
+time_line_object\_
+==================
 Only cohort points that have time between *time_lower*
-and *time_upper* (to numerical precision) are added.
+and *time_upper* (to numerical precision) are added to this object.
 In addition, only cohort points that have age index between
 :ref:`time_line_vec@sub_lower` and
 :ref:`time_line_vec@sub_upper`
 (inclusive) are added.
+The value for each point is its index in
+*point_line_* and *point_index_* .
 
-line_adj
-********
-is a temporary vector that is re-sized and over written
-(but not re-allocated).
-
-Member Variables
-****************
+point_line\_
+============
+For each point added to *time_line_object_* ,
+the index of this cohort in the lines of *plan* is added at the end.
 
-line_age\_
-==========
-is a temporary vector that is re-sized and over written
-(but not re-allocated).
+point_index\_
+=============
+For each point added to *time_line_object_* ,
+the index of the point in this cohort is added at the end.
 
-line_time\_
-===========
-is a temporary vector that is re-sized and over written
-(but not re-allocated).
-
-{xrst_end avg_integrand_add_cohort}
+{xrst_end avg_integrand_plan_cohort}
 */
-// BEGIN_ADD_COHORT_PROTOTYPE
-template <class Float>
-void avg_integrand::add_cohort(
-    size_t                       node_id                          ,
-    double                       time_ini                         ,
-    double                       time_lower                       ,
-    double                       time_upper                       ,
-    size_t                       weight_id                        ,
-    size_t                       integrand_id                     ,
-    size_t                       n_child                          ,
-    size_t                       child                            ,
-    size_t                       subgroup_id                      ,
-    const CppAD::vector<double>& x                                ,
-    const CppAD::vector<Float>&  pack_vec                         ,
-    time_line_vec<Float>&        time_line_object                 ,
-    CppAD::vector<Float>&        line_adj                         )
-// END_ADD_COHORT_PROTOTYPE
+// BEGIN_PLAN_COHORT_PROTOTYPE
+void avg_integrand::plan_cohort(
+    rectangle_plan&                  plan             ,
+    size_t                           integrand_id     ,
+    double                           time_ini         ,
+    double                           time_lower       ,
+    double                           time_upper       ,
+    const weight_info&               w_info           )
+// END_PLAN_COHORT_PROTOTYPE
 {   // numerical precision
     double eps99 = 99.0 * std::numeric_limits<double>::epsilon();
 
-    // weight information for this average
-    // constant weighting is at the end of w_info_vec_
-    size_t weight_index = w_info_vec_.size() - 1;
-    if( weight_id != DISMOD_AT_NULL_SIZE_T )
-    {   assert( weight_id < weight_index );
-        weight_index = weight_id;
-    }
-    const weight_info& w_info( w_info_vec_[weight_index] );
-
     // extend_grid
-    const CppAD::vector<double>& extend_grid = time_line_object.extend_grid();
+    const CppAD::vector<double>& extend_grid = time_line_object_.extend_grid();
 
     // sub_lower
-    size_t sub_lower = time_line_object.sub_lower();
+    size_t sub_lower = time_line_object_.sub_lower();
 
     // sub_upper
-    size_t sub_upper = time_line_object.sub_upper();
+    size_t sub_upper = time_line_object_.sub_upper();
 
     // age_ini
     double age_ini = extend_grid[0];
@@ -744,33 +861,18 @@ void avg_integrand::add_cohort(
     // n_line
     size_t n_line = age_index + 1;
 
-    // line_age_, line_time_
-    line_age_.resize(n_line);
-    line_time_.resize(n_line);
+    // line_age, line_time
+    CppAD::vector<double> line_age(n_line), line_time(n_line);
     for(size_t k = 0; k < n_line; ++k)
-    {   line_age_[k]  = extend_grid[k];
-        line_time_[k] = time_ini + line_age_[k] - age_ini;
+    {   line_age[k]  = extend_grid[k];
+        line_time[k] = time_ini + line_age[k] - age_ini;
     }
 
-    // line_adj
-    line_adj.resize(n_line);
-    line_adj = adjint_obj_.line(
-        node_id,
-        line_age_,
-        line_time_,
-        integrand_id,
-        n_child,
-        child,
-        subgroup_id,
-        x,
-        pack_vec
-    );
-
     // line_weight_
     line_weight_.resize(n_line);
     line_weight_ = grid2line(
-        line_age_,
-        line_time_,
+        line_age,
+        line_time,
         age_table_,
         time_table_,
         w_info,
@@ -780,24 +882,159 @@ void avg_integrand::add_cohort(
     // age_index for first point in cohort with
     // time_lower <= time and age_lower <= age
     age_index = sub_lower;
-    next_age  = line_time_[age_index] < (1.0 - eps99) * time_lower;
+    next_age  = line_time[age_index] < (1.0 - eps99) * time_lower;
     while( next_age )
     {   // cohort must intersect rectangle
         assert( age_index < sub_upper );
         //
         ++age_index;
-        next_age  = line_time_[age_index] < (1.0 - eps99) * time_lower;
+        next_age  = line_time[age_index] < (1.0 - eps99) * time_lower;
     }
 
-    // time_line_object.add_point
+    // time_line_object_.add_point
+    size_t ell = plan.line_age.size();
     for(size_t k = age_index; k < n_line; ++k)
-    {   typename time_line_vec<Float>::time_point point;
-        point.time       = line_time_[k];
+    {   time_line_vec<double>::time_point point;
+        point.time       = line_time[k];
         point.weight     = line_weight_[k];
-        point.value      = line_adj[k];
-        time_line_object.add_point(k, point);
+        point.value      = double( point_line_.size() );
+        point_line_.push_back(ell);
+        point_index_.push_back(k);
+        time_line_object_.add_point(k, point);
     }
 
+    // plan
+    plan.line_age.push_back(line_age);
+    plan.line_time.push_back(line_time);
+    adjint_obj_.interp_line(integrand_id, line_age, line_time, interp_);
+    plan.interp.push_back(interp_);
+
+    return;
+}
+/*
+-----------------------------------------------------------------------------
+{xrst_begin avg_integrand_plan_coefficient dev}
+
+Set the Coefficients in a Rectangle Plan
+########################################
+
+Syntax
+******
+*avgint_obj* . ``plan_coefficient`` ( *plan* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_PLAN_COEFFICIENT_PROTOTYPE
+    // END_PLAN_COEFFICIENT_PROTOTYPE
+}
+
+plan
+****
+On input, the ages and times for each line in *plan* have been set.
+Upon return, the coefficients for each line have been set.
+
+time_line_object\_
+******************
+This member variable contains the points in the rectangle.
+The value for each point is its index in
+*point_line_* and *point_index_* .
+
+Method
+******
+The :ref:`time_line_vec@age_time_avg` is a linear function of the
+values at the points in *time_line_object_* .
+The coefficient for each point is the derivative of the average
+with respect to the value at the point.
+The coefficient is zero for points in the plan lines that are not in
+*time_line_object_* .
+
+{xrst_end avg_integrand_plan_coefficient}
+*/
+// BEGIN_PLAN_COEFFICIENT_PROTOTYPE
+void avg_integrand::plan_coefficient(rectangle_plan& plan)
+// END_PLAN_COEFFICIENT_PROTOTYPE
+{   using CppAD::vector;
+    //
+    // plan.coefficient
+    size_t n_line = plan.line_age.size();
+    plan.coefficient.resize(n_line);
+    for(size_t ell = 0; ell < n_line; ++ell)
+    {   size_t n_point = plan.line_age[ell].size();
+        plan.coefficient[ell].resize(n_point);
+        for(size_t k = 0; k < n_point; ++k)
+            plan.coefficient[ell][k] = 0.0;
+    }
+    //
+    const vector<double>& extend_grid = time_line_object_.extend_grid();
+    size_t                sub_lower   = time_line_object_.sub_lower();
+    size_t                sub_upper   = time_line_object_.sub_upper();
+    size_t                n_sub       = sub_upper - sub_lower + 1;
+    //
+    // time_coef
+    // coefficient for each point in average w.r.t time (before dividing by
+    // the sum of the weights w.r.t. time)
+    vector<double> time_coef( point_line_.size() );
+    //
+    // sum_w
+    // integral of weight w.r.t. time for each age
+    vector<double> sum_w(n_sub);
+    for(size_t i = 0; i < n_sub; ++i)
+    {   size_t        n_time = time_line_object_.line_size(sub_lower + i);
+        const double* time   = time_line_object_.line_time(sub_lower + i);
+        const double* w      = time_line_object_.line_weight(sub_lower + i);
+        const double* value  = time_line_object_.line_value(sub_lower + i);
+        assert( n_time >= 1 );
+        if( n_time == 1 )
+        {   size_t p     = size_t( value[0] );
+            sum_w[i]     = w[0];
+            time_coef[p] = w[0];
+        }
+        else
+        {   sum_w[i] = 0.0;
+            for(size_t j = 0; j < n_time; ++j)
+                time_coef[ size_t( value[j] ) ] = 0.0;
+            for(size_t j = 1; j < n_time; ++j)
+            {   double dt  = time[j] - time[j-1];
+                sum_w[i]  += dt * (w[j] + w[j-1]) / 2.0;
+                time_coef[ size_t( value[j-1] ) ] += dt * w[j-1] / 2.0;
+                time_coef[ size_t( value[j] ) ]   += dt * w[j] / 2.0;
+            }
+        }
+    }
+    //
+    // age_coef, weight
+    // coefficient for each age in average w.r.t. age and the sum of the
+    // weights w.r.t. age and time
+    vector<double> age_coef(n_sub);
+    double weight = 0.0;
+    if( n_sub == 1 )
+    {   age_coef[0] = 1.0;
+        weight      = sum_w[0];
+    }
+    else
+    {   for(size_t i = 0; i < n_sub; ++i)
+            age_coef[i] = 0.0;
+        for(size_t i = 1; i < n_sub; ++i)
+        {   size_t k       = i + sub_lower;
+            double da      = extend_grid[k] - extend_grid[k-1];
+            weight        += da * (sum_w[i] + sum_w[i-1]) / 2.0;
+            age_coef[i]   += da / 2.0;
+            age_coef[i-1] += da / 2.0;
+        }
+    }
+    //
+    // plan.coefficient
+    for(size_t i = 0; i < n_sub; ++i)
+    {   size_t        n_time = time_line_object_.line_size(sub_lower + i);
+        const double* value  = time_line_object_.line_value(sub_lower + i);
+        for(size_t j = 0; j < n_time; ++j)
+        {   size_t p   = size_t( value[j] );
+            size_t ell = point_line_[p];
+            size_t k   = point_index_[p];
+            plan.coefficient[ell][k] = time_coef[p] * age_coef[i] / weight;
+        }
+    }
     return;
 }
 
@@ -815,9 +1052,7 @@ void avg_integrand::add_cohort(
         size_t                           child            ,    \
         size_t                           subgroup_id      ,    \
         const CppAD::vector<double>&     x                ,    \
-        const CppAD::vector<Float>&      pack_vec         ,    \
-        time_line_vec<Float>&            time_line_object ,    \
-        CppAD::vector<Float>&            line_adj              \
+        const CppAD::vector<Float>&      pack_vec              \
     );                                                         \
 \
     Float avg_integrand::rectangle(                           \
@@ -833,7 +1068,7 @@ void avg_integrand::add_cohort(
         size_t                           subgroup_id      ,    \
         const CppAD::vector<double>&     x                ,    \
         const CppAD::vector<Float>&      pack_vec         )    \
-    {   return rectangle(                                      \
+    {   return rectangle<Float>(                               \
             node_id,                                           \
             age_lower,                                         \
             age_upper,                                         \
@@ -845,28 +1080,9 @@ void avg_integrand::add_cohort(
             child,                                             \
             subgroup_id,                                       \
             x,                                                 \
-            pack_vec,                                          \
-            Float ## _time_line_object_,                       \
-            Float ## _line_adj_                                \
+            pack_vec                                           \
         );                                                    \
-    }                                                        \
-\
-    template                                                  \
-    void avg_integrand::add_cohort(                           \
-        size_t                       node_id              ,    \
-        double                       time_ini             ,    \
-        double                       time_lower           ,    \
-        double                       time_upper           ,    \
-        size_t                       weight_id            ,    \
-        size_t                       integrand_id         ,    \
-        size_t                       n_child              ,    \
-        size_t                       child                ,    \
-        size_t                       subgroup_id          ,    \
-        const CppAD::vector<double>& x                    ,    \
-        const CppAD::vector<Float>&  pack_vec             ,    \
-        time_line_vec<Float>&        time_line_object     ,    \
-        CppAD::vector<Float>&        line_adj                  \
-        );
+    }
 
 // instantiations
 DISMOD_AT_INSTANTIATE_AVG_INTEGRAND_RECTANGLE( double )
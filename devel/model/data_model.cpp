@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin data_model_ctor dev}
@@ -225,6 +225,10 @@ arguments to the ``data_model`` constructor and are passed through
 {xrst_end data_model_ctor}
 -----------------------------------------------------------------------------
 */
+# include <atomic>
+# include <vector>
+# include <algorithm>
+# include <exception>
 # include <cppad/mixed/exception.hpp>
 # include <dismod_at/min_max_vector.hpp>
 # include <dismod_at/data_model.hpp>
@@ -235,6 +239,7 @@ arguments to the ``data_model`` constructor and are passed through
 # include <dismod_at/avgint_subset.hpp>
 # include <dismod_at/null_int.hpp>
 # include <dismod_at/error_exit.hpp>
+# include <dismod_at/thread_team.hpp>
 
 namespace {
     template <class Float>
@@ -318,7 +323,8 @@ avg_noise_obj_(
     w_info_vec,
     s_info_vec,
     pack_object
-)
+),
+n_thread_(1)
 {   assert( bound_random >= 0.0 );
     assert( n_child_ == pack_object.child_size() );
     // ------------------------------------------------------------------------
@@ -366,6 +372,20 @@ avg_noise_obj_(
         subset_data_obj_[i].time_upper   = subset_object[i].time_upper;
     }
     // -----------------------------------------------------------------------
+    // avgint_obj_.plan_rectangle
+    //
+    // compute the plans before any copies of avgint_obj_ are made for threads
+    for(size_t i = 0; i < n_subset; i++)
+    {   avgint_obj_.plan_rectangle(
+            subset_data_obj_[i].age_lower,
+            subset_data_obj_[i].age_upper,
+            subset_data_obj_[i].time_lower,
+            subset_data_obj_[i].time_upper,
+            size_t( subset_data_obj_[i].weight_id ),
+            size_t( subset_data_obj_[i].integrand_id )
+        );
+    }
+    // -----------------------------------------------------------------------
     // data_info_
     //
     // has same size as subset_data_obj
@@ -601,6 +621,43 @@ void data_model::replace_like(
     replace_like_called_ = true;
     return;
 }
+/*
+-----------------------------------------------------------------------------
+{xrst_begin data_model_set_thread_count dev}
+
+Set Number of Threads Used For Double Evaluation of Data Model
+##############################################################
+
+Syntax
+******
+*data_object* . ``set_thread_count`` ( *n_thread* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_SET_THREAD_COUNT_PROTOTYPE
+    // END_SET_THREAD_COUNT_PROTOTYPE
+}
+
+n_thread
+********
+is the number of threads used by the double versions of
+:ref:`data_model_like_all-name` , :ref:`data_model_like_all_avg-name` ,
+and by :ref:`data_model_average_all-name` .
+It must be greater than zero and is usually the value of the
+:ref:`option_table@thread_count` option.
+The constructor sets the number of threads to one.
+Each thread uses its own copy of the temporaries in *data_object* .
+The results do not depend on the number of threads.
+
+{xrst_end data_model_set_thread_count}
+*/
+// BEGIN_SET_THREAD_COUNT_PROTOTYPE
+void data_model::set_thread_count(size_t n_thread)
+// END_SET_THREAD_COUNT_PROTOTYPE
+{   assert( n_thread > 0 );
+    n_thread_ = n_thread;
+}
 
 /*
 -----------------------------------------------------------------------------
@@ -670,6 +727,13 @@ template <class Float>
 Float data_model::average(
     size_t                        subset_id ,
     const CppAD::vector<Float>&   pack_vec  )
+{   return average(subset_id, pack_vec, avgint_obj_);
+}
+template <class Float>
+Float data_model::average(
+    size_t                        subset_id  ,
+    const CppAD::vector<Float>&   pack_vec   ,
+    avg_integrand&                avgint_obj )
 {
     // arguments to avg_integrand::rectangle
     const subset_data_struct& data_item = subset_data_obj_[subset_id];
@@ -687,7 +751,7 @@ Float data_model::average(
         x[j] = subset_cov_value_[subset_id * n_covariate_ + j];
     //
     // compute average integrand
-    Float result = avgint_obj_.rectangle(
+    Float result = avgint_obj.rectangle(
         node_id,
         age_lower,
         age_upper,
@@ -835,6 +899,15 @@ residual_struct<Float> data_model::like_one(
     const CppAD::vector<Float>&   pack_vec  ,
     const Float&                  avg       ,
     Float&                        delta_out )
+{   return like_one(subset_id, pack_vec, avg, delta_out, avg_noise_obj_);
+}
+template <class Float>
+residual_struct<Float> data_model::like_one(
+    size_t                        subset_id     ,
+    const CppAD::vector<Float>&   pack_vec      ,
+    const Float&                  avg           ,
+    Float&                        delta_out     ,
+    avg_noise_effect&             avg_noise_obj )
 {
     assert( pack_object_size_ == pack_vec.size() );
     assert( replace_like_called_ );
@@ -863,11 +936,11 @@ residual_struct<Float> data_model::like_one(
     {   int data_id = subset_data_obj_[subset_id].original_id;
         std::string msg = "like_one: density = binomial, average integrand = ";
         msg += CppAD::to_string(avg) + " data_id = " + CppAD::to_string(data_id);
-        error_exit(msg);
+        throw CppAD::mixed::exception( "like_one", msg);
     }
     //
     // average noise effect
-    Float std_effect = avg_noise_obj_.rectangle(
+    Float std_effect = avg_noise_obj.rectangle(
         age_lower,
         age_upper,
         time_lower,
@@ -1053,6 +1126,23 @@ minus the number for which
 :ref:`data_table@hold_out` is one.
 The order of the residuals is not specified in this case.
 
+Cohort Cache
+************
+During this call the :ref:`avg_integrand_cohort_cache-name` is on.
+Thus each cohort that is shared by more than one data point
+(same node, child, subgroup, covariate values and initial time)
+only has its ODE solved once.
+This does not change the value of the residuals.
+
+Threads
+*******
+If *Float* is ``double`` and :ref:`data_model_set_thread_count-name`
+specified more than one thread,
+the data points are divided between the threads.
+Each thread uses its own copy of the average integrand object
+(and its cohort cache).
+This does not change the value of the residuals or their order.
+
 Log Density
 ***********
 The log of the density
@@ -1076,9 +1166,10 @@ CppAD::vector< residual_struct<Float> > data_model::like_all(
     const CppAD::vector<Float>& pack_vec      )
 {   assert( replace_like_called_ );
     //
-    // loop over the subsampled data
-    CppAD::vector< residual_struct<Float> > residual_vec;
-    for(size_t subset_id = 0; subset_id < subset_data_obj_.size(); subset_id++)
+    // subset_list: the subsampled data that is included
+    CppAD::vector<size_t> subset_list;
+    size_t n_subset = subset_data_obj_.size();
+    for(size_t subset_id = 0; subset_id < n_subset; ++subset_id)
     {   bool keep = hold_out == false;
         keep     |= subset_data_obj_[subset_id].hold_out == 0;
         if( random_depend )
@@ -1087,17 +1178,472 @@ CppAD::vector< residual_struct<Float> > data_model::like_all(
             keep &= data_info_[subset_id].depend_on_ran_var == false;
         assert( data_info_[subset_id].child <= n_child_ );
         if( keep )
-        {   Float avg = average(subset_id, pack_vec);
+            subset_list.push_back(subset_id);
+    }
+    //
+    // compute the residuals and log likelihoods
+    CppAD::vector<Float> avg_vec, delta_vec;
+    CppAD::vector< residual_struct<Float> > residual_vec;
+    like_list(subset_list, pack_vec, avg_vec, delta_vec, residual_vec);
+    //
+    return residual_vec;
+}
+/*
+-------------------------------------------------------------------------------
+{xrst_begin data_model_like_child dev}
 
-            // compute its residual and log likelihood
-            Float not_used;
-            residual_struct<Float> residual =
-                like_one(subset_id, pack_vec, avg, not_used);
-            residual_vec.push_back( residual );
-        }
+Weighted Residuals and Log-Likelihoods for One Child
+####################################################
+
+Syntax
+******
+*residual_vec* = *data_object* . ``like_child`` ( *child* , *pack_vec* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_LIKE_CHILD_PROTOTYPE
+    // END_LIKE_CHILD_PROTOTYPE
+}
+
+Requirement
+***********
+One must call :ref:`replace_like<data_model_replace_like-name>`
+before calling this function.
+
+data_object
+***********
+see :ref:`data_object constructor<data_model_ctor@data_object>` .
+It is effectively const.
+
+Float
+*****
+The type *Float* must be ``double`` or
+:ref:`a1_double-name` .
+
+child
+*****
+is the :ref:`child_info@table_id2child@child` index
+(less than the number of children) that we are computing residuals for.
+
+pack_vec
+********
+is all the :ref:`model_variables-name` in the order
+specified by :ref:`pack_info-name` .
+Only the fixed effects and the random effects for this *child*
+affect the result.
+
+residual_vec
+************
+This is the same as
+
+    *data_object* . ``like_all`` ( ``true`` , ``true`` , *pack_vec* )
+
+except that it only includes the data points that correspond
+to the specified *child* .
+
+{xrst_end data_model_like_child}
+*/
+// BEGIN_LIKE_CHILD_PROTOTYPE
+template <class Float>
+CppAD::vector< residual_struct<Float> > data_model::like_child(
+    size_t                      child         ,
+    const CppAD::vector<Float>& pack_vec      )
+// END_LIKE_CHILD_PROTOTYPE
+{   assert( replace_like_called_ );
+    assert( child < n_child_ );
+    //
+    // subset_list: data for this child that is included
+    CppAD::vector<size_t> subset_list;
+    size_t n_subset = subset_data_obj_.size();
+    for(size_t subset_id = 0; subset_id < n_subset; ++subset_id)
+    {   bool keep = subset_data_obj_[subset_id].hold_out == 0;
+        keep     &= data_info_[subset_id].depend_on_ran_var == true;
+        keep     &= data_info_[subset_id].child == child;
+        if( keep )
+            subset_list.push_back(subset_id);
     }
+    //
+    // compute the residuals and log likelihoods
+    CppAD::vector<Float> avg_vec, delta_vec;
+    CppAD::vector< residual_struct<Float> > residual_vec;
+    like_list(subset_list, pack_vec, avg_vec, delta_vec, residual_vec);
+    //
     return residual_vec;
 }
+/*
+-------------------------------------------------------------------------------
+{xrst_begin data_model_like_all_avg dev}
+
+Average Integrand and Residual for All Data Points
+##################################################
+
+Syntax
+******
+
+| *data_object* . ``like_all_avg`` (
+| |tab| *pack_vec* , *avg_vec* , *delta_vec* , *residual_vec*
+| )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_LIKE_ALL_AVG_PROTOTYPE
+    // END_LIKE_ALL_AVG_PROTOTYPE
+}
+
+Requirement
+***********
+One must call :ref:`replace_like<data_model_replace_like-name>`
+before calling this function.
+
+data_object
+***********
+see :ref:`data_object constructor<data_model_ctor@data_object>` .
+It is effectively const.
+
+pack_vec
+********
+is all the :ref:`model_variables-name` in the order
+specified by :ref:`pack_info-name` .
+
+n_subset
+********
+We use *n_subset* for the number of subset data values
+:ref:`subset_data@subset_data_obj@n_subset` .
+All the subset data values are included (no hold outs).
+
+avg_vec
+*******
+The input size and value of this vector does not matter.
+Upon return it has size *n_subset* and
+*avg_vec* [ *subset_id* ] is the
+:ref:`average integrand<data_model_average-name>`
+for the corresponding data point.
+
+delta_vec
+*********
+The input size and value of this vector does not matter.
+Upon return it has size *n_subset* and
+*delta_vec* [ *subset_id* ] is the transformed standard deviation
+:ref:`data_model_like_one@delta_out` for the corresponding data point.
+
+residual_vec
+************
+The input size and value of this vector does not matter.
+Upon return it has size *n_subset* and
+*residual_vec* [ *subset_id* ] is the
+:ref:`data_model_like_one@residual` for the corresponding data point.
+
+Threads
+*******
+The calculation is split between the number of threads specified by
+:ref:`data_model_set_thread_count-name` .
+The results do not depend on the number of threads.
+
+{xrst_end data_model_like_all_avg}
+*/
+// BEGIN_LIKE_ALL_AVG_PROTOTYPE
+void data_model::like_all_avg(
+    const CppAD::vector<double>&              pack_vec     ,
+    CppAD::vector<double>&                    avg_vec      ,
+    CppAD::vector<double>&                    delta_vec    ,
+    CppAD::vector< residual_struct<double> >& residual_vec )
+// END_LIKE_ALL_AVG_PROTOTYPE
+{   assert( replace_like_called_ );
+    size_t n_subset = subset_data_obj_.size();
+    CppAD::vector<size_t> subset_list(n_subset);
+    for(size_t subset_id = 0; subset_id < n_subset; ++subset_id)
+        subset_list[subset_id] = subset_id;
+    like_list(subset_list, pack_vec, avg_vec, delta_vec, residual_vec);
+}
+// ------------------------------------------------------------------------
+// like_list
+template <class Float>
+void data_model::like_list(
+    const CppAD::vector<size_t>&              subset_list  ,
+    const CppAD::vector<Float>&               pack_vec     ,
+    CppAD::vector<Float>&                     avg_vec      ,
+    CppAD::vector<Float>&                     delta_vec    ,
+    CppAD::vector< residual_struct<Float> >&  residual_vec )
+{   size_t n_list = subset_list.size();
+    avg_vec.resize(n_list);
+    delta_vec.resize(n_list);
+    residual_vec.resize(n_list);
+    //
+    // Cohorts that are shared by different data points only solve the ODE
+    // once during this call (pack_vec does not change during the loop).
+    avgint_obj_.cohort_cache(true);
+    try
+    {   for(size_t k = 0; k < n_list; ++k)
+        {   size_t subset_id = subset_list[k];
+            avg_vec[k]       = average(subset_id, pack_vec, avgint_obj_);
+            residual_vec[k]  = like_one(
+                subset_id, pack_vec, avg_vec[k], delta_vec[k], avg_noise_obj_
+            );
+        }
+    }
+    catch(...)
+    {   // do not leave cache entries that depend on this pack_vec
+        avgint_obj_.cohort_cache(false);
+        throw;
+    }
+    avgint_obj_.cohort_cache(false);
+}
+void data_model::like_list(
+    const CppAD::vector<size_t>&              subset_list  ,
+    const CppAD::vector<double>&              pack_vec     ,
+    CppAD::vector<double>&                    avg_vec      ,
+    CppAD::vector<double>&                    delta_vec    ,
+    CppAD::vector< residual_struct<double> >& residual_vec )
+{   size_t n_list = subset_list.size();
+    //
+    // case where one thread is used
+    if( n_thread_ == 1 || n_list < 2 * n_thread_ )
+    {   like_list<double>(
+            subset_list, pack_vec, avg_vec, delta_vec, residual_vec
+        );
+        return;
+    }
+    //
+    // These vectors are allocated in sequential mode and each element
+    // is set by one of the threads.
+    avg_vec.resize(n_list);
+    delta_vec.resize(n_list);
+    residual_vec.resize(n_list);
+    //
+    // n_chunk: number of consecutive data points in a task
+    // (consecutive data points are more likely to share cohorts)
+    size_t n_chunk = 1 + n_list / (16 * n_thread_);
+    //
+    // error_k, error_ptr
+    // first error for each thread (chunks are in increasing order)
+    size_t n_none = n_list;
+    CppAD::vector<size_t>            error_k(n_thread_);
+    std::vector<std::exception_ptr>  error_ptr(n_thread_);
+    for(size_t thread = 0; thread < n_thread_; ++thread)
+        error_k[thread] = n_none;
+    //
+    // work
+    // chunks are taken in increasing order, so once a thread gets a start
+    // that is not less than the smallest failing index, it has no more work
+    std::atomic<size_t> next_start(0);
+    std::atomic<size_t> first_error(n_none);
+    auto work = [&](size_t thread)
+    {   // temporaries for this thread
+        avg_integrand    avgint_obj(avgint_obj_);
+        avg_noise_effect avg_noise_obj(avg_noise_obj_);
+        avgint_obj.cohort_cache(true);
+        //
+        size_t start = next_start.fetch_add(n_chunk);
+        while( start < n_list && start < first_error )
+        {   size_t stop = std::min(start + n_chunk, n_list);
+            size_t k    = start;
+            try
+            {   for(k = start; k < stop; ++k)
+                {   size_t subset_id = subset_list[k];
+                    avg_vec[k]       = average(subset_id, pack_vec, avgint_obj);
+                    residual_vec[k]  = like_one(
+                        subset_id, pack_vec, avg_vec[k], delta_vec[k],
+                        avg_noise_obj
+                    );
+                }
+            }
+            catch(...)
+            {   // indices larger than k will not be needed
+                error_k[thread]   = k;
+                error_ptr[thread] = std::current_exception();
+                size_t previous   = first_error;
+                while( k < previous &&
+                    ! first_error.compare_exchange_weak(previous, k)
+                ) { }
+                return;
+            }
+            start = next_start.fetch_add(n_chunk);
+        }
+    };
+    thread_team(n_thread_, work);
+    //
+    // error with the smallest index in subset_list; i.e., the exception
+    // that would be thrown if the data points were computed in order
+    size_t first = n_thread_;
+    for(size_t thread = 0; thread < n_thread_; ++thread)
+    {   if( error_k[thread] != n_none )
+        {   if( first == n_thread_ )
+                first = thread;
+            else if( error_k[thread] < error_k[first] )
+                first = thread;
+        }
+    }
+    if( first < n_thread_ )
+        std::rethrow_exception( error_ptr[first] );
+}
+/*
+-------------------------------------------------------------------------------
+{xrst_begin data_model_average_all dev}
+
+Average Integrand for All Samples and All Data Points
+#####################################################
+
+Syntax
+******
+
+| *data_object* . ``average_all`` (
+| |tab| *n_sample* , *variable_value* , *avg_vec* , *error_id*
+| )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_AVERAGE_ALL_PROTOTYPE
+    // END_AVERAGE_ALL_PROTOTYPE
+}
+
+data_object
+***********
+see :ref:`data_object constructor<data_model_ctor@data_object>` .
+It is effectively const.
+
+n_var
+*****
+We use *n_var* for the number of :ref:`model_variables-name` .
+
+n_subset
+********
+We use *n_subset* for the number of subset data values
+:ref:`subset_data@subset_data_obj@n_subset` .
+
+n_sample
+********
+is the number of sets of model variables.
+
+variable_value
+**************
+This vector has size *n_sample* * *n_var* .
+For each *sample_index* ,
+the model variables for that sample,
+in the order specified by :ref:`pack_info-name` ,
+are the elements
+
+    *variable_value* [ *sample_index* * *n_var* + *var_id* ]
+
+for *var_id* = 0 , ... , *n_var* ``-1`` .
+
+avg_vec
+*******
+The input size and value of this vector does not matter.
+Upon return it has size *n_sample* * *n_subset* and
+
+    *avg_vec* [ *sample_index* * *n_subset* + *subset_id* ]
+
+is the :ref:`average integrand<data_model_average-name>`
+for the corresponding sample and data point.
+
+error_id
+********
+The input value of *error_id* does not matter.
+If this routine throws an exception, *error_id* is the
+*subset_id* for the data point that caused the exception.
+If more than one sample caused an exception,
+the exception and *error_id* correspond to the smallest *sample_index* .
+This is the same exception that would be thrown
+if the samples were computed in order using one thread.
+
+Threads
+*******
+The samples are divided between the number of threads specified by
+:ref:`data_model_set_thread_count-name` .
+Each thread uses its own copy of the average integrand object.
+The results do not depend on the number of threads.
+
+{xrst_end data_model_average_all}
+*/
+// BEGIN_AVERAGE_ALL_PROTOTYPE
+void data_model::average_all(
+    size_t                                    n_sample       ,
+    const CppAD::vector<double>&              variable_value ,
+    CppAD::vector<double>&                    avg_vec        ,
+    size_t&                                   error_id       )
+// END_AVERAGE_ALL_PROTOTYPE
+{   size_t n_var    = variable_value.size() / std::max(n_sample, size_t(1));
+    size_t n_subset = subset_data_obj_.size();
+    assert( n_var * n_sample == variable_value.size() );
+    assert( n_var == pack_object_size_ || n_sample == 0 );
+    //
+    // avg_vec
+    // allocated in sequential mode, each element is set by one thread
+    avg_vec.resize(n_sample * n_subset);
+    //
+    // n_thread
+    size_t n_thread = std::min(n_thread_, std::max(n_sample, size_t(1)));
+    //
+    // error_sample, error_subset, error_ptr
+    // first error for each thread (samples are in increasing order)
+    size_t n_none = n_sample;
+    CppAD::vector<size_t>            error_sample(n_thread);
+    CppAD::vector<size_t>            error_subset(n_thread);
+    std::vector<std::exception_ptr>  error_ptr(n_thread);
+    for(size_t thread = 0; thread < n_thread; ++thread)
+        error_sample[thread] = n_none;
+    //
+    // work
+    // samples are taken in increasing order, so once a thread gets an index
+    // that is not less than the smallest failing index, it has no more work
+    std::atomic<size_t> next_sample(0);
+    std::atomic<size_t> first_error(n_none);
+    auto work = [&](size_t thread)
+    {   // temporaries for this thread
+        avg_integrand         avgint_obj(avgint_obj_);
+        CppAD::vector<double> pack_vec(n_var);
+        //
+        size_t sample_index = next_sample++;
+        while( sample_index < n_sample && sample_index < first_error )
+        {   for(size_t var_id = 0; var_id < n_var; ++var_id)
+                pack_vec[var_id] = variable_value[sample_index * n_var + var_id];
+            //
+            // cohorts that are shared by data points in this sample
+            avgint_obj.cohort_cache(true);
+            size_t subset_id = 0;
+            try
+            {   for(subset_id = 0; subset_id < n_subset; ++subset_id)
+                {   size_t k   = sample_index * n_subset + subset_id;
+                    avg_vec[k] = average(subset_id, pack_vec, avgint_obj);
+                }
+            }
+            catch(...)
+            {   // samples with a larger index will not be needed
+                error_sample[thread] = sample_index;
+                error_subset[thread] = subset_id;
+                error_ptr[thread]    = std::current_exception();
+                size_t previous      = first_error;
+                while( sample_index < previous &&
+                    ! first_error.compare_exchange_weak(previous, sample_index)
+                ) { }
+            }
+            avgint_obj.cohort_cache(false);
+            if( error_ptr[thread] )
+                return;
+            sample_index = next_sample++;
+        }
+    };
+    thread_team(n_thread, work);
+    //
+    // error with the smallest sample index
+    // (each sample with a smaller index was completed by some thread)
+    size_t first = n_thread;
+    for(size_t thread = 0; thread < n_thread; ++thread)
+    {   if( error_sample[thread] != n_none )
+        {   if( first == n_thread )
+                first = thread;
+            else if( error_sample[thread] < error_sample[first] )
+                first = thread;
+        }
+    }
+    if( first < n_thread )
+    {   error_id = error_subset[first];
+        std::rethrow_exception( error_ptr[first] );
+    }
+}
 
 // ------------------------------------------------------------------------
 # define DISMOD_AT_INSTANTIATE_DATA_MODEL_CTOR(SubsetStruct)       \
@@ -1145,6 +1691,11 @@ DISMOD_AT_INSTANTIATE_DATA_MODEL_CTOR(avgint_subset_struct)
         bool                          parent   ,            \
         const CppAD::vector<Float>&   pack_vec              \
     );                                                      \
+    template CppAD::vector< residual_struct<Float> >        \
+    data_model::like_child(                                 \
+        size_t                        child    ,            \
+        const CppAD::vector<Float>&   pack_vec              \
+    );                                                      \
 
 // instantiations
 DISMOD_AT_INSTANTIATE_DATA_MODEL( double )
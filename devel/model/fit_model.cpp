@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # include <cppad/mixed/exception.hpp>
 # include <dismod_at/a1_double.hpp>
@@ -14,6 +14,7 @@
 # include <dismod_at/get_var_limits.hpp>
 # include <dismod_at/ran_con_rcv.hpp>
 # include <dismod_at/get_str_map.hpp>
+# include <dismod_at/tape_cache.hpp>
 
 # define PRINT_SIZE_MAP 0
 
@@ -48,7 +49,9 @@ Syntax
 | |tab| *zero_sum_child_rate* ,
 | |tab| *zero_sum_mulcov_group* ,
 | |tab| *data_object* ,
-| |tab| *trace_init*
+| |tab| *trace_init* ,
+| |tab| *tape_by_child* ,
+| |tab| *tape_cache*
 | )
 
 fit_object
@@ -59,6 +62,10 @@ db
 **
 This argument is the database connection for
 :ref:`logging<log_message-name>` errors and warnings.
+It is the null pointer when the fit is run by a child process
+(see :ref:`process_team-name` ).
+In this case the messages are :ref:`saved<log_message@db@null>`
+and *tape_cache* is not used.
 
 simulate_index
 **************
@@ -156,6 +163,32 @@ This gives one an indication of progress for large problems where
 initialization takes a long time.
 This argument is optional and its default value is false.
 
+tape_by_child
+*************
+If this argument is true,
+the data and random effects prior for each child are recorded
+as a separate CppAD checkpoint function and the
+random likelihood passed to cppad_mixed is the sum of these functions;
+see :ref:`option_table@tape_by_child` .
+If there are random effects that do not correspond to a child,
+a warning is logged and the random likelihood is recorded as one function.
+This argument is optional and its default value is false.
+
+tape_cache
+**********
+If this argument and *tape_by_child* are true,
+the checkpoint functions for each child are read from the
+:ref:`tape_cache-name` table when they are there
+(instead of being recorded).
+Otherwise, after they are recorded, they are written to the table.
+The :ref:`tape_cache@cache_key` is computed using *simulate_index* ,
+the values of the variables at which the functions are recorded,
+the bounds for the random effects, and the scaling for the fixed effects.
+Hence the prior means in *prior_object* must be determined by the
+prior table, or the :ref:`prior_sim_table-name` when
+*simulate_index* is not negative.
+This argument is optional and its default value is false.
+
 Prototype
 *********
 {xrst_spell_off}
@@ -176,7 +209,9 @@ fit_model::fit_model(
     const CppAD::vector<bool>&            zero_sum_child_rate   ,
     const CppAD::vector<bool>&            zero_sum_mulcov_group ,
     data_model&                           data_object           ,
-    bool                                  trace_init            )
+    bool                                  trace_init            ,
+    bool                                  tape_by_child         ,
+    bool                                  tape_cache            )
 /* {xrst_code}
 {xrst_spell_on}
 
@@ -218,7 +253,9 @@ scale_var_     ( scale_var   )                      ,
 prior_table_   ( prior_table )                      ,
 prior_object_  ( prior_object )                     ,
 random_const_  ( random_const )                     ,
-data_object_   ( data_object )
+data_object_   ( data_object )                      ,
+tape_by_child_ ( tape_by_child )                    ,
+tape_cache_    ( tape_cache && db != DISMOD_AT_NULL_PTR )
 {   if( trace_init )
         std::cout << "Begin dismod_at: fit_model constructor\n";
     //
@@ -320,6 +357,17 @@ data_object_   ( data_object )
     CppAD::vector<double> cppad_mixed_random_vec =
         random_const_.remove( random_vec );
     //
+    // ran_like_child_, child_random_
+    if( tape_by_child_ )
+    {   if( trace_init )
+            std::cout << "Begin dismod_at: record_ran_like_child\n";
+        tape_by_child_ = record_ran_like_child(
+            fixed_vec, cppad_mixed_random_vec
+        );
+        if( trace_init )
+            std::cout << "End dismod_at: record_ran_like_child\n";
+    }
+    //
     cppad_mixed_info_ = initialize(fixed_vec, cppad_mixed_random_vec);
 # if PRINT_SIZE_MAP
     std::map<std::string, size_t>::iterator itr;
@@ -1241,6 +1289,197 @@ void fit_model::sample_posterior(
     return;
 }
 // ===========================================================================
+// private functions
+// ===========================================================================
+// record_ran_like_child
+bool fit_model::record_ran_like_child(
+    const CppAD::vector<double>& fixed_vec              ,
+    const CppAD::vector<double>& cppad_mixed_random_vec )
+{   assert( fixed_vec.size() == n_fixed_ );
+    assert( cppad_mixed_random_vec.size() == n_random_ - n_random_equal_ );
+    //
+    // n_child
+    size_t n_child = pack_object_.child_size();
+    //
+    // check for case where ran_likelihood returns the empty vector
+    if( n_random_ == n_random_equal_ || n_child == 0 )
+        return false;
+    //
+    // checkpoint functions cannot be created in parallel mode
+    if( CppAD::thread_alloc::in_parallel() )
+        return false;
+    //
+    // random_child
+    // child corresponding to each random effect (n_child for none)
+    CppAD::vector<size_t> random_child(n_random_);
+    for(size_t j = 0; j < n_random_; ++j)
+        random_child[j] = n_child;
+    for(size_t rate_id = 0; rate_id < number_rate_enum; ++rate_id)
+    {   for(size_t child = 0; child < n_child; ++child)
+        {   pack_info::subvec_info info =
+                pack_object_.node_rate_value_info(rate_id, child);
+            for(size_t k = 0; k < info.n_var; ++k)
+            {   // random effects come first in the packed vector
+                size_t var_id = info.offset + k;
+                assert( var_id < n_random_ );
+                random_child[var_id] = child;
+            }
+        }
+    }
+    for(size_t j = 0; j < n_random_; ++j)
+    {   if( random_child[j] == n_child )
+        {   std::string msg = "tape_by_child is true but there are ";
+            msg += "random effects that do not correspond to a child.\n";
+            msg += "Using one tape for the random likelihood.";
+            if( warn_on_stderr_ )
+                log_message(db_, &std::cerr, "warning", msg);
+            else
+                log_message(db_, DISMOD_AT_NULL_PTR, "warning", msg);
+            return false;
+        }
+    }
+    //
+    // child_random_
+    const CppAD::vector<size_t>& var2both = random_const_.var2both_index();
+    size_t n_cppad_mixed_random = n_random_ - n_random_equal_;
+    child_random_.resize(n_child);
+    for(size_t child = 0; child < n_child; ++child)
+        child_random_[child].resize(0);
+    for(size_t i = 0; i < n_cppad_mixed_random; ++i)
+        child_random_[ random_child[ var2both[i] ] ].push_back(i);
+    //
+    // cache_key, check_key, tape_json
+    std::string                cache_key, check_key;
+    CppAD::vector<std::string> tape_json;
+    if( tape_cache_ )
+    {   // values, other than the input tables, that the functions depend on
+        CppAD::vector<double> value;
+        for(size_t j = 0; j < n_fixed_; ++j)
+            value.push_back( fixed_vec[j] );
+        for(size_t i = 0; i < cppad_mixed_random_vec.size(); ++i)
+            value.push_back( cppad_mixed_random_vec[i] );
+        for(size_t j = 0; j < n_random_; ++j)
+        {   value.push_back( random_lower_[j] );
+            value.push_back( random_upper_[j] );
+        }
+        for(size_t j = 0; j < n_fixed_; ++j)
+        {   value.push_back( double( fixed_is_scaled_[j] ) );
+            value.push_back( fixed_scale_eta_[j] );
+        }
+        cache_key = tape_cache_key(db_, simulate_index_, value, check_key);
+        if( cache_key != "" )
+            read_tape_cache(db_, cache_key, check_key, tape_json);
+        if( tape_json.size() != n_child )
+            tape_json.clear();
+    }
+    bool use_cache   = tape_json.size() == n_child;
+    bool write_cache = tape_cache_ && cache_key != "" && ! use_cache;
+    if( write_cache )
+        tape_json.resize(n_child);
+    //
+    // ran_like_child_
+    ran_like_child_.clear();
+    size_t n_residual = 0;
+    for(size_t child = 0; child < n_child; ++child)
+    {   size_t n_ran_child = child_random_[child].size();
+        //
+        // fun
+        CppAD::ADFun<double> fun;
+        if( use_cache )
+        {   // functions are only cached when there are residuals
+            fun.from_json( tape_json[child] );
+            ++n_residual;
+        }
+        else
+        {   // ax: fixed effects followed by random effects for this child
+            a1_vector ax(n_fixed_ + n_ran_child);
+            for(size_t j = 0; j < n_fixed_; ++j)
+                ax[j] = fixed_vec[j];
+            const CppAD::vector<size_t>& ran_index = child_random_[child];
+            for(size_t k = 0; k < n_ran_child; ++k)
+                ax[n_fixed_ + k] = cppad_mixed_random_vec[ ran_index[k] ];
+            CppAD::Independent(ax);
+            //
+            // random_vec
+            // random effects for other children do not affect this child
+            a1_vector random_vec(n_random_);
+            for(size_t j = 0; j < n_random_; ++j)
+            {   random_vec[j] = 0.0;
+                if( random_lower_[j] == random_upper_[j] )
+                    random_vec[j] = random_lower_[j];
+            }
+            for(size_t k = 0; k < n_ran_child; ++k)
+                random_vec[ var2both[ ran_index[k] ] ] = ax[n_fixed_ + k];
+            //
+            // pack_vec
+            a1_vector pack_vec( pack_object_.size() );
+            a1_vector fixed_scaled(n_fixed_), fixed_tmp(n_fixed_);
+            for(size_t j = 0; j < n_fixed_; ++j)
+                fixed_scaled[j] = ax[j];
+            unscale_fixed_effect(fixed_scaled, fixed_tmp);
+            pack_fixed(pack_object_, pack_vec, fixed_tmp);
+            pack_random(pack_object_, pack_vec, random_vec);
+            //
+            // data and prior residuals for this child
+            CppAD::vector< residual_struct<a1_double> > data_ran, prior_ran;
+            data_ran   = data_object_.like_child(child, pack_vec);
+            prior_ran  = prior_object_.random(pack_vec);
+            //
+            // ay: negative log-density for this child
+            a1_vector ay(1);
+            ay[0] = 0.0;
+            for(size_t i = 0; i < data_ran.size(); ++i)
+            {   assert( ! nonsmooth_density( data_ran[i].density ) );
+                ay[0] += data_ran[i].logden_smooth;
+                ++n_residual;
+            }
+            for(size_t i = 0; i < prior_ran.size(); ++i)
+            {   // prior index is 3 * var_id + k and var_id is a random index
+                size_t var_id = prior_ran[i].index / 3;
+                assert( var_id < n_random_ );
+                if( random_child[var_id] == child )
+                {   assert( ! nonsmooth_density( prior_ran[i].density ) );
+                    ay[0] += prior_ran[i].logden_smooth;
+                    ++n_residual;
+                }
+            }
+            ay[0] = - ay[0];
+            //
+            // fun
+            fun.Dependent(ax, ay);
+            fun.optimize();
+            if( write_cache )
+                tape_json[child] = fun.to_json();
+        }
+        //
+        // ran_like_child_[child]
+        std::string name     = "ran_like_child_" + CppAD::to_string(child);
+        bool internal_bool    = false;
+        bool use_hes_sparsity = true;
+        bool use_base2ad      = true;
+        bool use_in_parallel  = false;
+        ran_like_child_.emplace_back( new CppAD::chkpoint_two<double>(
+            fun,
+            name,
+            internal_bool,
+            use_hes_sparsity,
+            use_base2ad,
+            use_in_parallel
+        ) );
+    }
+    //
+    // check for the case where ran_likelihood returns the empty vector
+    if( n_residual == 0 )
+    {   ran_like_child_.clear();
+        return false;
+    }
+    //
+    // db
+    if( write_cache )
+        write_tape_cache(db_, cache_key, check_key, tape_json);
+    return true;
+}
+// ===========================================================================
 // private virtual functions
 // ===========================================================================
 // ran_likelihood
@@ -1253,6 +1492,26 @@ fit_model::a1_vector fit_model::ran_likelihood(
     if( n_random_ == n_random_equal_ )
         return a1_vector(0);
     //
+    // case where there is a separate function for each child
+    if( tape_by_child_ )
+    {   a1_vector ran_den(1);
+        ran_den[0] = 0.0;
+        size_t n_child = ran_like_child_.size();
+        for(size_t child = 0; child < n_child; ++child)
+        {   size_t n_ran_child = child_random_[child].size();
+            a1_vector ax(n_fixed_ + n_ran_child), ay(1);
+            for(size_t j = 0; j < n_fixed_; ++j)
+                ax[j] = fixed_vec[j];
+            for(size_t k = 0; k < n_ran_child; ++k)
+            {   size_t i = child_random_[child][k];
+                ax[n_fixed_ + k] = cppad_mixed_random_vec[i];
+            }
+            (*ran_like_child_[child])(ax, ay);
+            ran_den[0] += ay[0];
+        }
+        return ran_den;
+    }
+    //
     // convert from cppad_mixed random effects to dismod_at random effects
     a1_vector random_vec = random_const_.restore( cppad_mixed_random_vec );
     //
@@ -1423,6 +1682,7 @@ void fit_model::fatal_error(const std::string& error_message)
         msg += CppAD::to_string(simulate_index_);
     }
     // prints on std::cerr, logs in database, generates an assert, then exits
+    // (throws an exception in a child process)
     error_exit(msg);
 }
 // warning
@@ -1,7 +1,7 @@
 // $Id:$
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // SPDX-FileContributor: 2025 Garland Culbreth
 // ----------------------------------------------------------------------------
 /*
@@ -63,6 +63,7 @@ For *i* = 0 , ..., *n_row* ``-1`` ,
 
 is the value placed in the *i*-th row and column with name
 *col_name* [ *j* .
+If *row_value* is present, *col_value* is not present.
 
 single quote
 ============
@@ -85,12 +86,63 @@ operations, *max_insert* rows at a time, until fewer rows than *max_insert*
 remain, at which point the remaining rows will be inserted. If *n_row*
 is less than *max_insert* all rows will be inserted at once.
 
+col_value
+*********
+If *col_value* is present, *row_value* and *max_insert* are not present.
+It has the same size and order as *col_name* and
+contains the values for the corresponding column.
+We use *n_row* for the number of rows in the table.
+For *j* = 0 , ..., *col_name.size* () ``-1`` ,
+only one of the following vectors is used:
+
+.. list-table::
+    :header-rows: 1
+
+    * - *col_type* [ *j* ]
+      - vector
+      - null value
+    * - ``integer``
+      - *col_value* [ *j* ] . ``int_value``
+      - ``DISMOD_AT_NULL_INT``
+    * - ``real``
+      - *col_value* [ *j* ] . ``real_value``
+      - nan
+    * - ``text``
+      - *col_value* [ *j* ] . ``text_value``
+      -
+
+This vector has size *n_row* and its *i*-th element is the
+value placed in the *i*-th row of the column.
+The values are bound to one prepared ``insert`` statement
+(instead of being converted to text and parsed by sqlite).
+All the rows are inserted using one sqlite savepoint
+(which is a transaction when a transaction is not already active).
+This is much faster than the *row_value* version of this routine
+for large tables.
+The text values may contain the single quote character.
+
 table_name_id
 *************
 A column with name *table_name* _ ``id`` and type
 ``integer primary key`` is included as the first column in the table.
 Its values start with zero (for the first row) and
 increment by one for each row.
+
+insert_table
+************
+The ``insert_table`` routine appends rows to a table that already exists
+(for example, one created by ``create_table`` with zero rows).
+Its *col_name* , *col_type* , and *col_value* arguments are
+the same as for the *col_value* version of ``create_table`` .
+
+first_id
+========
+is the value of *table_name* _ ``id`` for the first row inserted;
+i.e., the *i*-th row of *col_value* has primary key *first_id* + *i* .
+These primary key values must not already be in the table.
+This can be used to write a large table in chunks so that all its values
+are not in memory at the same time; e.g., see
+:ref:`predict_command@Memory` .
 {xrst_toc_hidden
     example/devel/table/create_table_xam.cpp
 }
@@ -102,9 +154,33 @@ The file :ref:`create_table_xam.cpp-name` is an example use of
 {xrst_end cpp_create_table}
 ---------------------------------------------------------------------------
 */
+# include <cmath>
 # include <dismod_at/create_table.hpp>
 # include <cppad/utility/to_string.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/error_exit.hpp>
+# include <dismod_at/null_int.hpp>
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    // create_table_cmd
+    // sql command that creates the table (without any rows)
+    std::string create_table_cmd(
+        const std::string&                  table_name     ,
+        const CppAD::vector<std::string>&   col_name       ,
+        const CppAD::vector<std::string>&   col_type       ,
+        const CppAD::vector<bool>&          col_unique     )
+    {   std::string cmd;
+        cmd  = "create table " + table_name;
+        cmd += " (" + table_name + "_id integer primary key";
+        for(size_t j = 0; j < col_name.size(); j++)
+        {   cmd += ", " + col_name[j] + " " + col_type[j];
+            if( col_unique[j] )
+                cmd += " unique";
+        }
+        cmd += ");";
+        return cmd;
+    }
+} // END_EMPTY_NAMESPACE
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 
@@ -131,14 +207,7 @@ void create_table(
     //
     // db
     // create the table
-    cmd  = "create table " + table_name;
-    cmd += " (" + table_name + "_id integer primary key";
-    for(size_t j = 0; j < n_col; j++)
-    {   cmd += ", " + col_name[j] + " " + col_type[j];
-        if( col_unique[j] )
-            cmd += " unique";
-    }
-    cmd += ");";
+    cmd = create_table_cmd(table_name, col_name, col_type, col_unique);
     dismod_at::exec_sql_cmd(db, cmd);
     //
     if( n_row == 0 )
@@ -182,4 +251,144 @@ void create_table(
     }
 }
 
+// ---------------------------------------------------------------------------
+void create_table(
+    sqlite3*                                    db          ,
+    const std::string&                          table_name  ,
+    const CppAD::vector<std::string>&           col_name    ,
+    const CppAD::vector<std::string>&           col_type    ,
+    const CppAD::vector<bool>&                  col_unique  ,
+    const CppAD::vector<column_value_struct>&   col_value   )
+{   //
+    // cmd
+    std::string cmd;
+    //
+    assert( col_unique.size() == col_name.size() );
+    //
+    // db
+    // create the table
+    cmd = create_table_cmd(table_name, col_name, col_type, col_unique);
+    dismod_at::exec_sql_cmd(db, cmd);
+    //
+    // db
+    // insert the rows
+    size_t first_id = 0;
+    insert_table(db, table_name, col_name, col_type, col_value, first_id);
+}
+// ---------------------------------------------------------------------------
+void insert_table(
+    sqlite3*                                    db          ,
+    const std::string&                          table_name  ,
+    const CppAD::vector<std::string>&           col_name    ,
+    const CppAD::vector<std::string>&           col_type    ,
+    const CppAD::vector<column_value_struct>&   col_value   ,
+    size_t                                      first_id    )
+{   //
+    // cmd
+    std::string cmd;
+    //
+    // n_col
+    size_t n_col = col_name.size();
+    assert( n_col > 0 );
+    assert( col_type.size() == n_col );
+    assert( col_value.size() == n_col );
+    //
+    // n_row
+    size_t n_row = 0;
+    if( col_type[0] == "integer" )
+        n_row = col_value[0].int_value.size();
+    else if( col_type[0] == "real" )
+        n_row = col_value[0].real_value.size();
+    else
+        n_row = col_value[0].text_value.size();
+# ifndef NDEBUG
+    for(size_t j = 0; j < n_col; ++j)
+    {   if( col_type[j] == "integer" )
+            assert( col_value[j].int_value.size() == n_row );
+        else if( col_type[j] == "real" )
+            assert( col_value[j].real_value.size() == n_row );
+        else
+        {   assert( col_type[j] == "text" );
+            assert( col_value[j].text_value.size() == n_row );
+        }
+    }
+# endif
+    //
+    if( n_row == 0 )
+        return;
+    //
+    // db
+    // all the rows are inserted during one savepoint
+    dismod_at::exec_sql_cmd(db, "savepoint insert_table");
+    //
+    // p_stmt
+    cmd  = "insert into " + table_name;
+    cmd += " (" + table_name + "_id";
+    for(size_t j = 0; j < n_col; j++)
+        cmd += ", " + col_name[j];
+    cmd += " ) values (?";
+    for(size_t j = 0; j < n_col; j++)
+        cmd += ", ?";
+    cmd += ")";
+    sqlite3_stmt* p_stmt;
+    int           n_byte = -1;
+    const char**  pz_tail = nullptr;
+    int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+    if( rc != SQLITE_OK )
+    {   std::string message = "insert_table: following command failed:\n";
+        message            += cmd;
+        error_exit(message);
+    }
+    //
+    // db
+    for(size_t i = 0; i < n_row; ++i)
+    {   // table_name_id
+        sqlite3_bind_int64(p_stmt, 1, sqlite3_int64(first_id + i) );
+        //
+        // other columns
+        for(size_t j = 0; j < n_col; ++j)
+        {   int index = int(j) + 2;
+            if( col_type[j] == "integer" )
+            {   int value = col_value[j].int_value[i];
+                if( value == DISMOD_AT_NULL_INT )
+                    sqlite3_bind_null(p_stmt, index);
+                else
+                    sqlite3_bind_int(p_stmt, index, value);
+            }
+            else if( col_type[j] == "real" )
+            {   double value = col_value[j].real_value[i];
+                if( std::isnan(value) )
+                    sqlite3_bind_null(p_stmt, index);
+                else
+                    sqlite3_bind_double(p_stmt, index, value);
+            }
+            else
+            {   const std::string& value = col_value[j].text_value[i];
+                n_byte = int( value.size() );
+                sqlite3_bind_text(
+                    p_stmt, index, value.c_str(), n_byte, SQLITE_STATIC
+                );
+            }
+        }
+        //
+        // execute the statement
+        rc = sqlite3_step(p_stmt);
+        if( rc != SQLITE_DONE )
+        {   std::string message = "insert_table: inserting row ";
+            message            += CppAD::to_string(first_id + i) + " in ";
+            message            += table_name + " failed: ";
+            message            += sqlite3_errmsg(db);
+            sqlite3_finalize(p_stmt);
+            error_exit(message);
+        }
+        sqlite3_reset(p_stmt);
+    }
+    //
+    // delete the statement
+    sqlite3_finalize(p_stmt);
+    //
+    // db
+    dismod_at::exec_sql_cmd(db, "release insert_table");
+}
+
 } // END_DISMOD_AT_NAMESPACE
@@ -0,0 +1,531 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin db_input_cache dev}
+
+Reading and Writing a Binary Snapshot of the Input Tables
+#########################################################
+
+Syntax
+******
+
+| *found* = ``read_db_input_cache`` ( *db* , *db_input* )
+| ``write_db_input_cache`` ( *db* , *db_input* )
+| *cache_key* = ``db_input_cache_key`` ( *db* )
+| *snapshot* = ``db_input2snapshot`` ( *db_input* )
+| *found* = ``snapshot2db_input`` ( *data* , *n_byte* , *db_input* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_READ_DB_INPUT_CACHE
+    // END_READ_DB_INPUT_CACHE
+}
+{xrst_literal
+    // BEGIN_WRITE_DB_INPUT_CACHE
+    // END_WRITE_DB_INPUT_CACHE
+}
+{xrst_literal
+    // BEGIN_DB_INPUT_CACHE_KEY
+    // END_DB_INPUT_CACHE_KEY
+}
+{xrst_literal
+    // BEGIN_DB_INPUT2SNAPSHOT
+    // END_DB_INPUT2SNAPSHOT
+}
+{xrst_literal
+    // BEGIN_SNAPSHOT2DB_INPUT
+    // END_SNAPSHOT2DB_INPUT
+}
+
+Purpose
+*******
+The :ref:`get_db_input-name` routine reads every column of every
+input table, converts it to the corresponding C++ structure,
+and checks it for errors.
+These routines store the result, as one binary blob,
+so that it can be read back without any conversion or checking.
+
+db
+**
+is an open connection to the database.
+
+db_input
+********
+The structure *db_input* is defined in :ref:`get_db_input@db_input` .
+
+read_db_input_cache
+===================
+All of the vectors in *db_input* must be empty on input.
+If *found* is true, upon return *db_input*
+is equal to the value of *db_input* in the call to ``write_db_input_cache``
+that created the snapshot.
+Otherwise, all of the vectors in *db_input* are empty
+(and :ref:`get_db_input-name` should be used).
+
+write_db_input_cache
+====================
+The value of *db_input* must be the result of
+``get_db_input`` ( *db* , *db_input* ) .
+It is written to the ``db_input_cache`` table
+and replaces any previous snapshot.
+
+cache_key
+*********
+The snapshot is stored with a hash code for the dismod_at version
+and the input tables; see :ref:`hash_table-name` .
+The snapshot is only used by ``read_db_input_cache``
+if this key is the same as when it was written; i.e.,
+none of the input tables have changed.
+Note that computing the key requires reading the input tables
+(but not converting or checking them).
+
+db_input_cache_key
+==================
+returns the key, as 16 hexadecimal digits,
+for the current values of the input tables in *db* .
+
+db_input2snapshot
+*****************
+returns the snapshot, that is stored in the ``db_input_cache`` table,
+corresponding to *db_input* .
+This can be used to transfer *db_input* between processes.
+
+snapshot2db_input
+*****************
+The *n_byte* bytes starting at *data* are a snapshot returned by
+``db_input2snapshot`` .
+All of the vectors in *db_input* must be empty on input.
+If *found* is true, upon return *db_input* is equal to the value of
+*db_input* in the call to ``db_input2snapshot`` .
+Otherwise, the snapshot does not have the expected format
+and all of the vectors in *db_input* are empty.
+
+Snapshot Format
+***************
+The snapshot begins with a format version number.
+Each vector of fixed size elements is stored as the size of its
+elements, its length, and a copy of its memory.
+Each string is stored as its length followed by its characters.
+The snapshot ends with the :ref:`hash_table@fnv_hash` of all the
+preceding bytes.
+If the version, an element size, or the check sum does not agree,
+the snapshot is not used.
+
+db_input_cache Table
+********************
+This table has the following columns:
+``db_input_cache_id`` (integer primary key),
+``cache_key`` (text), and
+``snapshot`` (a blob containing the snapshot).
+It has at most one row.
+
+Warnings
+********
+The warnings that ``get_db_input`` writes to the :ref:`log_table-name`
+are not written again when a snapshot is used.
+
+{xrst_toc_hidden
+    example/devel/table/db_input_cache_xam.cpp
+}
+Example
+*******
+The file :ref:`db_input_cache_xam.cpp-name` is an example use of
+these routines.
+
+{xrst_end db_input_cache}
+*/
+# include <cstring>
+# include <cstdint>
+# include <cassert>
+# include <type_traits>
+# include <dismod_at/db_input_cache.hpp>
+# include <dismod_at/hash_table.hpp>
+# include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/does_table_exist.hpp>
+# include <dismod_at/error_exit.hpp>
+# include <dismod_at/configure.hpp>
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    using CppAD::vector;
+    //
+    // format_version_
+    // change this whenever the snapshot format changes
+    const uint32_t format_version_ = 1;
+    //
+    // prepare
+    sqlite3_stmt* prepare(sqlite3* db, const std::string& cmd)
+    {   sqlite3_stmt* p_stmt;
+        int           n_byte  = -1;
+        const char**  pz_tail = DISMOD_AT_NULL_PTR;
+        int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+        if( rc != SQLITE_OK )
+        {   std::string message = "db_input_cache: following command failed:\n";
+            message            += cmd + "\n" + sqlite3_errmsg(db);
+            dismod_at::error_exit(message);
+        }
+        return p_stmt;
+    }
+    // ------------------------------------------------------------------------
+    // snapshot_writer
+    class snapshot_writer {
+    private:
+        std::string buffer_;
+    public:
+        const std::string& buffer(void) const
+        {   return buffer_; }
+        bool ok(void) const
+        {   return true; }
+        template <class Pod> void pod(const Pod& x)
+        {   static_assert( std::is_trivially_copyable<Pod>::value );
+            buffer_.append( reinterpret_cast<const char*>(&x), sizeof(Pod) );
+        }
+        void string(const std::string& x)
+        {   pod( uint64_t( x.size() ) );
+            buffer_.append(x);
+        }
+        template <class Pod> void pod_vec(const vector<Pod>& x)
+        {   static_assert( std::is_trivially_copyable<Pod>::value );
+            pod( uint32_t( sizeof(Pod) ) );
+            pod( uint64_t( x.size() ) );
+            const char* data = reinterpret_cast<const char*>( x.data() );
+            if( x.size() > 0 )
+                buffer_.append(data, x.size() * sizeof(Pod) );
+        }
+        template <class Struct> void resize(const vector<Struct>& x)
+        {   pod( uint64_t( x.size() ) ); }
+    };
+    // ------------------------------------------------------------------------
+    // snapshot_reader
+    // ok() is false if the snapshot does not have the expected format
+    class snapshot_reader {
+    private:
+        const char* data_;
+        size_t      size_;
+        size_t      pos_;
+        bool        ok_;
+    public:
+        snapshot_reader(const char* data, size_t size)
+        : data_(data), size_(size), pos_(0), ok_(true)
+        { }
+        bool ok(void) const
+        {   return ok_; }
+        bool done(void) const
+        {   return ok_ && pos_ == size_; }
+        template <class Pod> void pod(Pod& x)
+        {   if( ! ok_ || size_ - pos_ < sizeof(Pod) )
+            {   ok_ = false;
+                return;
+            }
+            std::memcpy(&x, data_ + pos_, sizeof(Pod) );
+            pos_ += sizeof(Pod);
+        }
+        void string(std::string& x)
+        {   uint64_t n = 0;
+            pod(n);
+            if( ! ok_ || size_ - pos_ < n )
+            {   ok_ = false;
+                return;
+            }
+            x.assign(data_ + pos_, size_t(n) );
+            pos_ += size_t(n);
+        }
+        template <class Pod> void pod_vec(vector<Pod>& x)
+        {   uint32_t n_byte = 0;
+            uint64_t n      = 0;
+            pod(n_byte);
+            pod(n);
+            ok_ &= n_byte == sizeof(Pod);
+            if( ! ok_ || (size_ - pos_) / sizeof(Pod) < n )
+            {   ok_ = false;
+                return;
+            }
+            x.resize( size_t(n) );
+            if( n > 0 ) std::memcpy(
+                x.data(), data_ + pos_, size_t(n) * sizeof(Pod)
+            );
+            pos_ += size_t(n) * sizeof(Pod);
+        }
+        template <class Struct> void resize(vector<Struct>& x)
+        {   uint64_t n = 0;
+            pod(n);
+            // each element requires at least one byte
+            if( ! ok_ || size_ - pos_ < n )
+            {   ok_ = false;
+                return;
+            }
+            x.resize( size_t(n) );
+        }
+    };
+    // ------------------------------------------------------------------------
+    // fields
+    // transfer the fields of the structures that contain strings
+    template <class Archive>
+    void fields(Archive& ar, std::string& x)
+    {   ar.string(x); }
+    //
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::option_struct& x)
+    {   ar.string(x.option_name);
+        ar.string(x.option_value);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::covariate_struct& x)
+    {   ar.string(x.covariate_name);
+        ar.pod(x.reference);
+        ar.pod(x.max_difference);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::node_struct& x)
+    {   ar.string(x.node_name);
+        ar.pod(x.parent);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::prior_struct& x)
+    {   ar.string(x.prior_name);
+        ar.pod(x.density_id);
+        ar.pod(x.lower);
+        ar.pod(x.upper);
+        ar.pod(x.mean);
+        ar.pod(x.std);
+        ar.pod(x.eta);
+        ar.pod(x.nu);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::smooth_struct& x)
+    {   ar.string(x.smooth_name);
+        ar.pod(x.n_age);
+        ar.pod(x.n_time);
+        ar.pod(x.mulstd_value_prior_id);
+        ar.pod(x.mulstd_dage_prior_id);
+        ar.pod(x.mulstd_dtime_prior_id);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::weight_struct& x)
+    {   ar.string(x.weight_name);
+        ar.pod(x.n_age);
+        ar.pod(x.n_time);
+    }
+    template <class Archive>
+    void fields(Archive& ar, dismod_at::subgroup_struct& x)
+    {   ar.string(x.subgroup_name);
+        ar.pod(x.group_id);
+        ar.string(x.group_name);
+    }
+    //
+    // struct_vec
+    template <class Archive, class Struct>
+    void struct_vec(Archive& ar, vector<Struct>& x)
+    {   ar.resize(x);
+        for(size_t i = 0; i < x.size(); ++i)
+        {   if( ! ar.ok() )
+                return;
+            fields(ar, x[i]);
+        }
+    }
+    //
+    // transfer
+    // The snapshot_writer does not change db_input.
+    template <class Archive>
+    void transfer(Archive& ar, dismod_at::db_input_struct& db_input)
+    {   ar.pod_vec(    db_input.age_table );
+        ar.pod_vec(    db_input.time_table );
+        struct_vec(ar, db_input.option_table );
+        ar.pod_vec(    db_input.avgint_table );
+        ar.pod_vec(    db_input.avgint_cov_value );
+        struct_vec(ar, db_input.covariate_table );
+        ar.pod_vec(    db_input.data_table );
+        ar.pod_vec(    db_input.data_cov_value );
+        ar.pod_vec(    db_input.density_table );
+        ar.pod_vec(    db_input.integrand_table );
+        ar.pod_vec(    db_input.mulcov_table );
+        struct_vec(ar, db_input.node_table );
+        ar.pod_vec(    db_input.rate_eff_cov_table );
+        struct_vec(ar, db_input.prior_table );
+        ar.pod_vec(    db_input.rate_table );
+        struct_vec(ar, db_input.smooth_table );
+        ar.pod_vec(    db_input.smooth_grid_table );
+        struct_vec(ar, db_input.weight_table );
+        ar.pod_vec(    db_input.weight_grid_table );
+        struct_vec(ar, db_input.nslist_table );
+        ar.pod_vec(    db_input.nslist_pair_table );
+        struct_vec(ar, db_input.subgroup_table );
+    }
+    //
+    // check_sum
+    uint64_t check_sum(const char* data, size_t n_byte)
+    {   dismod_at::fnv_hash hash;
+        hash.add(data, n_byte);
+        return hash.value();
+    }
+} // END_EMPTY_NAMESPACE
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_DB_INPUT_CACHE_KEY
+std::string db_input_cache_key(sqlite3* db)
+// END_DB_INPUT_CACHE_KEY
+{   // input tables read by get_db_input
+    // BEGIN_SORT_THIS_LINE_PLUS_2
+    const char* table_list[] = {
+        "age",
+        "avgint",
+        "covariate",
+        "data",
+        "density",
+        "integrand",
+        "mulcov",
+        "node",
+        "nslist",
+        "nslist_pair",
+        "option",
+        "prior",
+        "rate",
+        "rate_eff_cov",
+        "smooth",
+        "smooth_grid",
+        "subgroup",
+        "time",
+        "weight",
+        "weight_grid",
+    };
+    // END_SORT_THIS_LINE_MINUS_2
+    size_t n_table = sizeof( table_list ) / sizeof( table_list[0] );
+    //
+    fnv_hash hash;
+    std::string version = DISMOD_AT_VERSION;
+    hash.add( version.c_str(), version.size() + 1 );
+    for(size_t i = 0; i < n_table; ++i)
+    {   if( does_table_exist(db, table_list[i]) )
+            hash_table(db, table_list[i], hash);
+    }
+    return hash.hex();
+}
+
+// BEGIN_DB_INPUT2SNAPSHOT
+std::string db_input2snapshot(const db_input_struct& db_input)
+// END_DB_INPUT2SNAPSHOT
+{   snapshot_writer ar;
+    ar.pod(format_version_);
+    transfer(ar, const_cast<db_input_struct&>(db_input) );
+    std::string snapshot = ar.buffer();
+    uint64_t    sum      = check_sum( snapshot.data(), snapshot.size() );
+    snapshot.append( reinterpret_cast<const char*>(&sum), sizeof(sum) );
+    return snapshot;
+}
+
+// BEGIN_SNAPSHOT2DB_INPUT
+bool snapshot2db_input(
+    const char* data, size_t n_byte, db_input_struct& db_input
+)
+// END_SNAPSHOT2DB_INPUT
+{   assert( db_input.option_table.size() == 0 );
+    assert( db_input.data_table.size() == 0 );
+    //
+    // check the check sum at the end of the snapshot
+    bool ok = n_byte >= sizeof(uint64_t);
+    if( ok )
+    {   n_byte -= sizeof(uint64_t);
+        uint64_t stored;
+        std::memcpy(&stored, data + n_byte, sizeof(uint64_t) );
+        ok = stored == check_sum(data, n_byte);
+    }
+    //
+    // db_input
+    if( ok )
+    {   snapshot_reader ar(data, n_byte);
+        uint32_t version = 0;
+        ar.pod(version);
+        ok = ar.ok() && version == format_version_;
+        if( ok )
+        {   transfer(ar, db_input);
+            ok = ar.done();
+        }
+    }
+    if( ! ok )
+        db_input = db_input_struct();
+    return ok;
+}
+
+// BEGIN_READ_DB_INPUT_CACHE
+bool read_db_input_cache(sqlite3* db, db_input_struct& db_input)
+// END_READ_DB_INPUT_CACHE
+{   assert( db_input.option_table.size() == 0 );
+    assert( db_input.data_table.size() == 0 );
+    //
+    if( ! does_table_exist(db, "db_input_cache") )
+        return false;
+    //
+    std::string cmd = "select cache_key, snapshot from db_input_cache";
+    sqlite3_stmt* p_stmt = prepare(db, cmd);
+    if( sqlite3_step(p_stmt) != SQLITE_ROW )
+    {   sqlite3_finalize(p_stmt);
+        return false;
+    }
+    //
+    // check cache_key
+    const char* key = reinterpret_cast<const char*>(
+        sqlite3_column_text(p_stmt, 0)
+    );
+    if( key == DISMOD_AT_NULL_PTR || db_input_cache_key(db) != key )
+    {   sqlite3_finalize(p_stmt);
+        return false;
+    }
+    //
+    // data, n_byte
+    // The blob is used directly from sqlite's memory (not copied).
+    const char* data = reinterpret_cast<const char*>(
+        sqlite3_column_blob(p_stmt, 1)
+    );
+    size_t n_byte = size_t( sqlite3_column_bytes(p_stmt, 1) );
+    //
+    // db_input
+    bool ok = data != DISMOD_AT_NULL_PTR;
+    if( ok )
+        ok = snapshot2db_input(data, n_byte, db_input);
+    sqlite3_finalize(p_stmt);
+    return ok;
+}
+
+// BEGIN_WRITE_DB_INPUT_CACHE
+void write_db_input_cache(sqlite3* db, const db_input_struct& db_input)
+// END_WRITE_DB_INPUT_CACHE
+{   //
+    // snapshot
+    std::string snapshot = db_input2snapshot(db_input);
+    //
+    // cache_key
+    std::string cache_key = db_input_cache_key(db);
+    //
+    std::string cmd = "create table if not exists db_input_cache("
+        " db_input_cache_id integer primary key,"
+        " cache_key         text,"
+        " snapshot          blob"
+        ");";
+    exec_sql_cmd(db, cmd);
+    //
+    exec_sql_cmd(db, "savepoint db_input_cache");
+    exec_sql_cmd(db, "delete from db_input_cache");
+    cmd  = "insert into db_input_cache";
+    cmd += " (db_input_cache_id, cache_key, snapshot) values (0, ?, ?)";
+    sqlite3_stmt* p_stmt = prepare(db, cmd);
+    sqlite3_bind_text(
+        p_stmt, 1, cache_key.c_str(), int( cache_key.size() ), SQLITE_STATIC
+    );
+    sqlite3_bind_blob64(
+        p_stmt, 2, snapshot.data(), sqlite3_uint64( snapshot.size() ),
+        SQLITE_STATIC
+    );
+    if( sqlite3_step(p_stmt) != SQLITE_DONE )
+    {   std::string message = "write_db_input_cache: insert failed: ";
+        message            += sqlite3_errmsg(db);
+        sqlite3_finalize(p_stmt);
+        error_exit(message, "db_input_cache");
+    }
+    sqlite3_finalize(p_stmt);
+    exec_sql_cmd(db, "release db_input_cache");
+}
+
+} // END_DISMOD_AT_NAMESPACE
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin get_option_table dev}
@@ -78,6 +78,7 @@ this function.
 
 
 
+# include <cctype>
 # include <cppad/utility/to_string.hpp>
 # include <dismod_at/get_rate_table.hpp>
 # include <dismod_at/get_option_table.hpp>
@@ -137,6 +138,8 @@ CppAD::vector<option_struct> get_option_table(sqlite3* db)
         { "bound_random",                     ""                   },
         { "compress_interval",                "0 0"                },
         { "data_extra_columns",               ""                   },
+        { "db_input_cache",                   "false"              },
+        { "db_profile",                       "default"            },
         { "derivative_test_fixed",            "none"               },
         { "derivative_test_random",           "none"               },
         { "hold_out_integrand",               ""                   },
@@ -150,12 +153,16 @@ CppAD::vector<option_struct> get_option_table(sqlite3* db)
         { "other_input_table",                ""                   },
         { "parent_node_id",                   ""                   },
         { "parent_node_name",                 ""                   },
+        { "predict_quantile",                 "0.025 0.5 0.975"    },
         { "print_level_fixed",                "0"                  },
         { "print_level_random",               "0"                  },
         { "quasi_fixed",                      "true"               },
         { "random_seed",                      "0"                  },
         { "rate_case",                        "iota_pos_rho_zero"  },
         { "splitting_covariate",              ""                   },
+        { "tape_by_child",                    "false"              },
+        { "tape_cache",                       "false"              },
+        { "thread_count",                     "1"                  },
         { "tolerance_fixed",                  "1e-8"               },
         { "tolerance_random",                 "1e-8"               },
         { "trace_init_fit_model",             "false"              },
@@ -312,6 +319,67 @@ CppAD::vector<option_struct> get_option_table(sqlite3* db)
                 error_exit(msg, table_name, option_id);
             }
         }
+        // db_input_cache
+        if( name_vec[match] == "db_input_cache" )
+        {   if(
+                option_value[option_id] != "true" &&
+                option_value[option_id] != "false" )
+            {   msg = "db_input_cache is not true or false";
+                error_exit(msg, table_name, option_id);
+            }
+        }
+        // db_profile
+        if( name_vec[match] == "db_profile" )
+        {   if(
+                option_value[option_id] != "default" &&
+                option_value[option_id] != "bulk" )
+            {   msg = "db_profile is not default or bulk";
+                error_exit(msg, table_name, option_id);
+            }
+        }
+        // tape_by_child
+        if( name_vec[match] == "tape_by_child" )
+        {   if(
+                option_value[option_id] != "true" &&
+                option_value[option_id] != "false" )
+            {   msg = "tape_by_child is not true or false";
+                error_exit(msg, table_name, option_id);
+            }
+        }
+        // tape_cache
+        if( name_vec[match] == "tape_cache" )
+        {   if(
+                option_value[option_id] != "true" &&
+                option_value[option_id] != "false" )
+            {   msg = "tape_cache is not true or false";
+                error_exit(msg, table_name, option_id);
+            }
+        }
+        // predict_quantile
+        if( name_vec[match] == "predict_quantile" )
+        {   const CppAD::vector<string>& level = option_value_split;
+            for(size_t i = 0; i < level.size(); ++i)
+            {   bool ok = level[i].size() > 2;
+                ok     &= level[i].substr(0, 2) == "0.";
+                bool nonzero = false;
+                for(size_t j = 2; j < level[i].size(); ++j)
+                {   ok      &= std::isdigit( level[i][j] ) != 0;
+                    nonzero |= level[i][j] != '0';
+                }
+                if( ! (ok && nonzero) )
+                {   msg  = "predict_quantile: the level '" + level[i];
+                    msg += "' does not have the form 0.digits";
+                    error_exit(msg, table_name, option_id);
+                }
+                for(size_t j = 0; j < i; ++j)
+                {   if( level[j] == level[i] )
+                    {   msg  = "predict_quantile: the level " + level[i];
+                        msg += " appears more than once";
+                        error_exit(msg, table_name, option_id);
+                    }
+                }
+            }
+        }
         // trace_init_fit_model
         if( name_vec[match] == "trace_init_fit_model" )
         {   if(
@@ -375,10 +443,12 @@ CppAD::vector<option_struct> get_option_table(sqlite3* db)
         // accept_after_max_steps_fixed
         // accept_after_max_steps_random
         // limited_memory_max_history_fixed
+        // thread_count
         if(
             name_vec[match] == "accept_after_max_steps_fixed"   ||
             name_vec[match] == "accept_after_max_steps_random"  ||
-            name_vec[match] == "limited_memory_max_history_fixed"
+            name_vec[match] == "limited_memory_max_history_fixed" ||
+            name_vec[match] == "thread_count"
         )
         {   int pos_integer = std::atoi( option_value[option_id].c_str() );
             bool ok = 0 < pos_integer;
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin get_table_column dev}
@@ -13,6 +13,9 @@ Syntax
 
 | *column_type* = ``get_table_column_type`` ( *db* , *table_name* , *column_name* )
 | ``get_table_column`` ( *db* , *table_name* , *column_name* , *result* )
+| ``get_table_column`` (
+| |tab| *db* , *table_name* , *column_name* , *first_id* , *end_id* , *result*
+| )
 
 db
 **
@@ -55,6 +58,10 @@ The input size of this vector must be zero.
 Upon return it contains the values in the specified column.
 The results are ordered using the :ref:`database@Primary Key`
 for this table.
+The size of *result* is determined using ``count(*)`` before
+any values are read.
+The values are read directly as integers, reals, or text
+using a prepared statement; i.e., they are not converted to text first.
 
 text
 ====
@@ -93,6 +100,23 @@ prototype
 If a real value is ``null`` , it is returned as the ``double``
 value ``nan`` .
 Note that it is not possible for a database value to be ``nan`` .
+
+first_id, end_id
+****************
+If these arguments are present,
+they have prototype
+
+| |tab| ``size_t`` *first_id*
+| |tab| ``size_t`` *end_id*
+
+and only the rows with primary key value *id* that satisfy
+*first_id* <= *id* < *end_id* are returned.
+In this case the type of *result* must be ``integer`` or ``real`` ,
+the size of *result* is *end_id* ``-`` *first_id* ,
+and it is an error if any of these rows are not in the table.
+This is used to read a large table in chunks, so that the memory used
+is bounded by the chunk size; e.g., see
+:ref:`predict_command@Memory` .
 {xrst_toc_hidden
     example/devel/table/get_table_column_xam.cpp
 }
@@ -117,28 +141,30 @@ this function.
 namespace {
     using std::string;
 
-    // Type specified by sqlite3_exec
-    typedef int (*callback_type)(void*, int, char**, char**);
-
     // set by get_column, used by convert
     string   table_name_;
     string   column_name_;
 
-    const char* convert(const std::string& not_used, char* v, size_t row_id)
-    {   if( v == DISMOD_AT_NULL_PTR )
+    // The convert functions return the value in the first column of the
+    // current row for p_stmt. The row_id is only used for error messages.
+    string convert(const string& not_used, sqlite3_stmt* p_stmt, size_t row_id)
+    {   if( sqlite3_column_type(p_stmt, 0) == SQLITE_NULL )
             return "";
-        if( *v == '\0' )
+        const char* v =
+            reinterpret_cast<const char*>( sqlite3_column_text(p_stmt, 0) );
+        int n_byte = sqlite3_column_bytes(p_stmt, 0);
+        if( n_byte == 0 )
         {   string msg = "The empty string appears in the text column ";
             msg += column_name_;
             dismod_at::error_exit(msg, table_name_, row_id);
         }
-        return v;
+        return string(v, size_t(n_byte) );
     }
-    int    convert(const int& not_used, char* v, size_t row_id)
-    {   if(  v == DISMOD_AT_NULL_PTR )
+    int    convert(const int& not_used, sqlite3_stmt* p_stmt, size_t row_id)
+    {   if( sqlite3_column_type(p_stmt, 0) == SQLITE_NULL )
             return DISMOD_AT_NULL_INT;
         //
-        int value = std::atoi(v);
+        int value = sqlite3_column_int(p_stmt, 0);
         //
         // no integer values should be the minimum integer
         if( value == DISMOD_AT_NULL_INT )
@@ -149,10 +175,10 @@ namespace {
         //
         return value;
     }
-    double convert(const double& not_used, char* v, size_t row_id)
-    {   if( v == DISMOD_AT_NULL_PTR )
+    double convert(const double& not_used, sqlite3_stmt* p_stmt, size_t row_id)
+    {   if( sqlite3_column_type(p_stmt, 0) == SQLITE_NULL )
             return std::numeric_limits<double>::quiet_NaN();
-        double value = std::atof(v);
+        double value = sqlite3_column_double(p_stmt, 0);
         if( value != value )
         {   string msg = "The value nan appears in the double column ";
             msg += column_name_;
@@ -161,24 +187,53 @@ namespace {
         return value;
     }
 
-    template <class Element>
-    int callback(void *result, int argc, char **argv, char **azColName)
-    {   typedef CppAD::vector<Element> vector;
-        assert( argc == 1 );
-        assert( result != DISMOD_AT_NULL_PTR );
-        vector* vector_result = static_cast<vector*>(result);
-        size_t row_id = vector_result->size();
-        vector_result->push_back( convert(Element(), argv[0], row_id ) );
-        return 0;
+    // prepare_statement
+    sqlite3_stmt* prepare_statement(sqlite3* db, const string& cmd)
+    {   sqlite3_stmt* p_stmt;
+        int           n_byte  = -1;
+        const char**  pz_tail = nullptr;
+        int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+        if( rc != SQLITE_OK )
+        {   std::string message = "SQL error: ";
+            message += sqlite3_errmsg(db);
+            message += ". SQL command: " + cmd;
+            dismod_at::error_exit(message);
+        }
+        return p_stmt;
     }
-    template int callback<std::string>(void*, int, char**, char**);
 
+    // check_column_type
+    void check_column_type(
+        sqlite3*                    db                    ,
+        const std::string&          table_name            ,
+        const std::string&          column_name           ,
+        const std::string&          expected_type         )
+    {   std::string col_type =
+            dismod_at::get_table_column_type(db, table_name, column_name);
+        if( col_type != expected_type )
+        {   size_t null_id  = DISMOD_AT_NULL_SIZE_T;
+            std::string msg = "get_table_column for column = " + column_name;
+            msg += " in table " + table_name + ".\n";
+            if( col_type == "" )
+                msg += "Could not find table or column in table.";
+            else
+            {   msg += "Expected type to be " + expected_type;
+                msg += " not " + col_type;
+            }
+            dismod_at::error_exit(msg, table_name, null_id);
+        }
+    }
+
+    // If end_id is DISMOD_AT_NULL_SIZE_T, get the entire column.
+    // Otherwise get the rows with first_id <= primary key < end_id.
     template <class Element>
     void get_column(
         sqlite3*                    db                    ,
         const std::string&          table_name            ,
         const std::string&          column_name           ,
-        CppAD::vector<Element>&     vector_result         )
+        CppAD::vector<Element>&     vector_result         ,
+        size_t                      first_id = 0          ,
+        size_t                      end_id   = DISMOD_AT_NULL_SIZE_T )
     {
         // check that initial vector is empty
         assert( vector_result.size() == 0 );
@@ -186,27 +241,58 @@ namespace {
         // name of the primary key for this table
         std::string primary_key = table_name + "_id";
 
+        // n_row
+        std::string   cmd;
+        sqlite3_stmt* p_stmt;
+        int           rc;
+        size_t        n_row;
+        if( end_id == DISMOD_AT_NULL_SIZE_T )
+        {   // number of rows in the table
+            cmd    = "select count(*) from " + table_name;
+            p_stmt = prepare_statement(db, cmd);
+            rc     = sqlite3_step(p_stmt);
+            assert( rc == SQLITE_ROW );
+            n_row  = size_t( sqlite3_column_int64(p_stmt, 0) );
+            sqlite3_finalize(p_stmt);
+        }
+        else
+        {   assert( first_id <= end_id );
+            n_row = end_id - first_id;
+        }
+
         // sql command: select column_name from table_name
-        std::string cmd = "select ";
-        cmd            += column_name;
-        cmd            += " from ";
-        cmd            += table_name;
-        cmd            += " order by ";
-        cmd            += primary_key;
-
-        // execute sql command
-        char* zErrMsg     = DISMOD_AT_NULL_PTR;
-        callback_type fun = callback<Element>;
-        void* result      = static_cast<void*>(&vector_result);
-        int rc = sqlite3_exec(db, cmd.c_str(), fun, result, &zErrMsg);
-        if( rc )
-        {   assert(zErrMsg != DISMOD_AT_NULL_PTR );
-            std::string message = "SQL error: ";
+        cmd  = "select ";
+        cmd += column_name;
+        cmd += " from ";
+        cmd += table_name;
+        if( end_id != DISMOD_AT_NULL_SIZE_T )
+        {   cmd += " where " + primary_key + " >= ";
+            cmd += std::to_string(first_id);
+            cmd += " and " + primary_key + " < ";
+            cmd += std::to_string(end_id);
+        }
+        cmd += " order by ";
+        cmd += primary_key;
+
+        // vector_result
+        vector_result.resize(n_row);
+        p_stmt     = prepare_statement(db, cmd);
+        rc         = sqlite3_step(p_stmt);
+        size_t row_id = 0;
+        while( rc == SQLITE_ROW && row_id < n_row )
+        {   vector_result[row_id] =
+                convert(Element(), p_stmt, first_id + row_id);
+            ++row_id;
+            rc = sqlite3_step(p_stmt);
+        }
+        if( rc != SQLITE_DONE || row_id != n_row )
+        {   std::string message = "SQL error: ";
             message += sqlite3_errmsg(db);
             message += ". SQL command: " + cmd;
-            sqlite3_free(zErrMsg);
+            sqlite3_finalize(p_stmt);
             dismod_at::error_exit(message);
         }
+        sqlite3_finalize(p_stmt);
         return;
     }
 }
@@ -361,4 +447,36 @@ void get_table_column(
     return;
 }
 
+void get_table_column(
+    sqlite3*                    db                 ,
+    const std::string&          table_name         ,
+    const std::string&          column_name        ,
+    size_t                      first_id           ,
+    size_t                      end_id             ,
+    CppAD::vector<int>&         int_result         )
+{   // set globals used by error messages
+    table_name_ = table_name;
+    column_name_ = column_name;
+    //
+    check_column_type(db, table_name, column_name, "integer");
+    get_column(db, table_name, column_name, int_result, first_id, end_id);
+    return;
+}
+
+void get_table_column(
+    sqlite3*                    db                 ,
+    const std::string&          table_name         ,
+    const std::string&          column_name        ,
+    size_t                      first_id           ,
+    size_t                      end_id             ,
+    CppAD::vector<double>&      double_result      )
+{   // set globals used by error messages
+    table_name_ = table_name;
+    column_name_ = column_name;
+    //
+    check_column_type(db, table_name, column_name, "real");
+    get_column(db, table_name, column_name, double_result, first_id, end_id);
+    return;
+}
+
 } // END DISMOD_AT_NAMESPACE
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin hash_table dev}
+{xrst_spell
+  fnv
+}
+
+Hash Code for the Contents of a Table
+#####################################
+
+Syntax
+******
+| ``fnv_hash`` *hash*
+| *hash* . ``add`` ( *data* , *n_byte* )
+| *code* = *hash* . ``value`` ()
+| *hex* = *hash* . ``hex`` ()
+| *check* = *hash* . ``check`` ()
+| ``hash_table`` ( *db* , *table_name* , *hash* )
+| ``hash_table`` ( *db* , *table_name* , *hash* , *where* )
+
+fnv_hash
+********
+This class computes the 64 bit FNV-1a hash of a sequence of bytes:
+{xrst_literal
+    include/dismod_at/hash_table.hpp
+    // BEGIN_FNV_HASH
+    // END_FNV_HASH
+}
+
+add
+===
+Adds the *n_byte* bytes starting at *data* to the sequence.
+
+value
+=====
+is the hash code for the current sequence.
+
+hex
+===
+is the hash code for the current sequence as 16 hexadecimal digits.
+
+check
+=====
+is a second hash code for the current sequence, followed by the number
+of bytes in the sequence, as 32 hexadecimal digits.
+The second hash code uses a different multiplier and a right shift
+after each byte, so it is not a function of the FNV-1a hash code.
+It can be used to check that two sequences with the same *hex*
+are the same.
+
+hash_table
+**********
+Adds the table name, and the type and binary value of every entry
+in the table, to *hash* .
+The rows are added in order of the primary key *table_name* _ ``id`` .
+
+Prototype
+=========
+{xrst_literal
+    // BEGIN_HASH_TABLE
+    // END_HASH_TABLE
+}
+
+db
+==
+is an open connection to the database.
+
+table_name
+==========
+is the name of the table; it must exist in the database.
+
+where
+=====
+If this argument is present,
+only the rows that satisfy this SQL ``where`` clause are added to *hash* ;
+e.g., ``where simulate_index = 0`` .
+
+Example
+*******
+The routine :ref:`tape_cache-name` uses this routine.
+
+{xrst_end hash_table}
+*/
+# include <dismod_at/hash_table.hpp>
+# include <dismod_at/error_exit.hpp>
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_HASH_TABLE
+void hash_table(
+    sqlite3*           db         ,
+    const std::string& table_name ,
+    fnv_hash&          hash       ,
+    const std::string& where      )
+// END_HASH_TABLE
+{   hash.add( table_name.c_str(), table_name.size() + 1 );
+    if( where != "" )
+        hash.add( where.c_str(), where.size() + 1 );
+    std::string cmd = "select * from " + table_name + " " + where;
+    cmd            += " order by " + table_name + "_id";
+    //
+    // p_stmt
+    sqlite3_stmt* p_stmt;
+    int           n_byte  = -1;
+    const char**  pz_tail = nullptr;
+    int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+    if( rc != SQLITE_OK )
+    {   std::string message = "hash_table: following command failed:\n";
+        message            += cmd + "\n" + sqlite3_errmsg(db);
+        error_exit(message);
+    }
+    //
+    int n_col = sqlite3_column_count(p_stmt);
+    while( sqlite3_step(p_stmt) == SQLITE_ROW )
+    {   for(int j = 0; j < n_col; ++j)
+        {   int type = sqlite3_column_type(p_stmt, j);
+            hash.add( &type, sizeof(type) );
+            if( type == SQLITE_INTEGER )
+            {   sqlite3_int64 v = sqlite3_column_int64(p_stmt, j);
+                hash.add( &v, sizeof(v) );
+            }
+            else if( type == SQLITE_FLOAT )
+            {   double v = sqlite3_column_double(p_stmt, j);
+                hash.add( &v, sizeof(v) );
+            }
+            else if( type != SQLITE_NULL )
+            {   const void* v = sqlite3_column_blob(p_stmt, j);
+                n_byte        = sqlite3_column_bytes(p_stmt, j);
+                hash.add( &n_byte, sizeof(n_byte) );
+                hash.add( v, size_t(n_byte) );
+            }
+        }
+    }
+    sqlite3_finalize(p_stmt);
+}
+
+void hash_table(sqlite3* db, const std::string& table_name, fnv_hash& hash)
+{   std::string where = "";
+    hash_table(db, table_name, hash, where);
+}
+} // END_DISMOD_AT_NAMESPACE
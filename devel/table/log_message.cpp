@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin log_message dev}
@@ -19,6 +19,8 @@ Syntax
 | *unix_time* = ``log_message`` (
 | |tab| *db* , *os* , *message_type* , *message* , *table_name* , *row_id*
 | )
+| ``log_message_finalize`` ( *db* )
+| *saved* = ``log_message_saved`` ()
 
 db
 **
@@ -28,6 +30,14 @@ This argument has prototype
 
 and is the database connection.
 
+null
+====
+If *db* is the null pointer, the message is not written to a database.
+It is saved (in the order of the calls) until the next call to
+``log_message_saved`` .
+This is used by processes that cannot use the database connection;
+see :ref:`process_team-name` .
+
 os
 **
 This argument has prototype
@@ -104,6 +114,54 @@ The return value has prototype
 It is the value written in the log table for
 :ref:`log_table@unix_time` .
 
+Prepared Statement
+******************
+The first time ``log_message`` is called for a database connection,
+the log table is created (if it does not exist) and
+an ``insert`` statement for the log table is prepared.
+This statement is used (with the values bound to it)
+for the following calls with the same connection.
+The :ref:`log_table@log_id` for the new row is one plus the maximum
+*log_id* in the table (zero if the table is empty).
+Because *log_id* is the primary key,
+sqlite finds this maximum without a scan of the table.
+Hence the time to add a message does not depend on the size of the log table.
+If a transaction is active, it is committed after the message is inserted
+and a new transaction is begun.
+Hence the message, and the changes made before it,
+are visible to other connections right away and
+the write lock on the database is released.
+
+log_message_finalize
+====================
+This routine finalizes the prepared statement for the connection *db*
+(if there is one).
+It must be called before *db* is closed
+(otherwise ``sqlite3_close`` fails with ``SQLITE_BUSY`` ).
+If ``log_message`` is called with a different connection,
+the statement for the previous connection is finalized automatically.
+
+log_message_saved
+*****************
+The return value has prototype
+
+    ``CppAD::vector<log_message_struct>`` *saved*
+
+where ``log_message_struct`` has the following fields:
+
+.. csv-table::
+    :widths: auto
+
+    Type,Field
+    ``std::string``,message_type
+    ``std::string``,table_name
+    ``size_t``,row_id
+    ``std::string``,message
+
+It contains the messages that were saved because *db* was null
+(in the order they were saved).
+The saved messages are cleared by this call.
+
 Example
 *******
 Check the ``log`` table in the database after any
@@ -115,12 +173,73 @@ Check the ``log`` table in the database after any
 # include <cstdlib>
 # include <ctime>
 # include <cassert>
+# include <mutex>
+# include <iostream>
 # include <dismod_at/log_message.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
-# include <dismod_at/get_column_max.hpp>
-# include <cppad/utility/to_string.hpp>
 # include <dismod_at/null_int.hpp>
 # include <dismod_at/configure.hpp>
+# include <dismod_at/error_exit.hpp>
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    // log_db_
+    // connection that log_stmt_ was prepared for
+    sqlite3*      log_db_   = DISMOD_AT_NULL_PTR;
+    //
+    // log_stmt_
+    // statement that inserts one row in the log table
+    sqlite3_stmt* log_stmt_ = DISMOD_AT_NULL_PTR;
+    //
+    // log_mutex_
+    // only one thread at a time can use log_db_, log_stmt_, and log_saved_
+    std::recursive_mutex log_mutex_;
+    //
+    // log_saved_
+    // messages for a null database connection
+    CppAD::vector<dismod_at::log_message_struct> log_saved_;
+    //
+    // finalize_log_stmt
+    void finalize_log_stmt(void)
+    {   if( log_stmt_ != DISMOD_AT_NULL_PTR )
+            sqlite3_finalize(log_stmt_);
+        log_db_   = DISMOD_AT_NULL_PTR;
+        log_stmt_ = DISMOD_AT_NULL_PTR;
+    }
+    //
+    // prepare_log_stmt
+    // create the log table (if necessary) and prepare log_stmt_ for db
+    void prepare_log_stmt(sqlite3* db)
+    {   finalize_log_stmt();
+        //
+        std::string sql_cmd = "create table if not exists log("
+            " log_id              integer primary key,"
+            " message_type        text,"
+            " table_name          text,"
+            " row_id              integer,"
+            " unix_time           integer,"
+            " message             text"
+            ");";
+        dismod_at::exec_sql_cmd(db, sql_cmd);
+        //
+        sql_cmd  = "insert into log";
+        sql_cmd += " (log_id, message_type, table_name, row_id,";
+        sql_cmd += " unix_time, message) values (";
+        sql_cmd += " (select ifnull(max(log_id) + 1, 0) from log),";
+        sql_cmd += " ?, ?, ?, ?, ?)";
+        int          n_byte  = -1;
+        const char** pz_tail = DISMOD_AT_NULL_PTR;
+        int rc = sqlite3_prepare_v2(
+            db, sql_cmd.c_str(), n_byte, &log_stmt_, pz_tail
+        );
+        if( rc != SQLITE_OK )
+        {   std::string message = "log_message: following command failed:\n";
+            message            += sql_cmd;
+            log_stmt_           = DISMOD_AT_NULL_PTR;
+            dismod_at::error_exit(message);
+        }
+        log_db_ = db;
+    }
+} // END_EMPTY_NAMESPACE
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 
@@ -132,8 +251,11 @@ std::time_t log_message(
     const std::string& table_name   ,
     const size_t&      row_id       )
 {   static bool recursive = false;
+    //
+    // only one thread at a time can write to the log table
+    std::lock_guard<std::recursive_mutex> lock(log_mutex_);
+    //
     using std::string;
-    using CppAD::to_string;
 
     // check assumption one table_name and row_id columns of log
     assert( table_name != "" || row_id == DISMOD_AT_NULL_SIZE_T );
@@ -161,60 +283,75 @@ std::time_t log_message(
         }
     }
     //
-    if( ! recursive )
+    if( db == DISMOD_AT_NULL_PTR )
+    {   dismod_at::log_message_struct saved;
+        saved.message_type = message_type;
+        saved.table_name   = table_name;
+        saved.row_id       = row_id;
+        saved.message      = message;
+        log_saved_.push_back(saved);
+    }
+    else if( ! recursive )
     {   recursive = true;
         //
-        string sql_cmd = "create table if not exists log("
-            " log_id              integer primary key,"
-            " message_type        text,"
-            " table_name          text,"
-            " row_id              integer,"
-            " unix_time           integer,"
-            " message             text"
-            ");";
-        dismod_at::exec_sql_cmd(db, sql_cmd);
-
-        // message with single quotes escaped
-        string escaped_message = "";
-        for(size_t i = 0; i < message.size(); i++)
-        {   if( message[i] == '\'' )
-                escaped_message += "''";
-            else
-                escaped_message += message[i];
-        }
-
-        // determine next primary key value
-        string select_cmd  = "select * from log";
-        string column_name = "log_id";
-        string max_str     = get_column_max(db, select_cmd, column_name);
-        size_t log_id      = 0;
-        if( max_str != "" )
-            log_id = std::atoi( max_str.c_str() ) + 1;
-
-        // add this message to the log file
-        sql_cmd  = "insert into log values ( ";
-        sql_cmd += to_string( log_id );
-        sql_cmd += " , '";
-        sql_cmd += message_type;
-        if( table_name  == "" )
-            sql_cmd += "' , null,";
+        // log_stmt_
+        if( db != log_db_ )
+            prepare_log_stmt(db);
+        //
+        // bind the values for this message
+        const char* text  = message_type.c_str();
+        int        n_byte = int( message_type.size() );
+        sqlite3_bind_text(log_stmt_, 1, text, n_byte, SQLITE_STATIC);
+        if( table_name == "" )
+            sqlite3_bind_null(log_stmt_, 2);
         else
-            sql_cmd += "' , '" + table_name + "', ";
+        {   text   = table_name.c_str();
+            n_byte = int( table_name.size() );
+            sqlite3_bind_text(log_stmt_, 2, text, n_byte, SQLITE_STATIC);
+        }
         if( row_id == DISMOD_AT_NULL_SIZE_T )
-            sql_cmd += "null";
+            sqlite3_bind_null(log_stmt_, 3);
         else
-            sql_cmd += to_string( row_id );
-        sql_cmd += " , ";
-        sql_cmd += to_string( unix_time );
-        sql_cmd += " , '";
-        sql_cmd += escaped_message;
-        sql_cmd += "' );";
-        dismod_at::exec_sql_cmd(db, sql_cmd);
+            sqlite3_bind_int64(log_stmt_, 3, sqlite3_int64(row_id) );
+        sqlite3_bind_int64(log_stmt_, 4, sqlite3_int64(unix_time) );
+        text   = message.c_str();
+        n_byte = int( message.size() );
+        sqlite3_bind_text(log_stmt_, 5, text, n_byte, SQLITE_STATIC);
+        //
+        // add this message to the log table
+        int rc = sqlite3_step(log_stmt_);
+        sqlite3_reset(log_stmt_);
+        sqlite3_clear_bindings(log_stmt_);
+        if( rc != SQLITE_DONE )
+        {   // report error without using the log table
+            string error_message = "log_message: insert failed: ";
+            error_message       += sqlite3_errmsg(db);
+            finalize_log_stmt();
+            dismod_at::error_exit(error_message);
+        }
+        //
+        // make this message, and the changes before it, visible to other
+        // connections and release the write lock on the database
+        if( sqlite3_get_autocommit(db) == 0 )
+        {   dismod_at::exec_sql_cmd(db, "commit");
+            dismod_at::exec_sql_cmd(db, "begin");
+        }
     }
     recursive = false;
     //
     return unix_time;
 }
+void log_message_finalize(sqlite3* db)
+{   std::lock_guard<std::recursive_mutex> lock(log_mutex_);
+    if( db == log_db_ )
+        finalize_log_stmt();
+}
+CppAD::vector<log_message_struct> log_message_saved(void)
+{   std::lock_guard<std::recursive_mutex> lock(log_mutex_);
+    CppAD::vector<log_message_struct> saved;
+    saved.swap(log_saved_);
+    return saved;
+}
 std::time_t log_message(
     sqlite3*           db           ,
     std::ostream*      os           ,
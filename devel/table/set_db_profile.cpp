@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin set_db_profile dev}
+{xrst_spell
+  fsync
+  mib
+  mmap
+  wal
+}
+
+Set the Sqlite Tuning Parameters for a Database Connection
+##########################################################
+
+Syntax
+******
+``set_db_profile`` ( *db* , *db_profile* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_SET_DB_PROFILE_PROTOTYPE
+    // END_SET_DB_PROFILE_PROTOTYPE
+}
+
+db
+**
+is the database connection.
+There cannot be an active transaction for this connection
+because the journal mode cannot be changed during a transaction.
+
+db_profile
+**********
+is the value of the :ref:`option_table@db_profile` option.
+It must be one of the following:
+
+default
+=======
+If *db_profile* is ``default`` (or empty),
+no change is made to the sqlite settings for this connection.
+
+bulk
+====
+If *db_profile* is ``bulk`` ,
+the following sqlite pragmas are executed:
+
+.. csv-table::
+    :widths: auto
+
+    Pragma,Value,Effect
+    journal_mode,wal,a write ahead log is used instead of a rollback journal
+    synchronous,normal,no fsync when a transaction is committed
+    cache_size,-262144,the page cache can use up to 256 MiB of memory
+    mmap_size,268435456,up to 256 MiB of the database is memory mapped
+    temp_store,memory,temporary tables and indices are kept in memory
+
+The journal mode is stored in the database file; i.e.,
+it stays ``wal`` for the connections that are opened later
+(this does not affect the other sqlite settings).
+
+{xrst_toc_hidden
+    example/devel/table/set_db_profile_xam.cpp
+}
+Example
+*******
+The file :ref:`set_db_profile_xam.cpp-name` contains an example and test
+of using this routine.
+
+{xrst_end set_db_profile}
+-----------------------------------------------------------------------------
+*/
+# include <cassert>
+# include <dismod_at/set_db_profile.hpp>
+# include <dismod_at/exec_sql_cmd.hpp>
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_SET_DB_PROFILE_PROTOTYPE
+void set_db_profile(sqlite3* db, const std::string& db_profile)
+// END_SET_DB_PROFILE_PROTOTYPE
+{   assert( sqlite3_get_autocommit(db) != 0 );
+    //
+    // default
+    if( db_profile == "" || db_profile == "default" )
+        return;
+    //
+    // bulk
+    assert( db_profile == "bulk" );
+    const char* sql_cmd[] = {
+        "pragma journal_mode = wal",
+        "pragma synchronous  = normal",
+        "pragma cache_size   = -262144",
+        "pragma mmap_size    = 268435456",
+        "pragma temp_store   = memory"
+    };
+    size_t n_command = sizeof(sql_cmd) / sizeof(sql_cmd[0]);
+    for(size_t i = 0; i < n_command; ++i)
+        exec_sql_cmd(db, sql_cmd[i]);
+}
+
+} // END_DISMOD_AT_NAMESPACE
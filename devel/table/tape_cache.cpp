@@ -0,0 +1,363 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin tape_cache dev}
+
+Reading and Writing Recorded Functions in the tape_cache Table
+##############################################################
+
+Syntax
+******
+
+| *cache_key* = ``tape_cache_key`` (
+| |tab| *db* , *simulate_index* , *value* , *check_key*
+| )
+| *found* = ``read_tape_cache`` ( *db* , *cache_key* , *check_key* , *tape* )
+| ``write_tape_cache`` ( *db* , *cache_key* , *check_key* , *tape* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_TAPE_CACHE_KEY
+    // END_TAPE_CACHE_KEY
+}
+{xrst_literal
+    // BEGIN_READ_TAPE_CACHE
+    // END_READ_TAPE_CACHE
+}
+{xrst_literal
+    // BEGIN_WRITE_TAPE_CACHE
+    // END_WRITE_TAPE_CACHE
+}
+
+db
+**
+is an open connection to the database.
+
+simulate_index
+**************
+If this is less than zero, the functions do not depend on simulated data.
+Otherwise, the functions depend on the simulated values in the
+:ref:`data_sim_table-name` and :ref:`prior_sim_table-name`
+corresponding to this simulate index.
+
+value
+*****
+This vector contains any other values that the functions depend on;
+e.g., the value of the independent variables when the functions
+were recorded.
+
+cache_key
+*********
+This is a hash code for the values that the per child random likelihood
+functions depend on (the :ref:`hash_table-name` routine is used):
+
+#.  The input tables that define the data and prior models;
+    i.e., all the input tables except the avgint and option tables.
+#.  The :ref:`data_subset_table-name` .
+#.  The options that affect the data and prior models; e.g.,
+    :ref:`option_table@rate_case` and
+    :ref:`option_table@Age Average Grid@ode_step_size` .
+    Other options, e.g. the tolerances for the optimizer,
+    do not affect the key.
+#.  The *simulate_index* and, if it is not negative,
+    the rows of the data_sim and prior_sim tables for this *simulate_index* .
+#.  The vector *value* .
+
+If the functions depend on anything else, it must be a
+function of these values.
+If :ref:`option_table@Other Database@other_database` is not empty,
+some of the input tables are not in *db* and
+*cache_key* is empty (the functions should not be cached).
+
+check_key
+*********
+This is a second hash code, and the number of bytes,
+for the same values as *cache_key*; see :ref:`hash_table@check` .
+It is stored with the functions and read_tape_cache
+only returns functions that were written with the same *check_key* .
+Hence two different sets of values must have the same *cache_key*
+and the same *check_key* for the wrong functions to be used.
+
+tape
+****
+Each element of this vector is a CppAD function
+in its ``to_json`` representation.
+
+read_tape_cache
+===============
+The input size of *tape* must be zero.
+If *found* is true, upon return *tape* contains the
+functions that were written with the same *cache_key* and *check_key* .
+Otherwise, its size is zero.
+
+write_tape_cache
+================
+The elements of *tape* are written to the ``tape_cache`` table
+and replace any previous functions that have the same *cache_key* .
+The functions for other keys are not changed.
+
+Cost
+****
+The cache replaces recording and optimizing the functions by
+computing *cache_key* and reading the functions.
+Computing *cache_key* reads the tables listed above
+(including the data table) for every fit.
+See :ref:`bench_dismod_at@Tape Cache` for timing the recording
+and reading of the functions.
+
+tape_cache Table
+****************
+This table has the following columns:
+``tape_cache_id`` (integer primary key),
+``cache_key`` (text),
+``check_key`` (text),
+``tape_index`` (integer index in the *tape* vector), and
+``tape`` (a blob containing the ``to_json`` representation).
+{xrst_toc_hidden
+    example/devel/table/tape_cache_xam.cpp
+}
+Example
+*******
+The file :ref:`tape_cache_xam.cpp-name` is an example use of
+these routines.
+
+{xrst_end tape_cache}
+*/
+
+# include <cassert>
+# include <dismod_at/tape_cache.hpp>
+# include <dismod_at/hash_table.hpp>
+# include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/does_table_exist.hpp>
+# include <dismod_at/error_exit.hpp>
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    // prepare
+    sqlite3_stmt* prepare(sqlite3* db, const std::string& cmd)
+    {   sqlite3_stmt* p_stmt;
+        int           n_byte  = -1;
+        const char**  pz_tail = nullptr;
+        int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+        if( rc != SQLITE_OK )
+        {   std::string message = "tape_cache: following command failed:\n";
+            message            += cmd + "\n" + sqlite3_errmsg(db);
+            dismod_at::error_exit(message);
+        }
+        return p_stmt;
+    }
+    // has_check_key
+    // does the tape_cache table exist and have a check_key column
+    bool has_check_key(sqlite3* db)
+    {   if( ! dismod_at::does_table_exist(db, "tape_cache") )
+            return false;
+        std::string   cmd = "select check_key from tape_cache limit 0";
+        sqlite3_stmt* p_stmt;
+        int           n_byte  = -1;
+        const char**  pz_tail = nullptr;
+        int rc = sqlite3_prepare_v2(db, cmd.c_str(), n_byte, &p_stmt, pz_tail);
+        sqlite3_finalize(p_stmt);
+        return rc == SQLITE_OK;
+    }
+} // END_EMPTY_NAMESPACE
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_TAPE_CACHE_KEY
+std::string tape_cache_key(
+    sqlite3*                            db              ,
+    int                                 simulate_index  ,
+    const CppAD::vector<double>&        value           ,
+    std::string&                        check_key       )
+// END_TAPE_CACHE_KEY
+{   check_key = "";
+    //
+    // other_database
+    // the input tables in another database are not part of the key
+    if( does_table_exist(db, "option") )
+    {   std::string cmd = "select option_value from option";
+        cmd            += " where option_name = 'other_database'";
+        sqlite3_stmt* p_stmt = prepare(db, cmd);
+        bool other = false;
+        if( sqlite3_step(p_stmt) == SQLITE_ROW )
+            other = sqlite3_column_bytes(p_stmt, 0) > 0;
+        sqlite3_finalize(p_stmt);
+        if( other )
+            return "";
+    }
+    //
+    // input tables that can affect the model for the data subset
+    // BEGIN_SORT_THIS_LINE_PLUS_2
+    const char* table_list[] = {
+        "age",
+        "covariate",
+        "data",
+        "data_subset",
+        "density",
+        "integrand",
+        "mulcov",
+        "node",
+        "nslist",
+        "nslist_pair",
+        "prior",
+        "rate",
+        "rate_eff_cov",
+        "smooth",
+        "smooth_grid",
+        "subgroup",
+        "time",
+        "weight",
+        "weight_grid",
+    };
+    // END_SORT_THIS_LINE_MINUS_2
+    size_t n_table = sizeof( table_list ) / sizeof( table_list[0] );
+    //
+    // options that can affect the model for the data subset
+    // BEGIN_SORT_THIS_LINE_PLUS_3
+    std::string option_where =
+        "where option_name in ("
+        "'age_avg_split',"
+        "'compress_interval',"
+        "'hold_out_integrand',"
+        "'meas_noise_effect',"
+        "'ode_step_size',"
+        "'parent_node_id',"
+        "'parent_node_name',"
+        "'rate_case',"
+        "'splitting_covariate'"
+        ")";
+    // END_SORT_THIS_LINE_MINUS_2
+    //
+    // hash
+    fnv_hash hash;
+    for(size_t i = 0; i < n_table; ++i)
+    {   if( does_table_exist(db, table_list[i]) )
+            hash_table(db, table_list[i], hash);
+    }
+    if( does_table_exist(db, "option") )
+        hash_table(db, "option", hash, option_where);
+    hash.add( &simulate_index, sizeof(simulate_index) );
+    if( simulate_index >= 0 )
+    {   // only the rows for this simulate_index
+        std::string where = "where simulate_index = ";
+        where            += std::to_string(simulate_index);
+        hash_table(db, "data_sim", hash, where);
+        hash_table(db, "prior_sim", hash, where);
+    }
+    size_t n_value = value.size();
+    hash.add( &n_value, sizeof(n_value) );
+    if( n_value > 0 )
+        hash.add( value.data(), n_value * sizeof(double) );
+    //
+    check_key = hash.check();
+    return hash.hex();
+}
+
+// BEGIN_READ_TAPE_CACHE
+bool read_tape_cache(
+    sqlite3*                            db              ,
+    const std::string&                  cache_key       ,
+    const std::string&                  check_key       ,
+    CppAD::vector<std::string>&         tape            )
+// END_READ_TAPE_CACHE
+{   assert( tape.size() == 0 );
+    if( ! has_check_key(db) )
+        return false;
+    //
+    std::string cmd = "select tape_index, tape, check_key from tape_cache";
+    cmd            += " where cache_key = ? order by tape_index";
+    sqlite3_stmt* p_stmt = prepare(db, cmd);
+    sqlite3_bind_text(
+        p_stmt, 1, cache_key.c_str(), int( cache_key.size() ), SQLITE_STATIC
+    );
+    while( sqlite3_step(p_stmt) == SQLITE_ROW )
+    {   size_t tape_index = size_t( sqlite3_column_int64(p_stmt, 0) );
+        const char* v =
+            reinterpret_cast<const char*>( sqlite3_column_blob(p_stmt, 1) );
+        int n_byte    = sqlite3_column_bytes(p_stmt, 1);
+        const char* c =
+            reinterpret_cast<const char*>( sqlite3_column_text(p_stmt, 2) );
+        if( c == nullptr || check_key != c )
+        {   // different values with the same cache_key
+            sqlite3_finalize(p_stmt);
+            tape.clear();
+            return false;
+        }
+        if( tape_index != tape.size() )
+        {   std::string message = "tape_cache table: tape_index values for ";
+            message += "cache_key = " + cache_key + " are not 0, 1, ...";
+            sqlite3_finalize(p_stmt);
+            error_exit(message, "tape_cache");
+        }
+        if( n_byte == 0 )
+            tape.push_back( std::string("") );
+        else
+            tape.push_back( std::string(v, size_t(n_byte) ) );
+    }
+    sqlite3_finalize(p_stmt);
+    return tape.size() > 0;
+}
+
+// BEGIN_WRITE_TAPE_CACHE
+void write_tape_cache(
+    sqlite3*                            db              ,
+    const std::string&                  cache_key       ,
+    const std::string&                  check_key       ,
+    const CppAD::vector<std::string>&   tape            )
+// END_WRITE_TAPE_CACHE
+{   // a table written before the check_key column was added is dropped
+    if( does_table_exist(db, "tape_cache") && ! has_check_key(db) )
+        exec_sql_cmd(db, "drop table tape_cache");
+    std::string cmd = "create table if not exists tape_cache("
+        " tape_cache_id integer primary key,"
+        " cache_key     text,"
+        " check_key     text,"
+        " tape_index    integer,"
+        " tape          blob"
+        ");";
+    exec_sql_cmd(db, cmd);
+    //
+    exec_sql_cmd(db, "savepoint tape_cache");
+    //
+    // remove previous functions for this key
+    cmd = "delete from tape_cache where cache_key = ?";
+    sqlite3_stmt* p_stmt = prepare(db, cmd);
+    sqlite3_bind_text(
+        p_stmt, 1, cache_key.c_str(), int( cache_key.size() ), SQLITE_STATIC
+    );
+    sqlite3_step(p_stmt);
+    sqlite3_finalize(p_stmt);
+    //
+    // insert the new functions
+    cmd  = "insert into tape_cache (cache_key, check_key, tape_index, tape)";
+    cmd += " values (?, ?, ?, ?)";
+    p_stmt = prepare(db, cmd);
+    for(size_t i = 0; i < tape.size(); ++i)
+    {   sqlite3_bind_text(
+            p_stmt, 1, cache_key.c_str(), int( cache_key.size() ),
+            SQLITE_STATIC
+        );
+        sqlite3_bind_text(
+            p_stmt, 2, check_key.c_str(), int( check_key.size() ),
+            SQLITE_STATIC
+        );
+        sqlite3_bind_int64(p_stmt, 3, sqlite3_int64(i) );
+        sqlite3_bind_blob(
+            p_stmt, 4, tape[i].c_str(), int( tape[i].size() ), SQLITE_STATIC
+        );
+        if( sqlite3_step(p_stmt) != SQLITE_DONE )
+        {   std::string message = "write_tape_cache: insert failed: ";
+            message            += sqlite3_errmsg(db);
+            sqlite3_finalize(p_stmt);
+            error_exit(message, "tape_cache");
+        }
+        sqlite3_reset(p_stmt);
+    }
+    sqlite3_finalize(p_stmt);
+    //
+    exec_sql_cmd(db, "release tape_cache");
+}
+
+} // END_DISMOD_AT_NAMESPACE
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin cohort_ode dev}
@@ -42,9 +42,13 @@ points along this cohort at which the approximate solution is returned.
 
 rate_case
 *********
-This is the value of
+This is the :ref:`rate_case2enum-name` value corresponding to
 :ref:`option_table@rate_case` in the option table
-and cannot be ``no_ode`` .
+and cannot be ``no_ode_enum`` .
+The rate case is converted to a template parameter once for each call,
+so the steps do not branch on it.
+If iota (rho) is zero for this rate case, the corresponding
+argument is not used and no operations are recorded for it.
 
 age
 ***
@@ -82,6 +86,22 @@ This vector has size *n_cohort* .
 The input value of its elements does not matter.
 Upon return, *c_out* [ *k* ] is the approximation solution
 for :math:`C(a, t)` at the corresponding age and time.
+
+a1_double
+*********
+If *Float* is ``a1_double`` and
+:ref:`cohort_ode_checkpoint-name` has been called for this *rate_case* ,
+each step from *age* [ *k* ``-1`` ] to *age* [ *k* ]
+is recorded as one call to a CppAD checkpoint function
+(instead of all the operations in the step).
+This makes the tapes that use ``cohort_ode`` much smaller
+and does not change the values it computes.
+
+double
+******
+If *Float* is ``double`` ,
+each step is computed without allocating memory or branching on the
+rate case.
 {xrst_toc_hidden
     example/devel/utility/cohort_ode_xam.cpp
 }
@@ -98,12 +118,360 @@ It returns true for success and false for failure.
 # include <dismod_at/trap_ode2.hpp>
 # include <dismod_at/a1_double.hpp>
 
+namespace { // BEGIN_EMPTY_NAMESPACE
+    using dismod_at::a1_double;
+    using dismod_at::rate_case_enum;
+    using dismod_at::trapezoidal_enum;
+    using dismod_at::iota_zero_rho_zero_enum;
+    using dismod_at::iota_zero_rho_pos_enum;
+    using dismod_at::iota_pos_rho_zero_enum;
+    using dismod_at::iota_pos_rho_pos_enum;
+    using dismod_at::no_ode_enum;
+    //
+    // n_step_arg
+    // number of arguments to ode_step
+    const size_t n_step_arg = 11;
+    //
+    // ode_step_fun_[rate_case]
+    // checkpoint function for ode_step corresponding to this rate_case.
+    // These are not deleted because CppAD's list of atomic functions
+    // may be destroyed before them during program exit.
+    CppAD::chkpoint_two<double>* ode_step_fun_[no_ode_enum] = {
+        nullptr, nullptr, nullptr, nullptr, nullptr
+    };
+    //
+    // iota_zero
+    // is iota always zero for this rate case
+    constexpr bool iota_zero(rate_case_enum rate_case)
+    {   return rate_case == iota_zero_rho_zero_enum ||
+            rate_case == iota_zero_rho_pos_enum;
+    }
+    //
+    // rho_zero
+    // is rho always zero for this rate case
+    constexpr bool rho_zero(rate_case_enum rate_case)
+    {   return rate_case == iota_zero_rho_zero_enum ||
+            rate_case == iota_pos_rho_zero_enum;
+    }
+    //
+    // ode_matrix
+    // b = [ -(iota + omega), rho, iota, -(rho + chi + omega) ]
+    // The rates that are always zero for this rate case are not used,
+    // so no operations are computed, or recorded, for them.
+    template <rate_case_enum rate_case, class Float>
+    void ode_matrix(
+        const Float& iota , const Float& rho   ,
+        const Float& chi  , const Float& omega ,
+        Float& b0, Float& b1, Float& b2, Float& b3 )
+    {   if( iota_zero(rate_case) )
+        {   b0 = - omega;
+            b2 = Float(0);
+        }
+        else
+        {   b0 = - (iota + omega);
+            b2 = + iota;
+        }
+        if( rho_zero(rate_case) )
+        {   b1 = Float(0);
+            b3 = - (chi + omega);
+        }
+        else
+        {   b1 = + rho;
+            b3 = - (rho + chi + omega);
+        }
+    }
+    //
+    // ode_step
+    // x = [ iota(k-1), iota(k), rho(k-1), rho(k), chi(k-1), chi(k),
+    //       omega(k-1), omega(k), s_out(k-1), c_out(k-1), age(k) - age(k-1) ]
+    // y = [ s_out(k), c_out(k) ]
+    template <rate_case_enum rate_case, class Float>
+    void ode_step(
+        const CppAD::vector<Float>&  x           ,
+        CppAD::vector<Float>&        y           )
+    {   assert( x.size() == n_step_arg );
+        assert( y.size() == 2 );
+        //
+        // rates at the midpoint
+        Float iota_m   = Float(0);
+        Float rho_m    = Float(0);
+        if( ! iota_zero(rate_case) )
+            iota_m = (x[0] + x[1]) / Float(2);
+        if( ! rho_zero(rate_case) )
+            rho_m  = (x[2] + x[3]) / Float(2);
+        Float chi_m    = (x[4] + x[5]) / Float(2);
+        Float omega_m  = (x[6] + x[7]) / Float(2);
+        //
+        // arguments to eigen_ode2
+        CppAD::vector<Float> b(4), yi(2);
+        ode_matrix<rate_case>(
+            iota_m, rho_m, chi_m, omega_m, b[0], b[1], b[2], b[3]
+        );
+        yi[0] = x[8];
+        yi[1] = x[9];
+        Float tf = x[10];
+        //
+        // one step in solving ODE for this cohort
+        if( rate_case == trapezoidal_enum )
+            y = dismod_at::trap_ode2(b, yi, tf);
+        else
+            y = dismod_at::eigen_ode2(size_t(rate_case), b, yi, tf);
+    }
+    //
+    // call_ode_step
+    template <rate_case_enum rate_case>
+    void call_ode_step(
+        const CppAD::vector<a1_double>&  x           ,
+        CppAD::vector<a1_double>&        y           )
+    {   bool in_parallel = CppAD::thread_alloc::in_parallel();
+        if( ode_step_fun_[rate_case] != nullptr && ! in_parallel )
+            (*ode_step_fun_[rate_case])(x, y);
+        else
+            ode_step<rate_case>(x, y);
+    }
+    // ------------------------------------------------------------------------
+    // double_step
+    // One step for the double version of cohort_ode using the same formulas
+    // as trap_ode2 and eigen_ode2. It does not allocate memory and the rate
+    // case is a template parameter. The solution at the start of the step
+    // is (s_0, c_0) and at the end is (s_1, c_1).
+    template <rate_case_enum rate_case>
+    void double_step(
+        double  b0  , double  b1  , double b2 , double b3 , double tf ,
+        double  s_0 , double  c_0 , double& s_1 , double& c_1 )
+    {   double small = std::sqrt( std::numeric_limits<double>::epsilon() );
+        switch( rate_case )
+        {   // see trap_ode2
+            case trapezoidal_enum:
+            {   double tf2   = tf / 2.0;
+                double cc_0  = 1.0 - b0 * tf2;
+                double cc_1  =     - b1 * tf2;
+                double cc_2  =     - b2 * tf2;
+                double cc_3  = 1.0 - b3 * tf2;
+                double x_0   = s_0 + (b0 * s_0 + b1 * c_0) * tf2;
+                double x_1   = c_0 + (b2 * s_0 + b3 * c_0) * tf2;
+                double det_C = cc_0 * cc_3 - cc_1 * cc_2;
+                s_1 = (x_0 * cc_3 - cc_1 * x_1) / det_C;
+                c_1 = (cc_0 * x_1 - x_0 * cc_2) / det_C;
+            }
+            break;
+
+            // b1 = 0, b2 = 0: see both_zero in eigen_ode2
+            case iota_zero_rho_zero_enum:
+            s_1 = s_0 * std::exp( b0 * tf );
+            c_1 = c_0 * std::exp( b3 * tf );
+            break;
+
+            // b1 != 0, b2 = 0: see b2_zero in eigen_ode2
+            case iota_zero_rho_pos_enum:
+            {   double diff_30 = b3 - b0;
+                double term    = std::expm1( diff_30 * tf ) / diff_30;
+                if( std::fabs(diff_30) < small )
+                    term = tf  + diff_30 * tf * tf / 2.0;
+                c_1 = c_0 * std::exp( b3 * tf );
+                s_1 = std::exp( b0 * tf ) * ( s_0 + b1 * c_0 * term );
+            }
+            break;
+
+            // b1 = 0, b2 != 0: see b1_zero in eigen_ode2
+            case iota_pos_rho_zero_enum:
+            {   double diff_03 = b0 - b3;
+                double term    = std::expm1( diff_03 * tf ) / diff_03;
+                if( std::fabs(diff_03) < small )
+                    term = tf  + diff_03 * tf * tf / 2.0;
+                s_1 = s_0 * std::exp( b0 * tf );
+                c_1 = std::exp( b3 * tf ) * ( c_0 + b2 * s_0 * term );
+            }
+            break;
+
+            // b1 != 0, b2 != 0: see both_nonzero in eigen_ode2
+            case iota_pos_rho_pos_enum:
+            {   double diff      = b0 - b3;
+                double disc      = diff * diff + 4.0 * b1 * b2;
+                double root_disc = std::sqrt( disc );
+                double lambda_p  = (b0 + b3 + root_disc) / 2.0;
+                double lambda_m  = (b0 + b3 - root_disc) / 2.0;
+                double u_p       = (lambda_p - b0) / b2;
+                double u_m       = (lambda_m - b0) / b2;
+                double zi_p      = s_0 + u_p * c_0;
+                double zi_m      = s_0 + u_m * c_0;
+                double zf_p      = zi_p * std::exp( lambda_p * tf );
+                double zf_m      = zi_m * std::exp( lambda_m * tf );
+                c_1              = (zf_p - zf_m) * b2 / root_disc;
+                s_1              = zf_p - u_p * c_1;
+            }
+            break;
+
+            default:
+            assert( false );
+        }
+    }
+    //
+    // solve_cohort
+    // double version uses double_step
+    template <rate_case_enum rate_case>
+    void solve_cohort(
+        const CppAD::vector<double>&     age         ,
+        const CppAD::vector<double>&     iota        ,
+        const CppAD::vector<double>&     rho         ,
+        const CppAD::vector<double>&     chi         ,
+        const CppAD::vector<double>&     omega       ,
+        CppAD::vector<double>&           s_out       ,
+        CppAD::vector<double>&           c_out       )
+    {   for(size_t k = 1; k < age.size(); ++k)
+        {   // integrate from age[k-1] to age[k]
+            //
+            // rates at the midpoint
+            double iota_m  = 0.0;
+            double rho_m   = 0.0;
+            if( ! iota_zero(rate_case) )
+                iota_m = (iota[k-1] + iota[k]) / 2.0;
+            if( ! rho_zero(rate_case) )
+                rho_m  = (rho[k-1]  + rho[k])  / 2.0;
+            double chi_m   = (chi[k-1]   + chi[k])   / 2.0;
+            double omega_m = (omega[k-1] + omega[k]) / 2.0;
+            //
+            double b0, b1, b2, b3;
+            ode_matrix<rate_case>(
+                iota_m, rho_m, chi_m, omega_m, b0, b1, b2, b3
+            );
+            double_step<rate_case>(
+                b0, b1, b2, b3, age[k] - age[k-1],
+                s_out[k-1], c_out[k-1], s_out[k], c_out[k]
+            );
+        }
+    }
+    void solve_cohort(
+        rate_case_enum                   rate_case   ,
+        const CppAD::vector<double>&     age         ,
+        const CppAD::vector<double>&     iota        ,
+        const CppAD::vector<double>&     rho         ,
+        const CppAD::vector<double>&     chi         ,
+        const CppAD::vector<double>&     omega       ,
+        CppAD::vector<double>&           s_out       ,
+        CppAD::vector<double>&           c_out       )
+    {   switch( rate_case )
+        {   case trapezoidal_enum:
+            solve_cohort<trapezoidal_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_zero_rho_zero_enum:
+            solve_cohort<iota_zero_rho_zero_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_zero_rho_pos_enum:
+            solve_cohort<iota_zero_rho_pos_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_pos_rho_zero_enum:
+            solve_cohort<iota_pos_rho_zero_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_pos_rho_pos_enum:
+            solve_cohort<iota_pos_rho_pos_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            default:
+            assert( false );
+        }
+    }
+    // a1_double version uses call_ode_step so checkpoint functions are used
+    template <rate_case_enum rate_case>
+    void solve_cohort(
+        const CppAD::vector<double>&     age         ,
+        const CppAD::vector<a1_double>&  iota        ,
+        const CppAD::vector<a1_double>&  rho         ,
+        const CppAD::vector<a1_double>&  chi         ,
+        const CppAD::vector<a1_double>&  omega       ,
+        CppAD::vector<a1_double>&        s_out       ,
+        CppAD::vector<a1_double>&        c_out       )
+    {   CppAD::vector<a1_double> x(n_step_arg), y(2);
+        for(size_t k = 1; k < age.size(); ++k)
+        {   // integrate from age[k-1] to age[k]
+            //
+            // arguments to ode_step
+            x[0]  = iota[k-1];
+            x[1]  = iota[k];
+            x[2]  = rho[k-1];
+            x[3]  = rho[k];
+            x[4]  = chi[k-1];
+            x[5]  = chi[k];
+            x[6]  = omega[k-1];
+            x[7]  = omega[k];
+            x[8]  = s_out[k-1];
+            x[9]  = c_out[k-1];
+            x[10] = age[k] - age[k-1];
+            //
+            // one step in solving ODE for this cohort
+            call_ode_step<rate_case>(x, y);
+            //
+            // copy result to output vector
+            s_out[k] = y[0];
+            c_out[k] = y[1];
+        }
+    }
+    void solve_cohort(
+        rate_case_enum                   rate_case   ,
+        const CppAD::vector<double>&     age         ,
+        const CppAD::vector<a1_double>&  iota        ,
+        const CppAD::vector<a1_double>&  rho         ,
+        const CppAD::vector<a1_double>&  chi         ,
+        const CppAD::vector<a1_double>&  omega       ,
+        CppAD::vector<a1_double>&        s_out       ,
+        CppAD::vector<a1_double>&        c_out       )
+    {   switch( rate_case )
+        {   case trapezoidal_enum:
+            solve_cohort<trapezoidal_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_zero_rho_zero_enum:
+            solve_cohort<iota_zero_rho_zero_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_zero_rho_pos_enum:
+            solve_cohort<iota_zero_rho_pos_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_pos_rho_zero_enum:
+            solve_cohort<iota_pos_rho_zero_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            case iota_pos_rho_pos_enum:
+            solve_cohort<iota_pos_rho_pos_enum>(
+                age, iota, rho, chi, omega, s_out, c_out
+            );
+            break;
+
+            default:
+            assert( false );
+        }
+    }
+} // END_EMPTY_NAMESPACE
+
 namespace dismod_at { // BEGIN DISMOD_AT_NAMESPACE
 
 // BEGIN_PROTOTYPE
 template <class Float>
 void cohort_ode(
-    const std::string&           rate_case ,
+    rate_case_enum               rate_case ,
     const CppAD::vector<double>& age       ,
     const Float&                 pini      ,
     const CppAD::vector<Float>&  iota      ,
@@ -120,76 +488,179 @@ void cohort_ode(
     assert( n_cohort == omega.size() );
     assert( n_cohort == s_out.size() );
     assert( n_cohort == c_out.size() );
-    assert( rate_case != "no_ode" );
-    /*
-    -------------------------------------------------------------------------
-    case_number
-    -------------------------------------------------------------------------
-    b[0] = - ( iota + omega )
-    b[1] = + rho
-    b[2] = + iota
-    b[3] = - ( rho + chi + omega );
-    */
-    size_t case_number = 0;
-    if( rate_case == "iota_zero_rho_zero" )
-    {   // b[1] = 0, b[2] = 0
-        case_number = 1;
-    }
-    else if( rate_case == "iota_zero_rho_pos" )
-    {   // b[1] != 0, b[2] = 0
-        case_number = 2;
-    }
-    else if( rate_case == "iota_pos_rho_zero" )
-    {   // b[1] = 0, b[2] != 0
-        case_number = 3;
-    }
-    else if( rate_case == "iota_pos_rho_pos" )
-    {   // b[1] != 0, b[2] != 0
-        case_number = 4;
-    }
-    assert( rate_case == "trapezoidal" || case_number != 0 );
+    assert( rate_case < no_ode_enum );
     // ----------------------------------------------------------------------
     // initialize for first interval
     c_out[0] = pini;
     s_out[0] = Float(1) - pini;
     //
-    CppAD::vector<Float> b(4), yi(2), yf(2);
-    Float tf;
-    for(size_t k = 1; k < n_cohort; ++k)
-    {   // integrate from age[k-1] to age[k]
-        //
-        // rates at the midpoint
-        Float iota_m   = (iota[k-1]   + iota[k])  / Float(2);
-        Float rho_m    = (rho[k-1]    + rho[k])   / Float(2);
-        Float chi_m    = (chi[k-1]    + chi[k])   / Float(2);
-        Float omega_m  = (omega[k-1]  + omega[k]) / Float(2);
-        //
-        // arguments to eigen_ode2
-        b[0]  = - (iota_m + omega_m);
-        b[1]  = + rho_m;
-        b[2]  = + iota_m;
-        b[3]  = - (rho_m + chi_m + omega_m);
-        yi[0] = s_out[k-1];
-        yi[1] = c_out[k-1];
-        tf    = age[k] - age[k-1];
-        //
-        // one step in solving ODE for this cohort
-        if( case_number == 0 )
-            yf = trap_ode2(b, yi, tf);
-        else
-            yf = eigen_ode2(case_number, b, yi, tf);
-        //
-        // copy result to output vector
-        s_out[k] = yf[0];
-        c_out[k] = yf[1];
-    }
+    // remaining ages
+    solve_cohort(rate_case, age, iota, rho, chi, omega, s_out, c_out);
     return;
 }
+/*
+-------------------------------------------------------------------------------
+{xrst_begin cohort_ode_checkpoint dev}
+
+Record Checkpoint Function for One Step of cohort_ode
+#####################################################
+
+Syntax
+******
+``cohort_ode_checkpoint`` ( *rate_case* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_CHECKPOINT_PROTOTYPE
+    // END_CHECKPOINT_PROTOTYPE
+}
+
+rate_case
+*********
+This is the :ref:`rate_case2enum-name` value corresponding to
+:ref:`option_table@rate_case` in the option table.
+If it is ``no_ode_enum`` , this routine does nothing.
+Otherwise, a CppAD checkpoint function is recorded for one
+step of :ref:`cohort_ode-name` with this *rate_case* .
+If this routine has already been called with the same *rate_case* ,
+it does nothing.
+
+Restrictions
+************
+This routine must not be called while a ``a1_double`` tape is being recorded
+or while CppAD is in parallel mode.
+The checkpoint functions are only used in sequential mode;
+i.e., the operations for each step are recorded when a tape is
+recorded in parallel mode.
+
+{xrst_end cohort_ode_checkpoint}
+*/
+// BEGIN_CHECKPOINT_PROTOTYPE
+void cohort_ode_checkpoint(rate_case_enum rate_case)
+// END_CHECKPOINT_PROTOTYPE
+{   assert( ! CppAD::thread_alloc::in_parallel() );
+    if( rate_case == no_ode_enum )
+        return;
+    if( ode_step_fun_[rate_case] != nullptr )
+        return;
+    //
+    // ax
+    // the values of the rates at which the function is recorded do not
+    // matter because conditional expressions are used for the branches
+    CppAD::vector<a1_double> ax(n_step_arg), ay(2);
+    for(size_t i = 0; i < 8; ++i)
+        ax[i] = 0.01 * double(i + 1);
+    ax[8]  = 0.9;
+    ax[9]  = 0.1;
+    ax[10] = 1.0;
+    //
+    // fun
+    CppAD::Independent(ax);
+    switch( rate_case )
+    {   case trapezoidal_enum:
+        ode_step<trapezoidal_enum>(ax, ay);
+        break;
+
+        case iota_zero_rho_zero_enum:
+        ode_step<iota_zero_rho_zero_enum>(ax, ay);
+        break;
+
+        case iota_zero_rho_pos_enum:
+        ode_step<iota_zero_rho_pos_enum>(ax, ay);
+        break;
+
+        case iota_pos_rho_zero_enum:
+        ode_step<iota_pos_rho_zero_enum>(ax, ay);
+        break;
+
+        case iota_pos_rho_pos_enum:
+        ode_step<iota_pos_rho_pos_enum>(ax, ay);
+        break;
+
+        default:
+        assert( false );
+    }
+    CppAD::ADFun<double> fun(ax, ay);
+    fun.optimize();
+    //
+    // ode_step_fun_[rate_case]
+    const char* case_name[] = {
+        "trapezoidal",
+        "iota_zero_rho_zero",
+        "iota_zero_rho_pos",
+        "iota_pos_rho_zero",
+        "iota_pos_rho_pos"
+    };
+    std::string name      = "cohort_ode_step_";
+    name                 += case_name[rate_case];
+    bool internal_bool    = false;
+    bool use_hes_sparsity = true;
+    bool use_base2ad      = true;
+    bool use_in_parallel  = false;
+    ode_step_fun_[rate_case] = new CppAD::chkpoint_two<double>(
+        fun,
+        name,
+        internal_bool,
+        use_hes_sparsity,
+        use_base2ad,
+        use_in_parallel
+    );
+}
+
+/*
+-------------------------------------------------------------------------------
+{xrst_begin rate_case2enum dev}
+
+Convert Rate Case to an Enum Value
+##################################
+
+Syntax
+******
+| *rate_case_value* = ``rate_case2enum`` ( *rate_case* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_RATE_CASE2ENUM_PROTOTYPE
+    // END_RATE_CASE2ENUM_PROTOTYPE
+}
+
+rate_case
+*********
+This is the value of
+:ref:`option_table@rate_case` in the option table.
+
+rate_case_value
+***************
+This is the corresponding ``rate_case_enum`` value;
+i.e., *rate_case* followed by ``_enum`` .
+It is used so that the *rate_case* strings are compared once,
+when the model is constructed, instead of during each ODE solution.
+
+{xrst_end rate_case2enum}
+*/
+// BEGIN_RATE_CASE2ENUM_PROTOTYPE
+rate_case_enum rate_case2enum(const std::string& rate_case)
+// END_RATE_CASE2ENUM_PROTOTYPE
+{   if( rate_case == "trapezoidal" )
+        return trapezoidal_enum;
+    if( rate_case == "iota_zero_rho_zero" )
+        return iota_zero_rho_zero_enum;
+    if( rate_case == "iota_zero_rho_pos" )
+        return iota_zero_rho_pos_enum;
+    if( rate_case == "iota_pos_rho_zero" )
+        return iota_pos_rho_zero_enum;
+    if( rate_case == "iota_pos_rho_pos" )
+        return iota_pos_rho_pos_enum;
+    assert( rate_case == "no_ode" );
+    return no_ode_enum;
+}
 
 // instantiation macro
 # define DISMOT_AT_INSTANTIATE_COHORT_ODE(Float)     \
     template void cohort_ode<Float>(                 \
-    const std::string&           rate_case       ,   \
+    rate_case_enum               rate_case       ,   \
     const CppAD::vector<double>& age             ,   \
     const Float&                 pini            ,   \
     const CppAD::vector<Float>&  iota            ,   \
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin error_exit dev}
@@ -34,12 +34,21 @@ standard error (and an end of line is printed after it).
 
 null
 ====
-If the previous *db* was a the null pointer
-(or there was no previous *db* ), an assert is generated.
-It is not the null pointer,
+If the previous *db* was the null pointer
+(or there was no previous *db* ),
+*message* , *table_name* and *row_id* are
+:ref:`saved<log_message@db@null>` as an error message
+(they are not written to standard error) and a
+``CppAD::mixed::exception`` is thrown with ``error_exit`` as the thrower.
+This is used by processes that cannot use the database connection;
+see :ref:`process_team-name` .
+If the previous *db* is not the null pointer,
 the value *message* is also written to the
 :ref:`log_table@message` column of the log table
 and to standard error.
+If there is an active transaction for *db* ,
+it is committed before *db* is closed; i.e.,
+the changes made before the error are kept in the database.
 
 table_name
 **********
@@ -70,7 +79,8 @@ In this case, *row_id* is also written (with a label) to standard error.
 
 assert
 ******
-An assertion is generated before exiting, incase we are running in debug mode.
+If the previous *db* is not null,
+an assertion is generated before exiting, incase we are running in debug mode.
 
 {xrst_end error_exit}
 -----------------------------------------------------------------------------
@@ -86,6 +96,7 @@ An assertion is generated before exiting, incase we are running in debug mode.
 # include <cppad/utility/to_string.hpp>
 # include <dismod_at/null_int.hpp>
 # include <dismod_at/configure.hpp>
+# include <cppad/mixed/exception.hpp>
 
 namespace {
     // initial value corresponding to not initialized
@@ -105,14 +116,28 @@ void error_exit(
     // check that if table_name is empty, row_id is null
     assert( table_name != "" || row_id == DISMOD_AT_NULL_SIZE_T );
 
-    // db should never be null
-    assert( db != DISMOD_AT_NULL_PTR );
+    // if db is null, save the message and throw an exception
+    if( db == DISMOD_AT_NULL_PTR )
+    {   std::ostream* os = DISMOD_AT_NULL_PTR;
+        log_message(db, os, "error", message, table_name, row_id);
+        throw CppAD::mixed::exception("error_exit", message);
+    }
 
     // write to standard error and log table
     std::string message_type = "error";
     log_message(db, &std::cerr, message_type, message, table_name, row_id);
     //
+    // commit the changes made so far (including the error message)
+    if( sqlite3_get_autocommit(db) == 0 )
+    {   char* zErrMsg = DISMOD_AT_NULL_PTR;
+        sqlite3_exec(
+            db, "commit", DISMOD_AT_NULL_PTR, DISMOD_AT_NULL_PTR, &zErrMsg
+        );
+        sqlite3_free(zErrMsg);
+    }
+    //
     // close the database
+    log_message_finalize(db);
     sqlite3_close(db);
     //
     // if running in debugger, stop here
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin grid2line dev}
@@ -86,6 +86,13 @@ For each *i* ,
 *line_value* [ *i* ] is the
 :ref:`bilinear-name` interpolated value corresponding to
 age *line_age* [ *i* ] and time *line_time* [ *i* ] .
+
+Method
+******
+This routine calls :ref:`grid2line_matrix-name` and then
+:ref:`grid2line_product-name` .
+If the same line and grid are used many times,
+it is faster to compute the matrix once and only repeat the product.
 {xrst_toc_hidden
     example/devel/utility/grid2line_xam.cpp
 }
@@ -114,11 +121,89 @@ CppAD::vector<Float> grid2line(
     const Grid_info&             g_info       ,
     const CppAD::vector<Float>&  grid_value )
 // END PROTOTYPE
+{   grid2line_csr matrix;
+    grid2line_matrix(
+        line_age, line_time, age_table, time_table, g_info, matrix
+    );
+    CppAD::vector<Float> line_value;
+    grid2line_product(matrix, grid_value, line_value);
+    return line_value;
+}
+/*
+-------------------------------------------------------------------------------
+{xrst_begin grid2line_matrix dev}
+
+Sparse Matrix that Interpolates From a Smoothing Grid to a Line
+###############################################################
+
+Syntax
+******
+
+| ``grid2line_matrix`` (
+| *line_age* , *line_time* , *age_table* , *time_table* , *g_info* , *matrix*
+| )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_MATRIX_PROTOTYPE
+    // END_MATRIX_PROTOTYPE
+}
+
+Arguments
+*********
+The arguments *line_age* , *line_time* , *age_table* , *time_table* ,
+and *g_info* are the same as for :ref:`grid2line-name` .
+
+matrix
+******
+The input value of this argument does not matter.
+Upon return it is the compressed sparse row representation of the
+linear map from grid values to line values; i.e.,
+for *k* = 0 , ... , *n_line* ``-1``
+
+    *line_value* [ *k* ] = sum *matrix* . ``val`` [ *m* ] *
+        *grid_value* [ *matrix* . ``col`` [ *m* ] ]
+
+where the sum is over
+*matrix* . ``start`` [ *k* ] <= *m* < *matrix* . ``start`` [ *k* +1] .
+
+start
+=====
+This vector has size *n_line* + 1 and
+*matrix* . ``start`` [ *n_line* ] is the number of non-zero entries
+in the matrix.
+
+col
+===
+The column indices for row *k* are in increasing order.
+There are at most four columns for each row
+(no entries with value zero are stored).
+
+val
+===
+The value of each entry is between zero and one
+and the sum of the values for each row is one.
+
+{xrst_end grid2line_matrix}
+*/
+// BEGIN_MATRIX_PROTOTYPE
+template <class Grid_info>
+void grid2line_matrix(
+    const CppAD::vector<double>& line_age     ,
+    const CppAD::vector<double>& line_time    ,
+    const CppAD::vector<double>& age_table    ,
+    const CppAD::vector<double>& time_table   ,
+    const Grid_info&             g_info       ,
+    grid2line_csr&               matrix       )
+// END_MATRIX_PROTOTYPE
 {   //
     assert( line_age.size() == line_time.size() );
     //
     size_t n_line = line_age.size();
-    CppAD::vector<Float> line_value(n_line);
+    matrix.start.resize(n_line + 1);
+    matrix.col.resize(0);
+    matrix.val.resize(0);
     //
     // number of age and time points in the grid
     size_t n_age  = g_info.age_size();
@@ -130,12 +215,23 @@ CppAD::vector<Float> grid2line(
     double age_max  = age_table[  g_info.age_id(n_age - 1) ];
     double time_max = time_table[ g_info.time_id(n_time - 1) ];
     //
+    // push_back an entry in the matrix (entries with value zero are skipped)
+    auto push_back = [&matrix](size_t col, double val)
+    {   if( val != 0.0 )
+        {   matrix.col.push_back(col);
+            matrix.val.push_back(val);
+        }
+    };
+    //
     size_t i = 1;
     size_t j = 1;
     for(size_t k = 0; k < n_line; ++k)
     {   double age      = line_age[k];
         double time     = line_time[k];
         //
+        // start of row k
+        matrix.start[k] = matrix.col.size();
+        //
         // determine interval for this age
         bool one_age;
         if( age <= age_min )
@@ -174,35 +270,26 @@ CppAD::vector<Float> grid2line(
         // index in grid_value corresponding to grid point (i, j)
         size_t ij_smooth = i * n_time + j;
         //
-        // result of the interpolation for this point on the line
-        Float res = Float(0);
-        //
         // case with no interpolation
         if( one_age & one_time )
-            res =  grid_value[ij_smooth];
+            push_back(ij_smooth, 1.0);
         else if( one_time )
         {   // case with only age interpolation
             assert( i > 0 );
-            Float  vp = grid_value[ij_smooth];
             double ap = age_table[ g_info.age_id(i) ];
-            Float  vm = grid_value[ij_smooth - n_time];
             double am = age_table[ g_info.age_id(i - 1) ];
             assert( am <= age && age <= ap );
-            res       = vm * (ap - age);
-            res      += vp * (age - am);
-            res      /= (ap - am);
+            push_back(ij_smooth - n_time, (ap - age) / (ap - am) );
+            push_back(ij_smooth,          (age - am) / (ap - am) );
         }
         else if( one_age )
         {   // case with only time interpolation
             assert( j > 0 );
-            Float  vp = grid_value[ij_smooth];
             double tp = time_table[ g_info.time_id(j) ];
-            Float  vm = grid_value[ij_smooth - 1];
             double tm = time_table[ g_info.time_id(j - 1) ];
             assert( tm <= time && time <= tp );
-            res       = vm * (tp - time);
-            res      += vp * (time - tm);
-            res      /= (tp - tm);
+            push_back(ij_smooth - 1, (tp - time) / (tp - tm) );
+            push_back(ij_smooth,     (time - tm) / (tp - tm) );
         }
         else
         {   // interpolate in both age and time
@@ -212,23 +299,85 @@ CppAD::vector<Float> grid2line(
             double am  = age_table[ g_info.age_id(i - 1) ];
             double tp  = time_table[ g_info.time_id(j) ];
             double tm  = time_table[ g_info.time_id(j - 1) ];
-            Float  vpp = grid_value[ij_smooth];
-            Float  vmp = grid_value[ij_smooth - n_time];
-            Float  vpm = grid_value[ij_smooth - 1];
-            Float  vmm = grid_value[ij_smooth - n_time - 1];
             assert( am <= age && age <= ap );
             assert( tm <= time && time <= tp );
-            res        = vpp * (age - am) * (time - tm);
-            res       += vmm * (ap - age) * (tp - time);
-            res       += vmp * (ap - age) * (time - tm);
-            res       += vpm * (age - am) * (tp - time);
-            res       /=(ap - am) * (tp - tm);
+            double den = (ap - am) * (tp - tm);
+            push_back(ij_smooth - n_time - 1, (ap - age) * (tp - time) / den);
+            push_back(ij_smooth - n_time,     (ap - age) * (time - tm) / den);
+            push_back(ij_smooth - 1,          (age - am) * (tp - time) / den);
+            push_back(ij_smooth,              (age - am) * (time - tm) / den);
         }
-        line_value[k] = res;
+        assert( matrix.start[k] < matrix.col.size() );
     }
-    return line_value;
+    matrix.start[n_line] = matrix.col.size();
+    return;
+}
+/*
+-------------------------------------------------------------------------------
+{xrst_begin grid2line_product dev}
+
+Interpolate From a Smoothing Grid to a Line Using a Sparse Matrix
+#################################################################
+
+Syntax
+******
+
+| ``grid2line_product`` ( *matrix* , *grid_value* , *line_value* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_PRODUCT_PROTOTYPE
+    // END_PRODUCT_PROTOTYPE
 }
 
+Float
+*****
+The type *Float* must be ``double`` or
+:ref:`a1_double-name` .
+
+matrix
+******
+This is the :ref:`grid2line_matrix@matrix` for the line and grid.
+
+grid_value
+**********
+This is the value corresponding to each of the grid points; see
+:ref:`grid2line@grid_value` .
+
+line_value
+**********
+The input size and value of this vector do not matter.
+Upon return it has size *n_line* and is the
+product of *matrix* times *grid_value* .
+No memory is allocated if the capacity of *line_value*
+is at least *n_line* .
+If *Float* is ``a1_double`` , the operations recorded for each
+point on the line are at most four multiplications and three additions
+(multiplications by the constant one are not recorded).
+
+{xrst_end grid2line_product}
+*/
+// BEGIN_PRODUCT_PROTOTYPE
+template <class Float>
+void grid2line_product(
+    const grid2line_csr&         matrix       ,
+    const CppAD::vector<Float>&  grid_value   ,
+    CppAD::vector<Float>&        line_value   )
+// END_PRODUCT_PROTOTYPE
+{   size_t n_line = matrix.start.size() - 1;
+    line_value.resize(n_line);
+    for(size_t k = 0; k < n_line; ++k)
+    {   size_t m     = matrix.start[k];
+        size_t m_end = matrix.start[k+1];
+        assert( m < m_end );
+        Float res = matrix.val[m] * grid_value[ matrix.col[m] ];
+        for(++m; m < m_end; ++m)
+            res += matrix.val[m] * grid_value[ matrix.col[m] ];
+        line_value[k] = res;
+    }
+    return;
+}
 
 // instantiation
 # define DISMOD_AT_INSTANTIATE_GRID2LINE(Grid_info, Float)  \
@@ -246,5 +395,26 @@ DISMOD_AT_INSTANTIATE_GRID2LINE( smooth_info, double )
 //
 DISMOD_AT_INSTANTIATE_GRID2LINE( weight_info, a1_double )
 DISMOD_AT_INSTANTIATE_GRID2LINE( smooth_info, a1_double )
+//
+# define DISMOD_AT_INSTANTIATE_GRID2LINE_MATRIX(Grid_info)  \
+template void grid2line_matrix(                           \
+    const CppAD::vector<double>& line_age     ,           \
+    const CppAD::vector<double>& line_time    ,           \
+    const CppAD::vector<double>& age_table    ,           \
+    const CppAD::vector<double>& time_table   ,           \
+    const Grid_info&             g_info       ,           \
+    grid2line_csr&               matrix                   \
+);
+DISMOD_AT_INSTANTIATE_GRID2LINE_MATRIX( weight_info )
+DISMOD_AT_INSTANTIATE_GRID2LINE_MATRIX( smooth_info )
+//
+# define DISMOD_AT_INSTANTIATE_GRID2LINE_PRODUCT(Float)     \
+template void grid2line_product(                          \
+    const grid2line_csr&         matrix       ,           \
+    const CppAD::vector<Float>&  grid_value   ,           \
+    CppAD::vector<Float>&        line_value               \
+);
+DISMOD_AT_INSTANTIATE_GRID2LINE_PRODUCT( double )
+DISMOD_AT_INSTANTIATE_GRID2LINE_PRODUCT( a1_double )
 
 } // END DISMOD_AT_NAMESPACE
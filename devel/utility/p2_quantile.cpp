@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# include <cassert>
+# include <cmath>
+# include <limits>
+# include <algorithm>
+# include <dismod_at/p2_quantile.hpp>
+/*
+{xrst_begin p2_quantile dev}
+{xrst_spell
+  chlamtac
+  jain
+}
+
+Streaming Quantile Estimate Using the P-Squared Algorithm
+#########################################################
+
+Syntax
+******
+| ``p2_quantile`` *estimator* ( *p* )
+| *estimator* . ``add`` ( *x* )
+| *q* = *estimator* . ``value`` ()
+| *n* = *estimator* . ``count`` ()
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_P2_QUANTILE_PROTOTYPE
+    // END_P2_QUANTILE_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_ADD_PROTOTYPE
+    // END_ADD_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_VALUE_PROTOTYPE
+    // END_VALUE_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_COUNT_PROTOTYPE
+    // END_COUNT_PROTOTYPE
+}
+
+Purpose
+*******
+Estimate a quantile of a sequence of observations without storing
+the observations.
+The memory and the work per observation are constant
+(do not depend on the number of observations).
+
+Reference
+*********
+Jain, R. and Chlamtac, I. (1985),
+The P-Square Algorithm for Dynamic Calculation of Quantiles and
+Histograms Without Storing Observations,
+Communications of the ACM, 28(10), 1076-1085.
+
+p
+*
+is the probability for the quantile that we are estimating;
+e.g., 0.5 corresponds to the median.
+It must be between zero and one.
+
+x
+*
+is the next observation in the sequence.
+It must not be ``nan`` .
+
+q
+*
+is the current estimate for the *p* quantile of the observations.
+If there are five or fewer observations,
+it is the exact quantile,
+using linear interpolation between the sorted observations.
+If there are no observations, it is ``nan`` .
+Otherwise, it is the height of the middle marker in the P-Squared algorithm.
+This estimate converges to the *p* quantile as the number of
+observations grows, but it can be poor for a small number of observations
+and values of *p* near zero or one.
+
+n
+*
+is the number of observations so far.
+{xrst_toc_hidden
+    example/devel/utility/p2_quantile_xam.cpp
+}
+Example
+*******
+The file :ref:`p2_quantile_xam.cpp-name` contains an example and test
+of using this routine.
+
+{xrst_end p2_quantile}
+*/
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_P2_QUANTILE_PROTOTYPE
+p2_quantile::p2_quantile(double p)
+// END_P2_QUANTILE_PROTOTYPE
+: p_(p), count_(0)
+{   assert( 0.0 <= p && p <= 1.0 );
+    //
+    // desired marker positions
+    np_[0] = 1.0;
+    np_[1] = 1.0 + 2.0 * p;
+    np_[2] = 1.0 + 4.0 * p;
+    np_[3] = 3.0 + 2.0 * p;
+    np_[4] = 5.0;
+    //
+    // increment in desired marker positions
+    dn_[0] = 0.0;
+    dn_[1] = p / 2.0;
+    dn_[2] = p;
+    dn_[3] = (1.0 + p) / 2.0;
+    dn_[4] = 1.0;
+    //
+    for(size_t i = 0; i < 5; ++i)
+    {   q_[i] = 0.0;
+        n_[i] = double(i + 1);
+    }
+}
+
+// BEGIN_ADD_PROTOTYPE
+void p2_quantile::add(double x)
+// END_ADD_PROTOTYPE
+{   assert( ! std::isnan(x) );
+    //
+    // first five observations are stored (and sorted when there are five)
+    if( count_ < 5 )
+    {   q_[count_] = x;
+        ++count_;
+        if( count_ == 5 )
+            std::sort(q_, q_ + 5);
+        return;
+    }
+    ++count_;
+    //
+    // k
+    // cell containing x, adjusting the extreme markers if necessary
+    size_t k;
+    if( x < q_[0] )
+    {   q_[0] = x;
+        k     = 0;
+    }
+    else if( q_[4] <= x )
+    {   q_[4] = x;
+        k     = 3;
+    }
+    else
+    {   k = 0;
+        while( q_[k+1] <= x )
+            ++k;
+    }
+    assert( k < 4 );
+    //
+    // n_, np_
+    for(size_t i = k + 1; i < 5; ++i)
+        n_[i] += 1.0;
+    for(size_t i = 0; i < 5; ++i)
+        np_[i] += dn_[i];
+    //
+    // q_, n_
+    // adjust the heights of the middle markers
+    for(size_t i = 1; i < 4; ++i)
+    {   double d = np_[i] - n_[i];
+        bool move_up   = d >=  1.0 && n_[i+1] - n_[i] >  1.0;
+        bool move_down = d <= -1.0 && n_[i-1] - n_[i] < -1.0;
+        if( move_up || move_down )
+        {   double ds = move_up ? 1.0 : -1.0;
+            //
+            // parabolic prediction
+            double qp = q_[i] + ds / (n_[i+1] - n_[i-1]) * (
+                (n_[i] - n_[i-1] + ds) * (q_[i+1] - q_[i]) / (n_[i+1] - n_[i])
+              + (n_[i+1] - n_[i] - ds) * (q_[i] - q_[i-1]) / (n_[i] - n_[i-1])
+            );
+            if( q_[i-1] < qp && qp < q_[i+1] )
+                q_[i] = qp;
+            else
+            {   // linear prediction
+                size_t j = move_up ? i + 1 : i - 1;
+                q_[i] = q_[i] + ds * (q_[j] - q_[i]) / (n_[j] - n_[i]);
+            }
+            n_[i] += ds;
+        }
+    }
+}
+
+// BEGIN_VALUE_PROTOTYPE
+double p2_quantile::value(void) const
+// END_VALUE_PROTOTYPE
+{   if( count_ == 0 )
+        return std::numeric_limits<double>::quiet_NaN();
+    if( 5 < count_ )
+        return q_[2];
+    //
+    // sorted
+    double sorted[5];
+    std::copy(q_, q_ + count_, sorted);
+    std::sort(sorted, sorted + count_);
+    //
+    // linear interpolation between the sorted observations
+    double position = p_ * double(count_ - 1);
+    size_t lower    = size_t( position );
+    if( lower + 1 >= count_ )
+        return sorted[count_ - 1];
+    double fraction = position - double(lower);
+    return sorted[lower] + fraction * (sorted[lower+1] - sorted[lower]);
+}
+
+// BEGIN_COUNT_PROTOTYPE
+size_t p2_quantile::count(void) const
+// END_COUNT_PROTOTYPE
+{   return count_; }
+
+} // END_DISMOD_AT_NAMESPACE
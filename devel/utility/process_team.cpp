@@ -0,0 +1,504 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# include <cassert>
+# include <cerrno>
+# include <cstdio>
+# include <cstdint>
+# include <cstring>
+# include <iostream>
+# include <exception>
+# include <poll.h>
+# include <unistd.h>
+# include <sys/wait.h>
+# include <cppad/mixed/exception.hpp>
+# include <dismod_at/process_team.hpp>
+# include <dismod_at/error_exit.hpp>
+# include <dismod_at/null_int.hpp>
+# include <dismod_at/configure.hpp>
+/*
+{xrst_begin process_team dev}
+{xrst_spell
+  std
+}
+
+Run Tasks in a Team of Child Processes
+######################################
+
+Syntax
+******
+| *error_task* = ``process_team`` (
+| |tab| *db* , *n_process* , *n_task* , *work* , *result* , *error*
+| )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_PROCESS_TEAM_PROTOTYPE
+    // END_PROCESS_TEAM_PROTOTYPE
+}
+
+Purpose
+*******
+This routine is used to run tasks that are not thread safe; e.g.,
+fitting a model using cppad_mixed, at the same time.
+Each child process has its own copy of the memory for the calling process
+(at the time of the call) and its own copy of CppAD and cppad_mixed.
+
+db
+**
+is the database connection for the calling process.
+It is not used by the child processes.
+
+n_process
+*********
+is the number of processes in the team (must be greater than zero).
+If *n_process* is one, for *task* = 0 , ... , *n_task* ``-1`` ,
+the call *work* ( *task* , *db* ) is made by the calling process
+(no child processes are created).
+In this case, errors are handled the same as if *work* were called directly;
+e.g., an :ref:`error_exit-name` call exits the program.
+
+n_task
+******
+is the number of tasks.
+
+work
+****
+For *task* = 0 , ... , *n_task* ``-1`` ,
+the call *work* ( *task* , *task_db* ) returns the result for *task* .
+If *n_process* is greater than one, *task_db* is the null pointer.
+
+Order
+=====
+The child process with index *process* runs the tasks
+*process* , *process* + *n_process* , ... in order,
+and stops at the first task that fails.
+Hence the tasks, and the order of the tasks, that each process runs
+does not depend on timing.
+
+Errors
+======
+In a child process,
+an :ref:`error_exit-name` call throws an exception
+(see :ref:`error_exit@message@null` ).
+A task fails if *work* throws an exception,
+or if the child process terminates abnormally before it completes the task.
+
+Log Messages
+============
+In a child process,
+messages logged by *work* are :ref:`saved<log_message@db@null>` .
+After the team is done, they are logged in the database *db*
+(in order of the tasks) for the tasks with index less than or equal
+*error_task* .
+Errors and warnings are written to standard error by the child processes
+when they occur.
+
+result
+******
+The input size and elements of *result* do not matter.
+Upon return, it has size *n_task* and
+for *task* less than *error_task* ,
+*result* [ *task* ] is the return value of *work* ( *task* , *task_db* ) .
+
+error_task
+**********
+If all the tasks succeeded, *error_task* is equal to *n_task* .
+Otherwise it is the index of the first task that failed.
+The value of *error_task* does not depend on the number of processes
+or timing.
+
+error
+*****
+The input value of *error* does not matter.
+If *error_task* is less than *n_task* , upon return
+*error* contains the error message, table name, and row id for the failure.
+The caller usually passes these values to :ref:`error_exit-name` .
+
+{xrst_toc_hidden
+    example/devel/utility/process_team_xam.cpp
+}
+Example
+*******
+The file :ref:`process_team_xam.cpp-name` contains an example and test
+of using this routine.
+
+{xrst_end process_team}
+*/
+namespace { // BEGIN_EMPTY_NAMESPACE
+    using std::string;
+    using dismod_at::log_message_struct;
+    //
+    // put_size
+    void put_size(string& buffer, size_t value)
+    {   uint64_t u = uint64_t(value);
+        buffer.append( reinterpret_cast<const char*>(&u), sizeof(u) );
+    }
+    //
+    // put_string
+    void put_string(string& buffer, const string& str)
+    {   put_size(buffer, str.size() );
+        buffer += str;
+    }
+    //
+    // put_message
+    void put_message(string& buffer, const log_message_struct& message)
+    {   put_string(buffer, message.message_type);
+        put_string(buffer, message.table_name);
+        put_size(buffer, message.row_id);
+        put_string(buffer, message.message);
+    }
+    //
+    // record_reader
+    // reads the records written by one child process
+    class record_reader {
+    private:
+        const string& buffer_;
+        size_t        pos_;
+    public:
+        // ok
+        // false if the end of the buffer was reached before a field
+        bool ok;
+        //
+        record_reader(const string& buffer)
+        : buffer_(buffer), pos_(0), ok(true)
+        { }
+        // done
+        bool done(void) const
+        {   return pos_ == buffer_.size(); }
+        // get_size
+        size_t get_size(void)
+        {   uint64_t u = 0;
+            if( buffer_.size() - pos_ < sizeof(u) )
+            {   ok = false;
+                return 0;
+            }
+            std::memcpy(&u, buffer_.data() + pos_, sizeof(u) );
+            pos_ += sizeof(u);
+            return size_t(u);
+        }
+        // get_char
+        char get_char(void)
+        {   if( pos_ == buffer_.size() )
+            {   ok = false;
+                return '\0';
+            }
+            return buffer_[pos_++];
+        }
+        // get_string
+        string get_string(void)
+        {   size_t n_byte = get_size();
+            if( ! ok || buffer_.size() - pos_ < n_byte )
+            {   ok = false;
+                return "";
+            }
+            string result = buffer_.substr(pos_, n_byte);
+            pos_ += n_byte;
+            return result;
+        }
+        // get_message
+        log_message_struct get_message(void)
+        {   log_message_struct message;
+            message.message_type = get_string();
+            message.table_name   = get_string();
+            message.row_id       = get_size();
+            message.message      = get_string();
+            return message;
+        }
+    };
+    //
+    // write_all
+    bool write_all(int fd, const string& buffer)
+    {   size_t n_done = 0;
+        while( n_done < buffer.size() )
+        {   const char* data = buffer.data() + n_done;
+            ssize_t n = write(fd, data, buffer.size() - n_done);
+            if( n < 0 && errno == EINTR )
+                continue;
+            if( n <= 0 )
+                return false;
+            n_done += size_t(n);
+        }
+        return true;
+    }
+    //
+    // read_all
+    // read from each file descriptor until end of file, then close it
+    void read_all(CppAD::vector<int>& fd, CppAD::vector<string>& buffer)
+    {   size_t n_fd   = fd.size();
+        size_t n_open = 0;
+        for(size_t i = 0; i < n_fd; ++i)
+            if( fd[i] >= 0 )
+                ++n_open;
+        char chunk[4096];
+        while( n_open > 0 )
+        {   CppAD::vector<pollfd>  poll_fd;
+            CppAD::vector<size_t>  poll_index;
+            for(size_t i = 0; i < n_fd; ++i)
+            {   if( fd[i] >= 0 )
+                {   pollfd entry;
+                    entry.fd      = fd[i];
+                    entry.events  = POLLIN;
+                    entry.revents = 0;
+                    poll_fd.push_back(entry);
+                    poll_index.push_back(i);
+                }
+            }
+            int rc = poll(poll_fd.data(), nfds_t( poll_fd.size() ), -1);
+            if( rc < 0 && errno == EINTR )
+                continue;
+            for(size_t k = 0; k < poll_fd.size(); ++k)
+            {   if( rc < 0 )
+                {   // poll failed, the remaining data cannot be read
+                    size_t i = poll_index[k];
+                    close(fd[i]);
+                    fd[i] = -1;
+                    --n_open;
+                }
+                else if( poll_fd[k].revents != 0 )
+                {   size_t  i = poll_index[k];
+                    ssize_t n = read(fd[i], chunk, sizeof(chunk) );
+                    if( n > 0 )
+                        buffer[i].append(chunk, size_t(n) );
+                    else if( n == 0 || errno != EINTR )
+                    {   close(fd[i]);
+                        fd[i] = -1;
+                        --n_open;
+                    }
+                }
+            }
+        }
+    }
+    //
+    // run_child
+    // run the tasks for one child process and write the results to fd
+    void run_child(
+        size_t                                                   process   ,
+        size_t                                                   n_process ,
+        size_t                                                   n_task    ,
+        const std::function<string(size_t, sqlite3*)>&           work      ,
+        int                                                      fd        )
+    {   // error_exit throws an exception in the child processes
+        dismod_at::error_exit( DISMOD_AT_NULL_PTR );
+        //
+        for(size_t task = process; task < n_task; task += n_process)
+        {   string             result;
+            bool               failed = false;
+            log_message_struct error;
+            error.message_type = "error";
+            error.table_name   = "";
+            error.row_id       = DISMOD_AT_NULL_SIZE_T;
+            try
+            {   result = work(task, DISMOD_AT_NULL_PTR);
+            }
+            catch(const CppAD::mixed::exception& e)
+            {   failed        = true;
+                error.message = e.message("process_team");
+            }
+            catch(const std::exception& e)
+            {   failed        = true;
+                error.message = "std::exception: ";
+                error.message += e.what();
+            }
+            catch(...)
+            {   failed        = true;
+                error.message = "process_team: unknown exception";
+            }
+            //
+            // saved
+            // error_exit saves its message just before it throws
+            CppAD::vector<log_message_struct> saved =
+                dismod_at::log_message_saved();
+            size_t n_saved = saved.size();
+            if( failed && n_saved > 0 )
+            {   if( saved[n_saved - 1].message_type == "error" )
+                {   error = saved[n_saved - 1];
+                    --n_saved;
+                }
+            }
+            //
+            // buffer
+            // records for this task: log messages followed by result or error
+            string buffer;
+            for(size_t i = 0; i < n_saved; ++i)
+            {   put_size(buffer, task);
+                buffer += 'm';
+                put_message(buffer, saved[i]);
+            }
+            put_size(buffer, task);
+            if( failed )
+            {   buffer += 'e';
+                put_message(buffer, error);
+            }
+            else
+            {   buffer += 'r';
+                put_string(buffer, result);
+            }
+            if( ! write_all(fd, buffer) || failed )
+                return;
+        }
+    }
+} // END_EMPTY_NAMESPACE
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_PROCESS_TEAM_PROTOTYPE
+size_t process_team(
+    sqlite3*                                              db        ,
+    size_t                                                n_process ,
+    size_t                                                n_task    ,
+    const std::function<std::string(size_t, sqlite3*)>&   work      ,
+    CppAD::vector<std::string>&                           result    ,
+    log_message_struct&                                   error     )
+// END_PROCESS_TEAM_PROTOTYPE
+{   assert( n_process > 0 );
+    //
+    // result, error
+    result.resize(n_task);
+    error.message_type = "error";
+    error.table_name   = "";
+    error.row_id       = DISMOD_AT_NULL_SIZE_T;
+    error.message      = "";
+    //
+    // n_process == 1
+    if( n_process == 1 )
+    {   for(size_t task = 0; task < n_task; ++task)
+            result[task] = work(task, db);
+        return n_task;
+    }
+    //
+    // output written before the fork is not written again by the children
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(DISMOD_AT_NULL_PTR);
+    //
+    // pid, fd, process_error
+    CppAD::vector<pid_t>  pid(n_process);
+    CppAD::vector<int>    fd(n_process);
+    CppAD::vector<string> process_error(n_process);
+    for(size_t process = 0; process < n_process; ++process)
+    {   pid[process] = -1;
+        fd[process]  = -1;
+        //
+        int pipe_fd[2];
+        if( pipe(pipe_fd) != 0 )
+        {   process_error[process]  = "process_team: pipe failed: ";
+            process_error[process] += std::strerror(errno);
+            continue;
+        }
+        pid[process] = fork();
+        if( pid[process] < 0 )
+        {   process_error[process]  = "process_team: fork failed: ";
+            process_error[process] += std::strerror(errno);
+            close(pipe_fd[0]);
+            close(pipe_fd[1]);
+            continue;
+        }
+        if( pid[process] == 0 )
+        {   // child process
+            close(pipe_fd[0]);
+            for(size_t p = 0; p < process; ++p)
+                if( fd[p] >= 0 )
+                    close( fd[p] );
+            run_child(process, n_process, n_task, work, pipe_fd[1]);
+            close(pipe_fd[1]);
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(DISMOD_AT_NULL_PTR);
+            // do not run the exit handlers for the calling process
+            _exit(0);
+        }
+        close(pipe_fd[1]);
+        fd[process] = pipe_fd[0];
+    }
+    //
+    // buffer
+    CppAD::vector<string> buffer(n_process);
+    read_all(fd, buffer);
+    //
+    // process_error
+    for(size_t process = 0; process < n_process; ++process)
+    {   if( pid[process] > 0 )
+        {   int status = 0;
+            while( waitpid(pid[process], &status, 0) < 0 && errno == EINTR )
+                continue;
+            if( WIFSIGNALED(status) )
+            {   process_error[process]  = "process_team: process terminated ";
+                process_error[process] += "by signal ";
+                process_error[process] += std::to_string( WTERMSIG(status) );
+            }
+            else if( ! WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+                process_error[process] = "process_team: process failed";
+        }
+    }
+    //
+    // state, message, task_error
+    // state: 0 (not done), 1 (result), 2 (error)
+    CppAD::vector<char>                               state(n_task);
+    CppAD::vector< CppAD::vector<log_message_struct> > message(n_task);
+    CppAD::vector<log_message_struct>                 task_error(n_task);
+    for(size_t task = 0; task < n_task; ++task)
+        state[task] = 0;
+    for(size_t process = 0; process < n_process; ++process)
+    {   // a record that is not complete is ignored
+        record_reader reader( buffer[process] );
+        while( reader.ok && ! reader.done() )
+        {   size_t task = reader.get_size();
+            char   kind = reader.get_char();
+            if( kind == 'r' )
+            {   string value = reader.get_string();
+                if( reader.ok && task < n_task )
+                {   result[task] = value;
+                    state[task]  = 1;
+                }
+            }
+            else if( kind == 'm' || kind == 'e' )
+            {   log_message_struct value = reader.get_message();
+                if( reader.ok && task < n_task )
+                {   if( kind == 'm' )
+                        message[task].push_back(value);
+                    else
+                    {   task_error[task] = value;
+                        state[task]      = 2;
+                    }
+                }
+            }
+            else
+                reader.ok = false;
+        }
+    }
+    //
+    // error_task
+    size_t error_task = 0;
+    while( error_task < n_task && state[error_task] == 1 )
+        ++error_task;
+    //
+    // log messages for the tasks up to and including error_task
+    std::ostream* os = DISMOD_AT_NULL_PTR;
+    for(size_t task = 0; task < n_task && task <= error_task; ++task)
+    {   for(size_t i = 0; i < message[task].size(); ++i)
+        {   const log_message_struct& m = message[task][i];
+            log_message(
+                db, os, m.message_type, m.message, m.table_name, m.row_id
+            );
+        }
+    }
+    //
+    // error
+    if( error_task < n_task )
+    {   if( state[error_task] == 2 )
+            error = task_error[error_task];
+        else
+        {   error.message = process_error[error_task % n_process];
+            if( error.message == "" )
+                error.message = "process_team: process did not complete";
+            error.message += "\nwhile running task ";
+            error.message += std::to_string(error_task);
+        }
+    }
+    return error_task;
+}
+
+} // END_DISMOD_AT_NAMESPACE
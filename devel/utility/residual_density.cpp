@@ -162,9 +162,9 @@ there is no absolute value term for this residual.
 {xrst_end residual_density}
 */
 # include <cppad/cppad.hpp>
+# include <cppad/mixed/exception.hpp>
 # include <dismod_at/residual_density.hpp>
 # include <dismod_at/a1_double.hpp>
-# include <dismod_at/error_exit.hpp>
 
 namespace {
     template <class Float>
@@ -285,7 +285,7 @@ residual_struct<Float> residual_density(
     {   std::string msg = "residual_density: delta = ";
         msg += CppAD::to_string(delta);
         msg += " is not greater than 0";
-        error_exit(msg);
+        throw CppAD::mixed::exception("residual_density", msg);
     }
 
     // nan, r2, pi
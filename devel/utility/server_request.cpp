@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin server_request dev}
+{xrst_spell
+  json
+  utf
+}
+
+Parse a Server Request and Quote a JSON String
+##############################################
+
+Syntax
+******
+| *msg* = ``parse_server_request`` ( *request* , *database* , *command* )
+| *quoted* = ``json_string`` ( *str* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_PARSE_SERVER_REQUEST
+    // END_PARSE_SERVER_REQUEST
+}
+{xrst_literal
+    // BEGIN_JSON_STRING
+    // END_JSON_STRING
+}
+
+request
+*******
+is a JSON object with the following members (in any order):
+
+.. csv-table::
+    :widths: auto
+
+    Name,Value
+    database,a string containing the file name for the database
+    command,an array of strings containing the command arguments
+
+The *command* member is required.
+The *database* member is required unless *command* is ``["stop"]`` .
+The only JSON values that are supported are strings and arrays of strings.
+The ``\u`` escapes must not be surrogates; i.e., they must
+be in the Basic Multilingual Plane.
+
+database
+********
+The input value of *database* does not matter.
+Upon return it is the value of the database member (or empty).
+
+command
+*******
+The input value of *command* does not matter.
+Upon return it is the value of the command member.
+
+msg
+***
+If *msg* is empty, *request* was parsed successfully.
+Otherwise it is an error message and the values of *database*
+and *command* are unspecified.
+
+json_string
+***********
+The return value *quoted* is a JSON string (including the
+double quotes) that represents *str* .
+The double quote, the backslash, and the control characters are escaped.
+Other characters (including UTF-8 multi byte characters) are not changed.
+
+{xrst_toc_hidden
+    example/devel/utility/server_request_xam.cpp
+}
+Example
+*******
+The file :ref:`server_request_xam.cpp-name` contains an example and test
+of using these routines.
+
+{xrst_end server_request}
+-----------------------------------------------------------------------------
+*/
+# include <dismod_at/server_request.hpp>
+namespace { // BEGIN_EMPTY_NAMESPACE
+    //
+    // parser
+    // a recursive descent parser for the subset of JSON used by requests
+    class parser {
+    private:
+        const std::string& str_;
+        size_t             pos_;
+    public:
+        // msg
+        // error message for the first error (empty if no error)
+        std::string msg;
+        //
+        parser(const std::string& str) : str_(str), pos_(0)
+        { }
+        // skip_space
+        void skip_space(void)
+        {   while( pos_ < str_.size() && std::isspace(
+                static_cast<unsigned char>( str_[pos_] )
+            ) ) ++pos_;
+        }
+        // done
+        bool done(void)
+        {   skip_space();
+            return pos_ == str_.size();
+        }
+        // next
+        // if the next non-space character is ch, skip it and return true
+        bool next(char ch)
+        {   skip_space();
+            if( pos_ < str_.size() && str_[pos_] == ch )
+            {   ++pos_;
+                return true;
+            }
+            return false;
+        }
+        // expect
+        void expect(char ch)
+        {   if( msg == "" && ! next(ch) )
+            {   msg  = "expected " + std::string(1, ch);
+                msg += " at character " + std::to_string(pos_);
+            }
+        }
+        // string
+        std::string string(void)
+        {   std::string result;
+            expect('"');
+            while( msg == "" )
+            {   if( pos_ == str_.size() )
+                {   msg = "unterminated string";
+                    return result;
+                }
+                char ch = str_[pos_++];
+                if( ch == '"' )
+                    return result;
+                if( ch != '\\' )
+                    result += ch;
+                else if( pos_ == str_.size() )
+                    msg = "unterminated string";
+                else
+                {   ch = str_[pos_++];
+                    switch( ch )
+                    {   case '"':  result += '"';  break;
+                        case '\\': result += '\\'; break;
+                        case '/':  result += '/';  break;
+                        case 'b':  result += '\b'; break;
+                        case 'f':  result += '\f'; break;
+                        case 'n':  result += '\n'; break;
+                        case 'r':  result += '\r'; break;
+                        case 't':  result += '\t'; break;
+                        case 'u':  unicode(result); break;
+                        default:
+                        msg = "invalid escape \\" + std::string(1, ch);
+                    }
+                }
+            }
+            return result;
+        }
+        // unicode
+        // convert \uXXXX, that is not a surrogate, to UTF-8
+        void unicode(std::string& result)
+        {   if( str_.size() - pos_ < 4 )
+            {   msg = "invalid \\u escape";
+                return;
+            }
+            unsigned int code = 0;
+            for(size_t i = 0; i < 4; ++i)
+            {   char ch = str_[pos_++];
+                code *= 16;
+                if( '0' <= ch && ch <= '9' )
+                    code += (unsigned int)(ch - '0');
+                else if( 'a' <= ch && ch <= 'f' )
+                    code += (unsigned int)(ch - 'a' + 10);
+                else if( 'A' <= ch && ch <= 'F' )
+                    code += (unsigned int)(ch - 'A' + 10);
+                else
+                {   msg = "invalid \\u escape";
+                    return;
+                }
+            }
+            if( 0xd800 <= code && code <= 0xdfff )
+                msg = "\\u surrogate pairs are not supported";
+            else if( code < 0x80 )
+                result += char(code);
+            else if( code < 0x800 )
+            {   result += char( 0xc0 | (code >> 6) );
+                result += char( 0x80 | (code & 0x3f) );
+            }
+            else
+            {   result += char( 0xe0 | (code >> 12) );
+                result += char( 0x80 | ((code >> 6) & 0x3f) );
+                result += char( 0x80 | (code & 0x3f) );
+            }
+        }
+        // string_vec
+        CppAD::vector<std::string> string_vec(void)
+        {   CppAD::vector<std::string> result;
+            expect('[');
+            if( msg == "" && next(']') )
+                return result;
+            while( msg == "" )
+            {   result.push_back( string() );
+                if( ! next(',') )
+                {   expect(']');
+                    return result;
+                }
+            }
+            return result;
+        }
+    };
+} // END_EMPTY_NAMESPACE
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+// BEGIN_PARSE_SERVER_REQUEST
+std::string parse_server_request(
+    const std::string&          request  ,
+    std::string&                database ,
+    CppAD::vector<std::string>& command  )
+// END_PARSE_SERVER_REQUEST
+{   database = "";
+    command.resize(0);
+    bool found_database = false;
+    bool found_command  = false;
+    //
+    parser p(request);
+    p.expect('{');
+    if( p.msg == "" && ! p.next('}') ) while( p.msg == "" )
+    {   std::string name = p.string();
+        p.expect(':');
+        if( p.msg != "" )
+            break;
+        if( name == "database" && ! found_database )
+        {   database       = p.string();
+            found_database = true;
+        }
+        else if( name == "command" && ! found_command )
+        {   command        = p.string_vec();
+            found_command  = true;
+        }
+        else
+            p.msg = "unexpected or repeated member " + json_string(name);
+        if( ! p.next(',') )
+        {   p.expect('}');
+            break;
+        }
+    }
+    if( p.msg == "" && ! p.done() )
+        p.msg = "unexpected text after the request";
+    if( p.msg != "" )
+        return "request: " + p.msg;
+    //
+    if( ! found_command || command.size() == 0 )
+        return "request: the command member is missing or empty";
+    bool stop = command.size() == 1 && command[0] == "stop";
+    if( ! stop && database == "" )
+        return "request: the database member is missing or empty";
+    return "";
+}
+// BEGIN_JSON_STRING
+std::string json_string(const std::string& str)
+// END_JSON_STRING
+{   const char* digit = "0123456789abcdef";
+    std::string result = "\"";
+    for(size_t i = 0; i < str.size(); ++i)
+    {   unsigned char ch = static_cast<unsigned char>( str[i] );
+        if( ch == '"' || ch == '\\' )
+        {   result += '\\';
+            result += char(ch);
+        }
+        else if( ch == '\n' )
+            result += "\\n";
+        else if( ch == '\t' )
+            result += "\\t";
+        else if( ch < 0x20 )
+        {   result += "\\u00";
+            result += digit[ch >> 4];
+            result += digit[ch & 0xf];
+        }
+        else
+            result += char(ch);
+    }
+    result += '"';
+    return result;
+}
+
+} // END_DISMOD_AT_NAMESPACE
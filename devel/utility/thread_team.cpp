@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# include <cassert>
+# include <thread>
+# include <vector>
+# include <exception>
+# include <cppad/cppad.hpp>
+# include <dismod_at/thread_team.hpp>
+/*
+{xrst_begin thread_team dev}
+{xrst_spell
+  cppad
+  std
+}
+
+Run a Team of Threads That Share the Same Work Function
+#######################################################
+
+Syntax
+******
+``thread_team`` ( *n_thread* , *work* )
+
+Prototype
+*********
+{xrst_literal
+    // BEGIN_THREAD_TEAM_PROTOTYPE
+    // END_THREAD_TEAM_PROTOTYPE
+}
+
+n_thread
+********
+is the number of threads in the team (must be greater than zero).
+If *n_thread* is one, *work* ( 0 ) is called directly
+(no threads are created and CppAD is not changed).
+
+work
+****
+For *thread* = 0 , ... , *n_thread* ``-1`` ,
+the call *work* ( *thread* ) is made using a different thread.
+The current thread is used for *thread* equal to zero.
+Each thread should use its own temporary work space;
+e.g., a copy of a model object that it uses for evaluation.
+The threads should divide the work between them; e.g.,
+using a ``std::atomic<size_t>`` to get the index of the next task.
+
+CppAD
+=====
+During the calls to *work* ,
+CppAD is in parallel mode with *n_thread* threads; see
+``thread_alloc::parallel_setup`` and ``parallel_ad`` in the CppAD
+documentation.
+This requires that memory allocated by ``CppAD::vector``
+is freed by the same thread that allocated it
+(or after ``thread_team`` returns).
+When ``thread_team`` returns, the memory being held for re-use
+by the other threads has been freed and CppAD is back in sequential mode.
+
+Exceptions
+**********
+If *work* throws an exception on one or more threads,
+all of the threads are joined, CppAD is returned to sequential mode,
+and then the exception for the lowest thread index is re-thrown.
+If the tasks are divided between the threads as they run,
+the thread index for a task depends on the timing.
+In this case, *work* should catch its exceptions and record the
+smallest task index that failed, so that the exception re-thrown
+by the caller is the same as when the tasks are run in order.
+
+Restriction
+***********
+This routine must be called in sequential mode; i.e.,
+it cannot be called by the *work* function.
+{xrst_toc_hidden
+    example/devel/utility/thread_team_xam.cpp
+}
+Example
+*******
+The file :ref:`thread_team_xam.cpp-name` contains an example and test
+of using this routine.
+
+{xrst_end thread_team}
+*/
+namespace {
+    // in_parallel_
+    bool in_parallel_ = false;
+    //
+    // thread_num_
+    thread_local size_t thread_num_ = 0;
+    //
+    // in_parallel
+    bool in_parallel(void)
+    {   return in_parallel_; }
+    //
+    // thread_num
+    size_t thread_num(void)
+    {   return thread_num_; }
+}
+
+namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
+
+// BEGIN_THREAD_TEAM_PROTOTYPE
+void thread_team(
+    size_t                                 n_thread ,
+    const std::function<void(size_t)>&     work     )
+// END_THREAD_TEAM_PROTOTYPE
+{   using CppAD::thread_alloc;
+    assert( n_thread > 0 );
+    assert( ! in_parallel_ );
+    //
+    // n_thread == 1
+    if( n_thread == 1 )
+    {   work(0);
+        return;
+    }
+    //
+    // setup CppAD for n_thread threads (must be done in sequential mode)
+    thread_alloc::parallel_setup(n_thread, in_parallel, thread_num);
+    thread_alloc::hold_memory(true);
+    CppAD::parallel_ad<double>();
+    CppAD::parallel_ad< CppAD::AD<double> >();
+    //
+    // error
+    std::vector<std::exception_ptr> error(n_thread);
+    //
+    // team
+    in_parallel_ = true;
+    std::vector<std::thread> team;
+    for(size_t thread = 1; thread < n_thread; ++thread)
+    {   team.push_back( std::thread( [&work, &error, thread](void)
+        {   thread_num_ = thread;
+            try
+            {   work(thread);
+            }
+            catch(...)
+            {   error[thread] = std::current_exception();
+            }
+            thread_alloc::free_available(thread);
+        } ) );
+    }
+    //
+    // work for thread zero
+    try
+    {   work(0);
+    }
+    catch(...)
+    {   error[0] = std::current_exception();
+    }
+    for(size_t thread = 1; thread < n_thread; ++thread)
+        team[thread - 1].join();
+    in_parallel_ = false;
+    //
+    // back to sequential mode
+    thread_alloc::hold_memory(false);
+    for(size_t thread = 0; thread < n_thread; ++thread)
+        thread_alloc::free_available(thread);
+    thread_alloc::parallel_setup(1, nullptr, nullptr);
+    //
+    // re-throw the first exception
+    for(size_t thread = 0; thread < n_thread; ++thread)
+    {   if( error[thread] )
+            std::rethrow_exception( error[thread] );
+    }
+    return;
+}
+
+} // END_DISMOD_AT_NAMESPACE
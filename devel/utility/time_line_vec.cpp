@@ -1,7 +1,8 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
+# include <algorithm>
 # include <dismod_at/time_line_vec.hpp>
 # include <dismod_at/a1_double.hpp>
 
@@ -26,7 +27,10 @@ Syntax
 | *sub_lower* = *vec* . ``sub_lower`` ()
 | *sub_upper* = *vec* . ``sub_upper`` ()
 | *vec* . ``add_point`` ( *age_index* , *point* )
-| *time_line* = *vec* . ``time_line`` ( *age_index* )
+| *n_time* = *vec* . ``line_size`` ( *age_index* )
+| *time* = *vec* . ``line_time`` ( *age_index* )
+| *weight* = *vec* . ``line_weight`` ( *age_index* )
+| *value* = *vec* . ``line_value`` ( *age_index* )
 | *time_diff* = *vec* . ``max_time_diff`` ( *age_index* , *time_index* )
 | *avg* = *vec* . ``age_time_avg`` ()
 
@@ -71,6 +75,14 @@ the specified lower and upper ages and times where
 There is a time line for each sub grid point
 and it is initialized as empty.
 
+Memory
+======
+The time lines are stored in three contiguous arrays
+(time, weight, and value) with a section reserved for each time line.
+A section is only moved when its time line grows past the space reserved
+for it, and the space is not freed by ``specialize`` ,
+so the arrays are usually re-used without any memory allocation.
+
 extend_grid
 ***********
 This return value is an extended age grid and is monotone increasing.
@@ -102,6 +114,10 @@ This is the index, for the time line, in the extended age grid
 add_point
 *********
 This adds a time point to the specified time line.
+The time line is kept sorted by time.
+A binary search is used to find where the point goes and
+only the points in this time line that have a larger time are moved.
+Adding points in increasing time order does not move any points.
 
 point
 =====
@@ -117,19 +133,41 @@ The time must satisfy
 In addition, two calls to ``add_point`` cannot have the
 same *age_index* and *point* . ``time`` .
 
-time_line
+line_size
 *********
-This vector contains the points in the time line
+The return value *n_time* is the number of points in the time line
 that corresponds to the specified *age_index* .
-The vector monotone non-decreasing in time; i.e.,
 
-    *time_line* [ *i* ]. ``time <`` = *time_line* [ *i* +1]. ``time``
+line_time
+*********
+The return value *time* is a pointer to the
+*n_time* times in the time line that corresponds to *age_index* .
+The times are monotone increasing; i.e.,
+
+    *time* [ *i* ] < *time* [ *i* +1]
+
+line_weight
+***********
+The return value *weight* is a pointer to the
+*n_time* weights in the time line that corresponds to *age_index* ;
+i.e., *weight* [ *i* ] is the weight corresponding to *time* [ *i* ] .
+
+line_value
+**********
+The return value *value* is a pointer to the
+*n_time* values in the time line that corresponds to *age_index* ;
+i.e., *value* [ *i* ] is the value corresponding to *time* [ *i* ] .
+
+Pointers
+========
+The pointers *time* , *weight* , and *value* are only valid until the
+next call to ``add_point`` or ``specialize`` .
 
 max_time_diff
 *************
 This function find the maximum value for
 
-    *max_time_diff* = *time_line* [ *time_index* + 1] ``-`` *time_line* [ *time_index* ]
+    *max_time_diff* = *time* [ *time_index* + 1] ``-`` *time* [ *time_index* ]
 
 age_index
 =========
@@ -147,9 +185,9 @@ It the return value *time_diff*  > 0 ,
 it is the maximum time difference for the time lines in *vec* .
 In addition, *time_index*  > 0 and
 
-    *max_time_diff* = *time_line* [ *time_index* ] ``-`` *time_line* [ *time_index* ``- 1`` ]
+    *max_time_diff* = *time* [ *time_index* ] ``-`` *time* [ *time_index* ``- 1`` ]
 
-where *time_line* corresponds to *age_index* .
+where *time* corresponds to *age_index* .
 
 age_time_avg
 ************
@@ -205,8 +243,20 @@ Prototype
     // END_SUB_UPPER_PROTOTYPE
 }
 {xrst_literal
-    // BEGIN_TIME_LINE_PROTOTYPE
-    // END_TIME_LINE_PROTOTYPE
+    // BEGIN_LINE_SIZE_PROTOTYPE
+    // END_LINE_SIZE_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_LINE_TIME_PROTOTYPE
+    // END_LINE_TIME_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_LINE_WEIGHT_PROTOTYPE
+    // END_LINE_WEIGHT_PROTOTYPE
+}
+{xrst_literal
+    // BEGIN_LINE_VALUE_PROTOTYPE
+    // END_LINE_VALUE_PROTOTYPE
 }
 {xrst_literal
     // BEGIN_MAX_TIME_DIFF_PROTOTYPE
@@ -315,11 +365,23 @@ void time_line_vec<Float>::specialize(
         ++age_index;
     }
     // -----------------------------------------------------------------
-    // vec_
-    size_t n_sub = sub_upper_ - sub_lower_ + 1;
-    vec_.resize(n_sub);
-    for(size_t j = 0; j < n_sub; ++j)
-        vec_[j].resize(0);
+    // start_, size_
+    // Use the same capacity for each time line, the largest that fits in
+    // the memory already allocated (with a minimum of two).
+    size_t n_sub    = sub_upper_ - sub_lower_ + 1;
+    size_t capacity = std::max( size_t(2), time_.capacity() / n_sub );
+    start_.resize(n_sub + 1);
+    size_.resize(n_sub);
+    for(size_t i = 0; i < n_sub; ++i)
+    {   start_[i] = i * capacity;
+        size_[i]  = 0;
+    }
+    start_[n_sub] = n_sub * capacity;
+    //
+    // time_, weight_, value_
+    time_.resize( start_[n_sub] );
+    weight_.resize( start_[n_sub] );
+    value_.resize( start_[n_sub] );
 }
 // ---------------------------------------------------------------------------
 // BEGIN_EXTEND_GRID_PROTOTYPE
@@ -343,6 +405,38 @@ size_t time_line_vec<Float>::sub_upper(void) const
 {   return sub_upper_; }
 
 
+// ---------------------------------------------------------------------------
+// grow
+template <class Float>
+void time_line_vec<Float>::grow(size_t i)
+{   size_t n_sub = size_.size();
+    //
+    // capacity for time line i is doubled, others do not change
+    size_t extra = std::max( size_t(2), start_[i+1] - start_[i] );
+    //
+    // new_time, new_weight, new_value
+    size_t n_total = start_[n_sub] + extra;
+    CppAD::vector<double> new_time(n_total), new_weight(n_total);
+    CppAD::vector<Float>  new_value(n_total);
+    //
+    // move the time lines to their new locations
+    size_t shift = 0;
+    for(size_t ell = 0; ell < n_sub; ++ell)
+    {   for(size_t k = start_[ell]; k < start_[ell] + size_[ell]; ++k)
+        {   new_time[k + shift]   = time_[k];
+            new_weight[k + shift] = weight_[k];
+            new_value[k + shift]  = value_[k];
+        }
+        start_[ell] += shift;
+        if( ell == i )
+            shift = extra;
+    }
+    start_[n_sub] += shift;
+    time_.swap(new_time);
+    weight_.swap(new_weight);
+    value_.swap(new_value);
+}
+
 // ---------------------------------------------------------------------------
 // BEGIN_ADD_POINT_PROTOTYPE
 template <class Float>
@@ -355,43 +449,79 @@ void time_line_vec<Float>::add_point(
     assert( sub_lower_ <= age_index );
     assert( age_index <= sub_upper_ );
     //
-    // this time line
-    CppAD::vector<time_point>& time_line = vec_[age_index - sub_lower_];
-    size_t n_time = time_line.size();
+    // index of this time line
+    size_t i = age_index - sub_lower_;
     //
-    // time index at which to insert this point
-    size_t time_index = 0;
-    while( time_index < n_time && time_line[time_index].time < point.time )
-        ++time_index;
+    // make sure there is room for another point
+    if( start_[i] + size_[i] == start_[i+1] )
+        grow(i);
     //
-    // case where this point goes at the end of the line
-    if( time_index == n_time )
-    {   time_line.push_back(point);
-        return;
-    }
+    // first and end of this time line
+    size_t first = start_[i];
+    size_t end   = start_[i] + size_[i];
+    //
+    // index at which to insert this point
+    const double* time = time_.data();
+    size_t index = size_t(
+        std::upper_bound(time + first, time + end, point.time) - time
+    );
     //
     // make sure two calls do not have the same time
-    assert( ! near_equal( point.time, time_line[time_index].time ) );
+    assert( index == first || ! near_equal( point.time, time_[index-1] ) );
+    assert( index == end   || ! near_equal( point.time, time_[index] ) );
+    //
+    // move the points after index
+    for(size_t k = end; k > index; --k)
+        time_[k] = time_[k-1];
+    for(size_t k = end; k > index; --k)
+        weight_[k] = weight_[k-1];
+    for(size_t k = end; k > index; --k)
+        value_[k] = value_[k-1];
     //
-    // case where this point is inserted at time_index
-    time_line.push_back( time_line[n_time-1] );
-    for(size_t i = n_time - 1; i > time_index; --i)
-        time_line[i] = time_line[i-1];
-    time_line[time_index] = point;
+    // insert this point
+    time_[index]   = point.time;
+    weight_[index] = point.weight;
+    value_[index]  = point.value;
+    ++size_[i];
     //
     return;
 }
 
 // ---------------------------------------------------------------------------
-// BEGIN_TIME_LINE_PROTOTYPE
+// BEGIN_LINE_SIZE_PROTOTYPE
 template <class Float>
-const CppAD::vector<typename time_line_vec<Float>::time_point>&
-time_line_vec<Float>::time_line(const size_t& age_index) const
-// END_TIME_LINE_PROTOTYPE
-{
-    assert( sub_lower_ <= age_index );
+size_t time_line_vec<Float>::line_size(const size_t& age_index) const
+// END_LINE_SIZE_PROTOTYPE
+{   assert( sub_lower_ <= age_index );
+    assert( age_index <= sub_upper_ );
+    return size_[age_index - sub_lower_];
+}
+// ---------------------------------------------------------------------------
+// BEGIN_LINE_TIME_PROTOTYPE
+template <class Float>
+const double* time_line_vec<Float>::line_time(const size_t& age_index) const
+// END_LINE_TIME_PROTOTYPE
+{   assert( sub_lower_ <= age_index );
+    assert( age_index <= sub_upper_ );
+    return time_.data() + start_[age_index - sub_lower_];
+}
+// ---------------------------------------------------------------------------
+// BEGIN_LINE_WEIGHT_PROTOTYPE
+template <class Float>
+const double* time_line_vec<Float>::line_weight(const size_t& age_index) const
+// END_LINE_WEIGHT_PROTOTYPE
+{   assert( sub_lower_ <= age_index );
+    assert( age_index <= sub_upper_ );
+    return weight_.data() + start_[age_index - sub_lower_];
+}
+// ---------------------------------------------------------------------------
+// BEGIN_LINE_VALUE_PROTOTYPE
+template <class Float>
+const Float* time_line_vec<Float>::line_value(const size_t& age_index) const
+// END_LINE_VALUE_PROTOTYPE
+{   assert( sub_lower_ <= age_index );
     assert( age_index <= sub_upper_ );
-    return vec_[age_index - sub_lower_];
+    return value_.data() + start_[age_index - sub_lower_];
 }
 // ---------------------------------------------------------------------------
 // BEGIN_MAX_TIME_DIFF_PROTOTYPE
@@ -403,16 +533,14 @@ double time_line_vec<Float>::max_time_diff(
 {   double max_diff   = 0.0;
     size_t n_sub = sub_upper_ - sub_lower_ + 1;
     for(size_t i = 0; i < n_sub; ++i)
-    {   const CppAD::vector<time_point>& time_line = vec_[i];
-        size_t n_time = time_line.size();
-        if( n_time > 1 )
-        {   for(size_t j = 1; j < n_time; ++j)
-            {   double diff = time_line[j].time - time_line[j-1].time;
-                if( diff > max_diff )
-                {   age_index  = sub_lower_ + i;
-                    time_index = j;
-                    max_diff   = diff;
-                }
+    {   const double* time = time_.data() + start_[i];
+        size_t n_time      = size_[i];
+        for(size_t j = 1; j < n_time; ++j)
+        {   double diff = time[j] - time[j-1];
+            if( diff > max_diff )
+            {   age_index  = sub_lower_ + i;
+                time_index = j;
+                max_diff   = diff;
             }
         }
     }
@@ -430,29 +558,31 @@ Float time_line_vec<Float>::age_time_avg(void) const
     CppAD::vector<double> sum_w(n_sub);
     CppAD::vector<Float>  sum_wv(n_sub);
     for(size_t i = 0; i < n_sub; ++i)
-    {   const CppAD::vector<time_point>& line( vec_[i] );
-        size_t n_time = line.size();
+    {   const double* time   = time_.data()   + start_[i];
+        const double* weight = weight_.data() + start_[i];
+        const Float*  value  = value_.data()  + start_[i];
+        size_t n_time        = size_[i];
         //
         assert( n_time >= 1 );
-        assert( near_equal( line[0].time, time_lower_ ) );
-        assert( near_equal( line[n_time - 1].time, time_upper_ ) );
+        assert( near_equal( time[0], time_lower_ ) );
+        assert( near_equal( time[n_time - 1], time_upper_ ) );
         //
         if( n_time == 1 )
-        {   sum_w[i]  = line[0].weight;
-            sum_wv[i] = line[0].weight * line[0].value;
+        {   sum_w[i]  = weight[0];
+            sum_wv[i] = weight[0] * value[0];
         }
         else
         {
             sum_w[i] = 0.0;
             sum_wv[i]  = 0.0;
             for(size_t j = 1; j < n_time; ++j )
-            {   double t_m = line[j-1].time;
-                double w_m = line[j-1].weight;
-                Float  v_m = line[j-1].value;
+            {   double t_m = time[j-1];
+                double w_m = weight[j-1];
+                Float  v_m = value[j-1];
                 //
-                double t_j = line[j].time;
-                double w_j = line[j].weight;
-                Float  v_j = line[j].value;
+                double t_j = time[j];
+                double w_j = weight[j];
+                Float  v_j = value[j];
                 //
                 sum_w[i]  += (t_j - t_m) * (w_j + w_m) / 2.0;
                 sum_wv[i] += (t_j - t_m) * (w_j*v_j + w_m*v_m) / Float(2);
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin example_devel.cpp dev}
@@ -69,13 +69,18 @@ extern bool residual_density_xam(void);
 extern bool sim_random_xam(void);
 extern bool grid2line_xam(void);
 extern bool split_space_xam(void);
+extern bool thread_team_xam(void);
 extern bool time_line_vec_xam(void);
+extern bool p2_quantile_xam(void);
+extern bool server_request_xam(void);
+extern bool process_team_xam(void);
 
 // table subdirectory
 extern bool get_bnd_mulcov_table_xam(void);
 extern bool blob_table_xam(void);
 extern bool check_pini_n_age_xam(void);
 extern bool create_table_xam(void);
+extern bool db_input_cache_xam(void);
 extern bool get_age_table_xam(void);
 extern bool get_nslist_table_xam(void);
 extern bool get_avgint_table_xam(void);
@@ -100,7 +105,9 @@ extern bool get_time_table_xam(void);
 extern bool get_weight_grid_xam(void);
 extern bool get_subgroup_table_xam(void);
 extern bool put_table_row_xam(void);
+extern bool set_db_profile_xam(void);
 extern bool smooth_info_xam(void);
+extern bool tape_cache_xam(void);
 extern bool weight_info_xam(void);
 
 // anonymous namespace
@@ -168,13 +175,18 @@ int main(void)
     RUN(sim_random_xam);
     RUN(grid2line_xam);
     RUN(split_space_xam);
+    RUN(thread_team_xam);
     RUN(time_line_vec_xam);
+    RUN(p2_quantile_xam);
+    RUN(server_request_xam);
+    RUN(process_team_xam);
 
     // table subdirectory
     RUN(get_bnd_mulcov_table_xam);
     RUN(blob_table_xam);
     RUN(check_pini_n_age_xam);
     RUN(create_table_xam);
+    RUN(db_input_cache_xam);
     RUN(get_age_table_xam);
     RUN(get_nslist_table_xam);
     RUN(get_avgint_table_xam);
@@ -199,7 +211,9 @@ int main(void)
     RUN(get_weight_grid_xam);
     RUN(get_subgroup_table_xam);
     RUN(put_table_row_xam);
+    RUN(set_db_profile_xam);
     RUN(smooth_info_xam);
+    RUN(tape_cache_xam);
     RUN(weight_info_xam);
 
     // summary report
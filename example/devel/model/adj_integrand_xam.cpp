@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-23 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin adj_integrand_xam.cpp dev}
@@ -206,12 +206,18 @@ bool adj_integrand_xam(void)
         s_info_vec,
         pack_object
     );
+    //
+    // interp
+    dismod_at::adj_integrand::line_interp interp;
+    adjint_obj.interp_line(integrand_id, cohort_age, cohort_time, interp);
+    //
     size_t subgroup_id = 0;
     size_t node_id     = 0;
     vector<Float> adj_line = adjint_obj.line(
         node_id,
         cohort_age,
         cohort_time,
+        interp,
         integrand_id,
         n_child,
         child,
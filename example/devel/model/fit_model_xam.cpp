@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin fit_model_xam.cpp dev}
@@ -490,6 +490,40 @@ bool fit_model_xam(void)
             }
         }
     }
+    // ----------------- fit using a separate tape for each child ------------
+    bool trace_init    = false;
+    bool tape_by_child = true;
+    dismod_at::fit_model fit_child(
+        db,
+        simulate_index,
+        warn_on_stderr,
+        bound_random,
+        pack_object,
+        var2prior,
+        start_var,
+        scale_var,
+        prior_table,
+        prior_object,
+        random_const,
+        quasi_fixed,
+        zero_sum_child_rate,
+        zero_sum_mulcov_group,
+        data_object,
+        trace_init,
+        tape_by_child
+    );
+    CppAD::mixed::warm_start_struct warm_child;
+    fit_child.run_fit( random_only, option_map, warm_child );
+    CppAD::vector<double> solution_child;
+    fit_child.get_solution(
+        solution_child, lag_value, lag_dage, lag_dtime, trace_vec, warm_child
+    );
+    //
+    // check that the solution is the same
+    for(size_t var_id = 0; var_id < solution.size(); ++var_id)
+    {   double diff = solution_child[var_id] - solution[var_id];
+        ok         &= fabs(diff) <= 1e-6 * (1.0 + fabs( solution[var_id] ));
+    }
     // close the database connection
     sqlite3_close(db);
     //
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin create_table_xam.cpp dev}
@@ -16,10 +16,14 @@ C++ create_table: Example and Test
 {xrst_end create_table_xam.cpp}
 */
 // BEGIN C++
+# include <cmath>
+# include <limits>
 # include <dismod_at/create_table.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
 # include <dismod_at/open_connection.hpp>
 # include <dismod_at/get_covariate_table.hpp>
+# include <dismod_at/get_table_column.hpp>
+# include <dismod_at/null_int.hpp>
 
 bool create_table_xam(void)
 {
@@ -79,6 +83,64 @@ bool create_table_xam(void)
     ok  &= covariate_table[1].covariate_name == "weight";
     ok  &= covariate_table[1].reference      == 100.;
     ok  &= covariate_table[1].max_difference == 200;
+    // ----------------------------------------------------------------------
+    // create a table using typed column values
+    table_name = "typed";
+    col_name[0]     = "name";
+    col_type[0]     = "text";
+    col_unique[0]   = false;
+    //
+    col_name[1]     = "count";
+    col_type[1]     = "integer";
+    col_unique[1]   = false;
+    //
+    col_name[2]     = "value";
+    col_type[2]     = "real";
+    col_unique[2]   = false;
+    //
+    n_row = 3;
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    vector<dismod_at::column_value_struct> col_value(n_col);
+    col_value[0].text_value = { "one", "it's", "three" };
+    col_value[1].int_value  = { 1, DISMOD_AT_NULL_INT, -3 };
+    col_value[2].real_value = { 1.0 / 3.0, 2e-300, nan };
+    dismod_at::create_table(
+        db, table_name, col_name, col_type, col_unique, col_value
+    );
+    //
+    // check the typed table
+    vector<string> text_result;
+    vector<int>    int_result;
+    vector<double> real_result;
+    dismod_at::get_table_column(db, table_name, "name",  text_result);
+    dismod_at::get_table_column(db, table_name, "count", int_result);
+    dismod_at::get_table_column(db, table_name, "value", real_result);
+    ok &= text_result.size() == n_row;
+    ok &= int_result.size()  == n_row;
+    ok &= real_result.size() == n_row;
+    for(size_t i = 0; i < n_row; ++i)
+    {   ok &= text_result[i] == col_value[0].text_value[i];
+        ok &= int_result[i]  == col_value[1].int_value[i];
+    }
+    ok &= real_result[0] == col_value[2].real_value[0];
+    ok &= real_result[1] == col_value[2].real_value[1];
+    ok &= std::isnan( real_result[2] );
+    // ----------------------------------------------------------------------
+    // append rows to the typed table
+    size_t first_id = n_row;
+    col_value[0].text_value = { "four", "five" };
+    col_value[1].int_value  = { 4, 5 };
+    col_value[2].real_value = { 4.0, 5.0 };
+    dismod_at::insert_table(
+        db, table_name, col_name, col_type, col_value, first_id
+    );
+    //
+    // check the appended rows
+    int_result.resize(0);
+    dismod_at::get_table_column(db, table_name, "count", int_result);
+    ok &= int_result.size() == n_row + 2;
+    ok &= int_result[n_row]     == 4;
+    ok &= int_result[n_row + 1] == 5;
     //
     // close database and return
     sqlite3_close(db);
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin db_input_cache_xam.cpp dev}
+
+C++ db_input_cache: Example and Test
+####################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end db_input_cache_xam.cpp}
+*/
+// BEGIN C++
+# include <dismod_at/db_input_cache.hpp>
+# include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/open_connection.hpp>
+
+bool db_input_cache_xam(void)
+{   bool   ok = true;
+    using  std::string;
+    //
+    // db
+    string   file_name = "example.db";
+    bool     new_file  = true;
+    sqlite3* db        = dismod_at::open_connection(file_name, new_file);
+    //
+    // age table
+    const char* sql_cmd[] = {
+        "create table age(age_id integer primary key, age real)",
+        "insert into age values(0, 0.0)",
+        "insert into age values(1, 100.0)"
+    };
+    size_t n_command = sizeof(sql_cmd) / sizeof(sql_cmd[0]);
+    for(size_t i = 0; i < n_command; i++)
+        dismod_at::exec_sql_cmd(db, sql_cmd[i]);
+    //
+    // db_input
+    // (only some of the tables are not empty for this example)
+    dismod_at::db_input_struct db_input;
+    db_input.age_table = { 0.0, 100.0 };
+    db_input.option_table.resize(1);
+    db_input.option_table[0].option_name  = "rate_case";
+    db_input.option_table[0].option_value = "iota_pos_rho_zero";
+    db_input.node_table.resize(2);
+    db_input.node_table[0].node_name = "world";
+    db_input.node_table[0].parent    = -1;
+    db_input.node_table[1].node_name = "";
+    db_input.node_table[1].parent    = 0;
+    db_input.density_table = { dismod_at::gaussian_enum };
+    db_input.nslist_table  = { "first", "second" };
+    db_input.data_table.resize(1);
+    db_input.data_table[0].node_id    = 1;
+    db_input.data_table[0].meas_value = 0.5;
+    //
+    // no db_input_cache table yet
+    dismod_at::db_input_struct check;
+    ok &= ! dismod_at::read_db_input_cache(db, check);
+    //
+    // write and read the snapshot
+    dismod_at::write_db_input_cache(db, db_input);
+    ok &= dismod_at::read_db_input_cache(db, check);
+    ok &= check.age_table.size() == 2;
+    ok &= check.age_table[1] == 100.0;
+    ok &= check.option_table.size() == 1;
+    ok &= check.option_table[0].option_value == "iota_pos_rho_zero";
+    ok &= check.node_table.size() == 2;
+    ok &= check.node_table[0].node_name == "world";
+    ok &= check.node_table[1].node_name == "";
+    ok &= check.node_table[1].parent == 0;
+    ok &= check.density_table.size() == 1;
+    ok &= check.density_table[0] == dismod_at::gaussian_enum;
+    ok &= check.nslist_table.size() == 2;
+    ok &= check.nslist_table[1] == "second";
+    ok &= check.data_table.size() == 1;
+    ok &= check.data_table[0].meas_value == 0.5;
+    ok &= check.time_table.size() == 0;
+    //
+    // the snapshot is not used when an input table changes
+    dismod_at::exec_sql_cmd(db, "update age set age = 90.0 where age_id = 1");
+    dismod_at::db_input_struct empty;
+    ok &= ! dismod_at::read_db_input_cache(db, empty);
+    ok &= empty.age_table.size() == 0;
+    ok &= empty.option_table.size() == 0;
+    //
+    // the snapshot is not used when its check sum is wrong
+    db_input.age_table[1] = 90.0;
+    dismod_at::write_db_input_cache(db, db_input);
+    check = dismod_at::db_input_struct();
+    ok &= dismod_at::read_db_input_cache(db, check);
+    dismod_at::exec_sql_cmd(db,
+        "update db_input_cache set snapshot = "
+        "substr(snapshot, 1, length(snapshot) - 1)"
+    );
+    ok &= ! dismod_at::read_db_input_cache(db, empty);
+    //
+    // transfer db_input without using the database
+    std::string snapshot = dismod_at::db_input2snapshot(db_input);
+    check = dismod_at::db_input_struct();
+    ok &= dismod_at::snapshot2db_input(
+        snapshot.data(), snapshot.size(), check
+    );
+    ok &= check.age_table.size() == 2;
+    ok &= check.age_table[1] == 90.0;
+    ok &= check.node_table[0].node_name == "world";
+    snapshot[snapshot.size() / 2] ^= 1;
+    ok &= ! dismod_at::snapshot2db_input(
+        snapshot.data(), snapshot.size(), empty
+    );
+    ok &= empty.age_table.size() == 0;
+    //
+    // the key only depends on the input tables
+    std::string key = dismod_at::db_input_cache_key(db);
+    ok &= key.size() == 16;
+    ok &= key == dismod_at::db_input_cache_key(db);
+    dismod_at::exec_sql_cmd(db, "update age set age = 80.0 where age_id = 1");
+    ok &= key != dismod_at::db_input_cache_key(db);
+    //
+    // close database and return
+    sqlite3_close(db);
+    return ok;
+}
+// END C++
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-25 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin get_option_table_xam.cpp dev}
@@ -50,6 +50,8 @@ bool get_option_table_xam(void)
         { "bound_random",                     "3.0" },
         { "compress_interval",                "0 0" },
         { "data_extra_columns",               "" },
+        { "db_input_cache",                   "true" },
+        { "db_profile",                       "bulk" },
         { "derivative_test_fixed",            "second-order" },
         { "derivative_test_random",           "first-order" },
         { "hold_out_integrand",               "" },
@@ -62,12 +64,16 @@ bool get_option_table_xam(void)
         { "other_input_table",                "" },
         { "parent_node_id",                   "1" },
         { "parent_node_name",                 "north_america" },
+        { "predict_quantile",                 "0.1 0.9" },
         { "print_level_fixed",                "5" },
         { "print_level_random",               "5" },
         { "quasi_fixed",                      "false" },
         { "random_seed",                      "123" },
         { "rate_case",                        "iota_zero_rho_zero" },
         { "splitting_covariate",              "" },
+        { "tape_by_child",                    "true" },
+        { "tape_cache",                       "true" },
+        { "thread_count",                     "4" },
         { "tolerance_fixed",                  "1e-7" },
         { "tolerance_random",                 "1e-7" },
         { "trace_init_fit_model",             "false" },
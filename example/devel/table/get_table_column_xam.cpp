@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin get_table_column_xam.cpp dev}
@@ -16,6 +16,7 @@ C++ get_table_column_xam: Example and Test
 {xrst_end get_table_column_xam.cpp}
 */
 // BEGIN C++
+# include <cmath>
 # include <dismod_at/get_table_column.hpp>
 # include <dismod_at/exec_sql_cmd.hpp>
 # include <dismod_at/open_connection.hpp>
@@ -36,7 +37,8 @@ bool get_table_column_xam(void)
             " mytable_text  text, "
             " mytable_real  real);",
         "insert into  mytable values(1,    'one',         1.0);"
-        "insert into  mytable values(0,    'zero',        0.0);",
+        "insert into  mytable values(0,    'zero',        0.0);"
+        "insert into  mytable values(2,    null,          null);",
     };
     size_t n_command = sizeof(sql_cmd) / sizeof(sql_cmd[0]);
     for(size_t i = 0; i < n_command; i++)
@@ -57,6 +59,8 @@ bool get_table_column_xam(void)
     ok &= column_type   == "integer";
     ok &= int_result[0] == 0;
     ok &= int_result[1] == 1;
+    ok &= int_result[2] == 2;
+    ok &= int_result.size() == 3;
 
     // text
     column_name = "mytable_text";
@@ -70,6 +74,7 @@ bool get_table_column_xam(void)
     ok &= column_type    == "text";
     ok &= text_result[0] == "zero";
     ok &= text_result[1] == "one";
+    ok &= text_result[2] == "";
 
     // real
     column_name = "mytable_real";
@@ -83,6 +88,27 @@ bool get_table_column_xam(void)
     ok &= column_type    == "real";
     ok &= real_result[0] == 0.0;
     ok &= real_result[1] == 1.0;
+    ok &= std::isnan( real_result[2] );
+
+    // range of rows: first_id <= mytable_id < end_id
+    size_t first_id = 1;
+    size_t end_id   = 3;
+    real_result.resize(0);
+    dismod_at::get_table_column(
+        db, table_name, column_name, first_id, end_id, real_result
+    );
+    ok &= real_result.size() == 2;
+    ok &= real_result[0] == 1.0;
+    ok &= std::isnan( real_result[1] );
+    //
+    column_name = "mytable_id";
+    int_result.resize(0);
+    dismod_at::get_table_column(
+        db, table_name, column_name, first_id, end_id, int_result
+    );
+    ok &= int_result.size() == 2;
+    ok &= int_result[0] == 1;
+    ok &= int_result[1] == 2;
 
     // check return value when column does not exist
     column_name = "bad_column_name";
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin set_db_profile_xam.cpp dev}
+
+C++ set_db_profile: Example and Test
+####################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end set_db_profile_xam.cpp}
+*/
+// BEGIN C++
+# include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/open_connection.hpp>
+# include <dismod_at/set_db_profile.hpp>
+
+bool set_db_profile_xam(void)
+{   bool   ok = true;
+    using std::string;
+    //
+    string   file_name = "example.db";
+    bool     new_file  = true;
+    sqlite3* db        = dismod_at::open_connection(file_name, new_file);
+    char     sep       = ',';
+    //
+    // default: sqlite settings are not changed
+    dismod_at::set_db_profile(db, "default");
+    string result = dismod_at::exec_sql_cmd(db, "pragma journal_mode", sep);
+    ok &= result == "delete\n";
+    result = dismod_at::exec_sql_cmd(db, "pragma temp_store", sep);
+    ok &= result == "0\n";
+    //
+    // bulk
+    dismod_at::set_db_profile(db, "bulk");
+    result = dismod_at::exec_sql_cmd(db, "pragma journal_mode", sep);
+    ok &= result == "wal\n";
+    result = dismod_at::exec_sql_cmd(db, "pragma synchronous", sep);
+    ok &= result == "1\n";
+    result = dismod_at::exec_sql_cmd(db, "pragma cache_size", sep);
+    ok &= result == "-262144\n";
+    result = dismod_at::exec_sql_cmd(db, "pragma temp_store", sep);
+    ok &= result == "2\n";
+    //
+    // the journal mode is stored in the database file
+    sqlite3_close(db);
+    new_file = false;
+    db       = dismod_at::open_connection(file_name, new_file);
+    result   = dismod_at::exec_sql_cmd(db, "pragma journal_mode", sep);
+    ok &= result == "wal\n";
+    result = dismod_at::exec_sql_cmd(db, "pragma temp_store", sep);
+    ok &= result == "0\n";
+    //
+    // change back to a rollback journal so other examples are not affected
+    dismod_at::exec_sql_cmd(db, "pragma journal_mode = delete");
+    sqlite3_close(db);
+    //
+    return ok;
+}
+// END C++
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin tape_cache_xam.cpp dev}
+
+C++ tape_cache: Example and Test
+################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end tape_cache_xam.cpp}
+*/
+// BEGIN C++
+# include <dismod_at/tape_cache.hpp>
+# include <dismod_at/exec_sql_cmd.hpp>
+# include <dismod_at/open_connection.hpp>
+
+bool tape_cache_xam(void)
+{   bool   ok = true;
+    using  std::string;
+    using  CppAD::vector;
+    //
+    // db
+    string   file_name = "example.db";
+    bool     new_file  = true;
+    sqlite3* db        = dismod_at::open_connection(file_name, new_file);
+    //
+    // age, option, data_sim, and prior_sim tables
+    const char* sql_cmd[] = {
+        "create table age(age_id integer primary key, age real)",
+        "insert into age values(0, 0.0)",
+        "insert into age values(1, 100.0)",
+        "create table option(option_id integer primary key,"
+            " option_name text unique, option_value text)",
+        "insert into option values(0, 'rate_case', 'iota_pos_rho_zero')",
+        "insert into option values(1, 'max_num_iter_fixed', '100')",
+        "create table data_sim(data_sim_id integer primary key,"
+            " simulate_index integer, data_subset_id integer,"
+            " data_sim_value real)",
+        "insert into data_sim values(0, 0, 0, 1.0)",
+        "insert into data_sim values(1, 1, 0, 2.0)",
+        "create table prior_sim(prior_sim_id integer primary key,"
+            " simulate_index integer, var_id integer,"
+            " prior_sim_value real, prior_sim_dage real, prior_sim_dtime real)",
+        "insert into prior_sim values(0, 0, 0, 1.0, null, null)",
+        "insert into prior_sim values(1, 1, 0, 2.0, null, null)"
+    };
+    size_t n_command = sizeof(sql_cmd) / sizeof(sql_cmd[0]);
+    for(size_t i = 0; i < n_command; i++)
+        dismod_at::exec_sql_cmd(db, sql_cmd[i]);
+    //
+    // key_1, check_1
+    int simulate_index = -1;
+    vector<double> value = { 1.0, 2.0 };
+    string check_1, check;
+    string key_1 =
+        dismod_at::tape_cache_key(db, simulate_index, value, check_1);
+    ok &= key_1 == dismod_at::tape_cache_key(db, simulate_index, value, check);
+    ok &= check_1 == check;
+    ok &= check_1.size() == 32;
+    //
+    // no tape_cache table yet
+    vector<string> tape;
+    ok &= ! dismod_at::read_tape_cache(db, key_1, check_1, tape);
+    ok &= tape.size() == 0;
+    //
+    // write and read tapes for key_1
+    vector<string> tape_1 = { "first tape", "second tape" };
+    dismod_at::write_tape_cache(db, key_1, check_1, tape_1);
+    ok &= dismod_at::read_tape_cache(db, key_1, check_1, tape);
+    ok &= tape.size() == 2;
+    ok &= tape[0] == tape_1[0];
+    ok &= tape[1] == tape_1[1];
+    //
+    // the tapes are not used when the check_key does not agree
+    tape.clear();
+    ok &= ! dismod_at::read_tape_cache(db, key_1, "other check", tape);
+    ok &= tape.size() == 0;
+    //
+    // key_2: changes when the value vector changes
+    value[1]     = 3.0;
+    string check_2;
+    string key_2 =
+        dismod_at::tape_cache_key(db, simulate_index, value, check_2);
+    ok &= key_2 != key_1;
+    ok &= check_2 != check_1;
+    tape.clear();
+    ok &= ! dismod_at::read_tape_cache(db, key_2, check_2, tape);
+    //
+    // key_3: changes when an input table changes
+    value[1] = 2.0;
+    dismod_at::exec_sql_cmd(db, "update age set age = 90.0 where age_id = 1");
+    string check_3;
+    string key_3 =
+        dismod_at::tape_cache_key(db, simulate_index, value, check_3);
+    ok &= key_3 != key_1;
+    //
+    // replace the tapes for key_1 (does not change other keys)
+    vector<string> tape_3 = { "third tape" };
+    dismod_at::write_tape_cache(db, key_3, check_3, tape_3);
+    tape_1[0] = "new first tape";
+    dismod_at::write_tape_cache(db, key_1, check_1, tape_1);
+    tape.clear();
+    ok &= dismod_at::read_tape_cache(db, key_1, check_1, tape);
+    ok &= tape.size() == 2;
+    ok &= tape[0] == "new first tape";
+    tape.clear();
+    ok &= dismod_at::read_tape_cache(db, key_3, check_3, tape);
+    ok &= tape.size() == 1;
+    ok &= tape[0] == tape_3[0];
+    //
+    // options that do not affect the model do not change the key
+    string key_4 = dismod_at::tape_cache_key(db, simulate_index, value, check);
+    dismod_at::exec_sql_cmd(db,
+        "update option set option_value = '50' where option_id = 1"
+    );
+    ok &= key_4 == dismod_at::tape_cache_key(db, simulate_index, value, check);
+    dismod_at::exec_sql_cmd(db,
+        "update option set option_value = 'iota_pos_rho_pos'"
+        " where option_id = 0"
+    );
+    ok &= key_4 != dismod_at::tape_cache_key(db, simulate_index, value, check);
+    //
+    // only the simulated values for simulate_index affect the key
+    simulate_index = 0;
+    string key_5 = dismod_at::tape_cache_key(db, simulate_index, value, check);
+    dismod_at::exec_sql_cmd(db,
+        "update data_sim set data_sim_value = 3.0 where data_sim_id = 1"
+    );
+    ok &= key_5 == dismod_at::tape_cache_key(db, simulate_index, value, check);
+    dismod_at::exec_sql_cmd(db,
+        "update prior_sim set prior_sim_value = 3.0 where prior_sim_id = 0"
+    );
+    ok &= key_5 != dismod_at::tape_cache_key(db, simulate_index, value, check);
+    //
+    // no key when the input tables are in another database
+    dismod_at::exec_sql_cmd(db,
+        "insert into option values(2, 'other_database', 'other.db')"
+    );
+    ok &= dismod_at::tape_cache_key(db, simulate_index, value, check) == "";
+    //
+    // close database and return
+    sqlite3_close(db);
+    return ok;
+}
+// END C++
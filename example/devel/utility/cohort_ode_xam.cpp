@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin cohort_ode_xam.cpp dev}
@@ -59,7 +59,8 @@ bool cohort_ode_xam(void)
     // call cohort_ode
     Float  pini   = 0.2;
     vector<Float> s_out(n), c_out(n);
-    std::string rate_case = "iota_pos_rho_pos";
+    dismod_at::rate_case_enum rate_case =
+        dismod_at::rate_case2enum("iota_pos_rho_pos");
     dismod_at::cohort_ode(
         rate_case, age, pini, iota, rho, chi, omega, s_out, c_out
     );
@@ -78,6 +79,58 @@ bool cohort_ode_xam(void)
     // very accurate because rates are linear w.r.t age
     ok &= fabs( 1.0 - s_out[n-1] / yf[0] ) < 1e-10;
     ok &= fabs( 1.0 - c_out[n-1] / yf[1] ) < 1e-10;
+    // ----------------------------------------------------------------------
+    // use the checkpoint function for each step of the ODE
+    dismod_at::cohort_ode_checkpoint(rate_case);
+    //
+    // f(pini) = ( s_out[n-1], c_out[n-1] )
+    vector<Float> ax(1), ay(2);
+    ax[0] = 0.2;
+    CppAD::Independent(ax);
+    dismod_at::cohort_ode(
+        rate_case, age, ax[0], iota, rho, chi, omega, s_out, c_out
+    );
+    ay[0] = s_out[n-1];
+    ay[1] = c_out[n-1];
+    CppAD::ADFun<double> f(ax, ay);
+    //
+    // g(pini) = f(pini) computed using double
+    vector<double> d_iota(n), d_rho(n), d_chi(n), d_omega(n);
+    vector<double> d_s_out(n), d_c_out(n);
+    for(size_t k = 0; k < n; ++k)
+    {   d_iota[k]  = Value( iota[k] );
+        d_rho[k]   = Value( rho[k] );
+        d_chi[k]   = Value( chi[k] );
+        d_omega[k] = Value( omega[k] );
+    }
+    auto g = [&](double d_pini, vector<double>& d_y)
+    {   dismod_at::cohort_ode(
+            rate_case, age, d_pini,
+            d_iota, d_rho, d_chi, d_omega, d_s_out, d_c_out
+        );
+        d_y[0] = d_s_out[n-1];
+        d_y[1] = d_c_out[n-1];
+    };
+    //
+    // check function values
+    vector<double> x(1), y(2), check(2);
+    x[0] = 0.3;
+    y    = f.Forward(0, x);
+    g(x[0], check);
+    double eps99 = 99.0 * std::numeric_limits<double>::epsilon();
+    ok  &= CppAD::NearEqual(y[0], check[0], eps99, eps99);
+    ok  &= CppAD::NearEqual(y[1], check[1], eps99, eps99);
+    //
+    // check derivatives
+    double step = 1e-4;
+    vector<double> y_plus(2), y_minus(2);
+    g(x[0] + step, y_plus);
+    g(x[0] - step, y_minus);
+    vector<double> dy = f.Jacobian(x);
+    for(size_t i = 0; i < 2; ++i)
+    {   double diff = (y_plus[i] - y_minus[i]) / (2.0 * step);
+        ok &= fabs( dy[i] - diff ) < 1e-7;
+    }
     //
     return ok;
 }
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin p2_quantile_xam.cpp dev}
+
+C++ p2_quantile: Example and Test
+#################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end p2_quantile_xam.cpp}
+*/
+// BEGIN C++
+# include <cmath>
+# include <dismod_at/p2_quantile.hpp>
+
+bool p2_quantile_xam(void)
+{   bool   ok = true;
+    //
+    // lower, median, upper
+    dismod_at::p2_quantile lower(0.1), median(0.5), upper(0.9);
+    ok &= std::isnan( median.value() );
+    ok &= median.count() == 0;
+    //
+    // less than five observations: exact quantiles
+    double x[] = { 3.0, 1.0, 2.0 };
+    for(size_t i = 0; i < 3; ++i)
+    {   lower.add( x[i] );
+        median.add( x[i] );
+        upper.add( x[i] );
+    }
+    ok &= median.count() == 3;
+    ok &= median.value() == 2.0;
+    ok &= std::fabs( lower.value() - 1.2 ) < 1e-12;
+    ok &= std::fabs( upper.value() - 2.8 ) < 1e-12;
+    //
+    // n_obs
+    // observations are a permutation of 0, ..., n_obs - 1
+    size_t n_obs = 10007;
+    size_t step  = 1237;
+    size_t index = 0;
+    dismod_at::p2_quantile p10(0.1), p50(0.5), p90(0.9);
+    for(size_t k = 0; k < n_obs; ++k)
+    {   index = (index + step) % n_obs;
+        p10.add( double(index) );
+        p50.add( double(index) );
+        p90.add( double(index) );
+    }
+    ok &= p50.count() == n_obs;
+    //
+    // check estimates within one percent of the range of observations
+    double tol = 0.01 * double(n_obs);
+    ok &= std::fabs( p10.value() - 0.1 * double(n_obs) ) < tol;
+    ok &= std::fabs( p50.value() - 0.5 * double(n_obs) ) < tol;
+    ok &= std::fabs( p90.value() - 0.9 * double(n_obs) ) < tol;
+    //
+    return ok;
+}
+// END C++
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin process_team_xam.cpp dev}
+
+C++ process_team: Example and Test
+##################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end process_team_xam.cpp}
+*/
+// BEGIN C++
+# include <stdexcept>
+# include <unistd.h>
+# include <dismod_at/process_team.hpp>
+# include <dismod_at/error_exit.hpp>
+# include <dismod_at/log_message.hpp>
+# include <dismod_at/open_connection.hpp>
+# include <dismod_at/get_table_column.hpp>
+
+bool process_team_xam(void)
+{   bool   ok = true;
+    using  std::string;
+    //
+    // db
+    string   file_name = "example.db";
+    bool     new_file  = true;
+    sqlite3* db        = dismod_at::open_connection(file_name, new_file);
+    //
+    // n_task, n_process
+    size_t n_task    = 10;
+    size_t n_process = 3;
+    //
+    // result, error
+    CppAD::vector<string>         result;
+    dismod_at::log_message_struct error;
+    //
+    // work
+    // task 4 logs a warning
+    auto work = [&](size_t task, sqlite3* task_db)
+    {   if( task == 4 )
+            dismod_at::log_message(task_db, nullptr, "warning", "task 4");
+        return std::to_string(task * task);
+    };
+    for(size_t n = 1; n <= n_process; ++n)
+    {   size_t error_task = dismod_at::process_team(
+            db, n, n_task, work, result, error
+        );
+        ok &= error_task == n_task;
+        ok &= result.size() == n_task;
+        for(size_t task = 0; task < n_task; ++task)
+            ok &= result[task] == std::to_string(task * task);
+    }
+    //
+    // the warning was logged once for each number of processes
+    CppAD::vector<string> message;
+    dismod_at::get_table_column(db, "log", "message", message);
+    ok &= message.size() == n_process;
+    for(size_t i = 0; i < message.size(); ++i)
+        ok &= message[i] == "task 4";
+    //
+    // error_work
+    // task 5 and task 7 fail, task 5 is the first failure for any timing
+    auto error_work = [&](size_t task, sqlite3* /* task_db */)
+    {   if( task == 5 )
+            dismod_at::error_exit("task 5", "data", 5);
+        if( task == 7 )
+            throw std::runtime_error("task 7");
+        return std::to_string(task);
+    };
+    size_t error_task = dismod_at::process_team(
+        db, n_process, n_task, error_work, result, error
+    );
+    ok &= error_task == 5;
+    ok &= error.message == "task 5";
+    ok &= error.table_name == "data";
+    ok &= error.row_id == 5;
+    for(size_t task = 0; task < error_task; ++task)
+        ok &= result[task] == std::to_string(task);
+    //
+    // exit_work
+    // the process running task 2 terminates before it completes the task
+    auto exit_work = [&](size_t task, sqlite3* /* task_db */)
+    {   if( task == 2 )
+            _exit(1);
+        return std::to_string(task);
+    };
+    error_task = dismod_at::process_team(
+        db, n_process, n_task, exit_work, result, error
+    );
+    ok &= error_task == 2;
+    ok &= error.message.find("task 2") != string::npos;
+    //
+    // close database and return
+    dismod_at::log_message_finalize(db);
+    sqlite3_close(db);
+    return ok;
+}
+// END C++
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin server_request_xam.cpp dev}
+
+C++ server_request: Example and Test
+####################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end server_request_xam.cpp}
+*/
+// BEGIN C++
+# include <dismod_at/server_request.hpp>
+
+bool server_request_xam(void)
+{   bool   ok = true;
+    using  std::string;
+    //
+    string                     request, database, msg;
+    CppAD::vector<string>      command;
+    //
+    // a fit request
+    request = " { \"database\" : \"dir/example.db\" ,\n"
+        " \"command\" : [ \"fit\", \"both\" ] }\n";
+    msg = dismod_at::parse_server_request(request, database, command);
+    ok &= msg == "";
+    ok &= database == "dir/example.db";
+    ok &= command.size() == 2;
+    ok &= command[0] == "fit";
+    ok &= command[1] == "both";
+    //
+    // escapes
+    request = "{\"command\":[\"set\",\"option\",\"a\\\"b\\\\c\\u00e9\"],"
+        "\"database\":\"x.db\"}";
+    msg = dismod_at::parse_server_request(request, database, command);
+    ok &= msg == "";
+    ok &= database == "x.db";
+    ok &= command.size() == 3;
+    ok &= command[2] == "a\"b\\c\xc3\xa9";
+    //
+    // stop does not require a database
+    request = "{\"command\":[\"stop\"]}";
+    msg = dismod_at::parse_server_request(request, database, command);
+    ok &= msg == "";
+    ok &= database == "";
+    ok &= command.size() == 1;
+    //
+    // errors
+    const char* bad[] = {
+        "",
+        "{\"command\":[\"init\"]}",
+        "{\"database\":\"x.db\",\"command\":[]}",
+        "{\"database\":\"x.db\",\"command\":[\"init\"]",
+        "{\"database\":\"x.db\",\"command\":[\"init\"],\"other\":\"\"}",
+        "{\"database\":\"x.db\",\"command\":[\"init\"]} extra",
+        "{\"database\":\"x.db\",\"command\":[\"in\\qit\"]}",
+        "{\"database\":\"x.db\",\"command\":\"init\"}"
+    };
+    size_t n_bad = sizeof(bad) / sizeof(bad[0]);
+    for(size_t i = 0; i < n_bad; ++i)
+    {   msg = dismod_at::parse_server_request(bad[i], database, command);
+        ok &= msg.substr(0, 9) == "request: ";
+    }
+    //
+    // json_string
+    ok &= dismod_at::json_string("a\"b\\c\nd\x01") ==
+        "\"a\\\"b\\\\c\\nd\\u0001\"";
+    //
+    // json_string followed by parse_server_request
+    string value = "\"quote\" \\ \t tab";
+    request  = "{\"database\":" + dismod_at::json_string(value);
+    request += ",\"command\":[\"init\"]}";
+    msg = dismod_at::parse_server_request(request, database, command);
+    ok &= msg == "";
+    ok &= database == value;
+    //
+    return ok;
+}
+// END C++
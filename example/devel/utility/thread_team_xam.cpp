@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin thread_team_xam.cpp dev}
+
+C++ thread_team: Example and Test
+#################################
+
+{xrst_literal
+    // BEGIN C++
+    // END C++
+}
+
+{xrst_end thread_team_xam.cpp}
+*/
+// BEGIN C++
+# include <atomic>
+# include <string>
+# include <stdexcept>
+# include <cppad/utility/vector.hpp>
+# include <dismod_at/thread_team.hpp>
+
+bool thread_team_xam(void)
+{   bool   ok = true;
+    //
+    // n_task, n_thread
+    size_t n_task   = 100;
+    size_t n_thread = 4;
+    //
+    // result
+    // allocated in sequential mode, each element set by one thread
+    CppAD::vector<double> result(n_task);
+    //
+    // work
+    std::atomic<size_t> next_task(0);
+    auto work = [&](size_t /* thread */)
+    {   // temporary work space for this thread
+        CppAD::vector<double> temp;
+        for(size_t task = next_task++; task < n_task; task = next_task++)
+        {   temp.resize(task + 1);
+            for(size_t i = 0; i <= task; ++i)
+                temp[i] = double(i);
+            double sum = 0.0;
+            for(size_t i = 0; i <= task; ++i)
+                sum += temp[i];
+            result[task] = sum;
+        }
+    };
+    dismod_at::thread_team(n_thread, work);
+    //
+    // check result
+    for(size_t task = 0; task < n_task; ++task)
+        ok &= result[task] == double(task * (task + 1) / 2);
+    //
+    // exception thrown by one of the threads
+    next_task = 0;
+    auto error_work = [&](size_t thread)
+    {   if( thread == n_thread - 1 )
+            throw std::runtime_error("thread_team_xam");
+    };
+    bool caught = false;
+    try
+    {   dismod_at::thread_team(n_thread, error_work);
+    }
+    catch(const std::runtime_error& e)
+    {   caught = std::string( e.what() ) == "thread_team_xam";
+    }
+    ok &= caught;
+    //
+    // one thread
+    next_task = 0;
+    for(size_t task = 0; task < n_task; ++task)
+        result[task] = 0.0;
+    dismod_at::thread_team(1, work);
+    for(size_t task = 0; task < n_task; ++task)
+        ok &= result[task] == double(task * (task + 1) / 2);
+    //
+    return ok;
+}
+// END C++
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 /*
 {xrst_begin time_line_vec_xam.cpp dev}
@@ -89,27 +89,33 @@ bool time_line_vec_xam(void)
     point_10.weight = 2.0;
     point_10.value  = 4.0;
     point_11.time   = time_upper;
-    point_10.weight = 3.0;
+    point_11.weight = 3.0;
     point_11.value  = 5.0;
     vec.add_point(sub_lower+1, point_11); // add second point first time
     vec.add_point(sub_lower+1, point_10); // add second point second time
     //
     // check first time line
-    CppAD::vector<time_point> time_line_0 = vec.time_line(sub_lower);
-    ok &= time_line_0.size()    == 1;
-    ok &= time_line_0[0].time   == point_00.time;
-    ok &= time_line_0[0].weight == point_00.weight;
-    ok &= time_line_0[0].value  == point_00.value;
+    size_t        n_time_0 = vec.line_size(sub_lower);
+    const double* time_0   = vec.line_time(sub_lower);
+    const double* weight_0 = vec.line_weight(sub_lower);
+    const double* value_0  = vec.line_value(sub_lower);
+    ok &= n_time_0    == 1;
+    ok &= time_0[0]   == point_00.time;
+    ok &= weight_0[0] == point_00.weight;
+    ok &= value_0[0]  == point_00.value;
     //
     // check second time line
-    CppAD::vector<time_point> time_line_1 = vec.time_line(sub_lower+1);
-    ok &= time_line_1.size()    == 2;
-    ok &= time_line_1[0].time   == point_10.time;
-    ok &= time_line_1[0].weight == point_10.weight;
-    ok &= time_line_1[0].value  == point_10.value;
-    ok &= time_line_1[1].time   == point_11.time;
-    ok &= time_line_1[1].weight == point_11.weight;
-    ok &= time_line_1[1].value  == point_11.value;
+    size_t        n_time_1 = vec.line_size(sub_lower+1);
+    const double* time_1   = vec.line_time(sub_lower+1);
+    const double* weight_1 = vec.line_weight(sub_lower+1);
+    const double* value_1  = vec.line_value(sub_lower+1);
+    ok &= n_time_1    == 2;
+    ok &= time_1[0]   == point_10.time;
+    ok &= weight_1[0] == point_10.weight;
+    ok &= value_1[0]  == point_10.value;
+    ok &= time_1[1]   == point_11.time;
+    ok &= weight_1[1] == point_11.weight;
+    ok &= value_1[1]  == point_11.value;
     // --------------------------------------------------------------------
     // add another point to the first line
     time_point point_01;
@@ -0,0 +1,288 @@
+# SPDX-License-Identifier: AGPL-3.0-or-later
+# SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+# SPDX-FileContributor: 2014-26 Bradley M. Bell
+# ----------------------------------------------------------------------------
+# {xrst_begin user_batch.py}
+# {xrst_spell
+#     exp
+# }
+# {xrst_comment_ch #}
+#
+# Running a Sequence of Commands in Batch Mode
+# ############################################
+#
+# Purpose
+# *******
+# This example demonstrates using the command
+#
+# | |tab| ``dismod_at`` *database* ``batch`` *batch_file*
+#
+# to run the commands in :ref:`user_fit_fixed_both.py-name`
+# using one connection to the database; see
+# :ref:`command@Batch Mode` .
+#
+# Discussion
+# **********
+# #. The database is the same as in :ref:`user_fit_fixed_both.py-name` .
+# #. The batch file contains the commands
+#    ``init`` , ``fit fixed`` , ``set start_var fit_var`` , ``fit both`` .
+# #. The same commands are also run one at a time on a copy of the database.
+#    The resulting :ref:`fit_var_table-name` values are the same.
+# #. Each command in the batch has its own begin and end message
+#    in the :ref:`log_table-name` .
+#
+# Source Code
+# ***********
+# {xrst_literal
+#     BEGIN PYTHON
+#     END PYTHON
+# }
+#
+# {xrst_end user_batch.py}
+# ---------------------------------------------------------------------------
+# BEGIN PYTHON
+# ------------------------------------------------------------------------
+iota_parent_true            = 1e-2
+united_states_random_effect = +0.5
+# ------------------------------------------------------------------------
+import sys
+import os
+import copy
+from math import exp
+test_program  = 'example/user/batch.py'
+check_program = sys.argv[0].replace('\\', '/')
+if check_program != test_program  or len(sys.argv) != 1 :
+    usage  = 'python3 ' + test_program + '\n'
+    usage += 'where python3 is the python 3 program on your system\n'
+    usage += 'and working directory is the dismod_at distribution directory\n'
+    sys.exit(usage)
+print(test_program)
+#
+# import dismod_at
+local_dir = os.getcwd() + '/python'
+if( os.path.isdir( local_dir + '/dismod_at' ) ) :
+    sys.path.insert(0, local_dir)
+import dismod_at
+#
+# change into the build/example/user directory
+if not os.path.exists('build/example/user') :
+    os.makedirs('build/example/user')
+os.chdir('build/example/user')
+# ------------------------------------------------------------------------
+# Note that the a, t values are not used for this example
+def example_db (file_name) :
+    def fun_iota_child(a, t) :
+        return ('prior_iota_child', None, 'prior_child_diff')
+    def fun_iota_parent(a, t) :
+        return ('prior_iota_parent', None, 'prior_parent_diff')
+    import dismod_at
+    # ----------------------------------------------------------------------
+    # age table
+    age_list    = [    0.0, 50.0,    100.0 ]
+    #
+    # time table
+    time_list   = [ 1995.0, 2005.0, 2015.0 ]
+    #
+    # integrand table
+    integrand_table = [
+        { 'name':'Sincidence' }
+    ]
+    #
+    # node table: world -> north_america
+    #             north_america -> (united_states, canada)
+    node_table = [
+        { 'name':'world',         'parent':'' },
+        { 'name':'north_america', 'parent':'world' },
+        { 'name':'united_states', 'parent':'north_america' },
+        { 'name':'canada',        'parent':'north_america' }
+    ]
+    #
+    # weight table:
+    weight_table = list()
+    #
+    # covariate table: no covariates
+    covariate_table = list()
+    #
+    # mulcov table
+    mulcov_table = list()
+    #
+    # avgint table:
+    avgint_table = list()
+    #
+    # nslist_dict:
+    nslist_dict = dict()
+    # ----------------------------------------------------------------------
+    # data table:
+    data_table = list()
+    # write out data
+    row = {
+        'density':     'gaussian',
+        'weight':      '',
+        'hold_out':     False,
+        'time_lower':   2000.0,
+        'time_upper':   2000.0,
+        'age_lower':    50.0,
+        'age_upper':    50.0,
+        'integrand':    'Sincidence',
+    }
+    row['node']        = 'north_america'
+    row['meas_value']  = iota_parent_true
+    row['meas_std']    = row['meas_value'] * 1e-1
+    data_table.append( copy.copy(row) )
+    row['node']        = 'united_states'
+    row['meas_value']  = iota_parent_true * exp(+ united_states_random_effect)
+    row['meas_std']    = row['meas_value'] * 1e-1
+    data_table.append( copy.copy(row) )
+    row['node']        = 'canada'
+    row['meas_value']  = iota_parent_true * exp(- united_states_random_effect)
+    data_table.append( copy.copy(row) )
+    # ----------------------------------------------------------------------
+    # prior_table
+    prior_table = [
+        { # prior_iota_parent
+            'name':     'prior_iota_parent',
+            'density':  'uniform',
+            'lower':    iota_parent_true * 1e-2,
+            'upper':    iota_parent_true * 1e+2,
+            'mean':     iota_parent_true * 2.0
+        },{ # prior_iota_child
+            'name':     'prior_iota_child',
+            'density':  'gaussian',
+            'mean':     0.0,
+            'std':      100.0, # very large so like a uniform distribution
+        },{ # prior_parent_diff
+            'name':     'prior_parent_diff',
+            'density':  'log_gaussian',
+            'mean':     0.0,
+            'std':      0.1,
+            'eta':      1e-8
+        },{ # prior_child_diff
+            'name':     'prior_child_diff',
+            'density':  'gaussian',
+            'mean':     0.0,
+            'std':      0.1,
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # smooth table
+    last_time_id   = 2
+    smooth_table = [
+        { # smooth_iota_child
+            'name':                     'smooth_iota_child',
+            'age_id':                   [ 0 ],
+            'time_id':                  [ 0, last_time_id ],
+            'fun':                      fun_iota_child
+        },{ # smooth_iota_parent
+            'name':                     'smooth_iota_parent',
+            'age_id':                   [ 0 ],
+            'time_id':                  [ 0, last_time_id ],
+            'fun':                       fun_iota_parent
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # rate table
+    rate_table = [
+        {
+            'name':          'iota',
+            'parent_smooth': 'smooth_iota_parent',
+            'child_smooth':  'smooth_iota_child',
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # option_table
+    option_table = [
+        { 'name':'parent_node_name',       'value':'north_america' },
+
+        { 'name':'quasi_fixed',            'value':'true'          },
+        { 'name':'derivative_test_fixed',  'value':'first-order'   },
+        { 'name':'max_num_iter_fixed',     'value':'100'           },
+        { 'name':'tolerance_fixed',        'value':'1e-11'         },
+
+        { 'name':'derivative_test_random', 'value':'second-order'  },
+        { 'name':'max_num_iter_random',    'value':'100'           },
+        { 'name':'tolerance_random',       'value':'1e-11'         }
+    ]
+    # ----------------------------------------------------------------------
+    # subgroup_table
+    subgroup_table = [ { 'subgroup':'world', 'group':'world' } ]
+    # ----------------------------------------------------------------------
+    # create database
+    dismod_at.create_database(
+        file_name,
+        age_list,
+        time_list,
+        integrand_table,
+        node_table,
+        subgroup_table,
+        weight_table,
+        covariate_table,
+        avgint_table,
+        data_table,
+        prior_table,
+        smooth_table,
+        nslist_dict,
+        rate_table,
+        mulcov_table,
+        option_table
+    )
+    # ----------------------------------------------------------------------
+    return
+# ===========================================================================
+program      = '../../devel/dismod_at'
+command_list = [
+    [ 'init' ],
+    [ 'fit', 'fixed' ],
+    [ 'set', 'start_var', 'fit_var' ],
+    [ 'fit', 'both' ],
+]
+#
+# batch_file
+batch_file = 'batch.txt'
+file_ptr   = open(batch_file, 'w')
+file_ptr.write('# fit fixed effects and then use them as a starting point\n')
+for command in command_list :
+    file_ptr.write( ' '.join(command) + '\n' )
+file_ptr.close()
+#
+# batch.db: run the commands in batch mode
+example_db('batch.db')
+dismod_at.system_command_prc([ program, 'batch.db', 'batch', batch_file ])
+#
+# separate.db: run the commands one at a time
+example_db('separate.db')
+for command in command_list :
+    dismod_at.system_command_prc([ program, 'separate.db' ] + command )
+# -----------------------------------------------------------------------
+# fit_var_table, log_table
+fit_var_table = dict()
+log_table     = dict()
+for file_name in [ 'batch.db', 'separate.db' ] :
+    connection      = dismod_at.create_connection(
+        file_name, new = False, readonly = True
+    )
+    fit_var_table[file_name] = dismod_at.get_table_dict(connection, 'fit_var')
+    log_table[file_name]     = dismod_at.get_table_dict(connection, 'log')
+    connection.close()
+# -----------------------------------------------------------------------
+# check that batch mode gives the same fit
+n_var = len( fit_var_table['separate.db'] )
+assert n_var == 6
+assert len( fit_var_table['batch.db'] ) == n_var
+for var_id in range( n_var ) :
+    batch    = fit_var_table['batch.db'][var_id]['fit_var_value']
+    separate = fit_var_table['separate.db'][var_id]['fit_var_value']
+    assert abs( batch - separate ) <= 1e-10 * abs(separate)
+# -----------------------------------------------------------------------
+# check the log messages for the commands in the batch
+message_list = list()
+for row in log_table['batch.db'] :
+    if row['message_type'] == 'command' :
+        message_list.append( row['message'] )
+check = list()
+for command in command_list :
+    check.append( 'begin ' + ' '.join(command) )
+    check.append( 'end ' + ' '.join(command) )
+assert message_list == check
+# -----------------------------------------------------------------------
+print('batch.py: OK')
+# END PYTHON
@@ -1,6 +1,6 @@
 # SPDX-License-Identifier: AGPL-3.0-or-later
 # SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-# SPDX-FileContributor: 2014-25 Bradley M. Bell
+# SPDX-FileContributor: 2014-26 Bradley M. Bell
 # ----------------------------------------------------------------------------
 r'''
 {xrst_begin user_predict_sample.py}
@@ -18,6 +18,13 @@ The command
 
 computes a prediction for each avgint table :ref:`avgint_table@avgint_id`
 and each sample table :ref:`sample_table@sample_index` .
+The command
+
+| |tab|   ``dismod_at`` *database* ``predict sample fit_var`` *scale*
+  ``summary``
+
+computes the mean, standard deviation, and quantiles of these predictions
+for each *avgint_id* ; see :ref:`predict_summary_table-name` .
 
 Note Table
 **********
@@ -104,6 +111,7 @@ The source code below does not include the global settings defined above:
 import sys
 import os
 import copy
+import math
 #
 import random
 random.seed(random_seed)
@@ -282,6 +290,32 @@ def  main() :
     if abs(relerr) > 0.2 :
         print( f'random_seed = {random_seed}' )
         assert False, f'relerr = {relerr}'
+    #
+    # example.db: predict_summary table
+    dismod_at.system_command_prc( [
+        program, file_name, 'predict', 'sample', 'fit_var', str(scale),
+        'summary'
+    ] )
+    connection    = dismod_at.create_connection(
+        file_name, new = False, readonly = True
+    )
+    summary_table = dismod_at.get_table_dict(connection, 'predict_summary')
+    connection.close()
+    assert len(summary_table) == 1
+    #
+    # check mean and standard deviation
+    avg_integrand = [ row['avg_integrand'] for row in predict_table ]
+    mean          = sum(avg_integrand) / number_samples
+    sumsq         = sum( [ (x - mean)**2 for x in avg_integrand ] )
+    std           = math.sqrt( sumsq / (number_samples - 1) )
+    row           = summary_table[0]
+    assert abs( row['mean'] / mean - 1.0 ) < 1e-10
+    assert abs( row['std'] / std - 1.0 ) < 1e-10
+    lower  = row['quantile_0_025']
+    median = row['quantile_0_5']
+    upper  = row['quantile_0_975']
+    assert min(avg_integrand) <= lower <= median
+    assert median <= upper <= max(avg_integrand)
 #
 main()
 print('predict_sample.py: OK')
@@ -0,0 +1,318 @@
+# SPDX-License-Identifier: AGPL-3.0-or-later
+# SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+# SPDX-FileContributor: 2014-26 Bradley M. Bell
+# ----------------------------------------------------------------------------
+# {xrst_begin user_server.py}
+# {xrst_spell
+#     exp
+#     json
+# }
+# {xrst_comment_ch #}
+#
+# Running Commands Using a dismod_at Server
+# #########################################
+#
+# Purpose
+# *******
+# This example demonstrates using the command
+#
+# | |tab| ``dismod_at --server`` *socket_file*
+#
+# to run the commands in :ref:`user_fit_fixed_both.py-name` ; see
+# :ref:`command@Server Mode` .
+#
+# Discussion
+# **********
+# #. The database is the same as in :ref:`user_fit_fixed_both.py-name` .
+# #. The requests are sent using the python socket module;
+#    i.e., no other client program is needed.
+# #. The first request reads the input tables and the following
+#    requests use the copy of the input tables in the server.
+# #. A request with an invalid command returns an error message
+#    and the server continues to run.
+#
+# Source Code
+# ***********
+# {xrst_literal
+#     BEGIN PYTHON
+#     END PYTHON
+# }
+#
+# {xrst_end user_server.py}
+# ---------------------------------------------------------------------------
+# BEGIN PYTHON
+# ------------------------------------------------------------------------
+iota_parent_true            = 1e-2
+united_states_random_effect = +0.5
+# ------------------------------------------------------------------------
+import sys
+import os
+import copy
+import json
+import socket
+import subprocess
+import time
+from math import exp
+test_program  = 'example/user/server.py'
+check_program = sys.argv[0].replace('\\', '/')
+if check_program != test_program  or len(sys.argv) != 1 :
+    usage  = 'python3 ' + test_program + '\n'
+    usage += 'where python3 is the python 3 program on your system\n'
+    usage += 'and working directory is the dismod_at distribution directory\n'
+    sys.exit(usage)
+print(test_program)
+#
+# import dismod_at
+local_dir = os.getcwd() + '/python'
+if( os.path.isdir( local_dir + '/dismod_at' ) ) :
+    sys.path.insert(0, local_dir)
+import dismod_at
+#
+# change into the build/example/user directory
+if not os.path.exists('build/example/user') :
+    os.makedirs('build/example/user')
+os.chdir('build/example/user')
+# ------------------------------------------------------------------------
+# Note that the a, t values are not used for this example
+def example_db (file_name) :
+    def fun_iota_child(a, t) :
+        return ('prior_iota_child', None, 'prior_child_diff')
+    def fun_iota_parent(a, t) :
+        return ('prior_iota_parent', None, 'prior_parent_diff')
+    import dismod_at
+    # ----------------------------------------------------------------------
+    # age table
+    age_list    = [    0.0, 50.0,    100.0 ]
+    #
+    # time table
+    time_list   = [ 1995.0, 2005.0, 2015.0 ]
+    #
+    # integrand table
+    integrand_table = [
+        { 'name':'Sincidence' }
+    ]
+    #
+    # node table: world -> north_america
+    #             north_america -> (united_states, canada)
+    node_table = [
+        { 'name':'world',         'parent':'' },
+        { 'name':'north_america', 'parent':'world' },
+        { 'name':'united_states', 'parent':'north_america' },
+        { 'name':'canada',        'parent':'north_america' }
+    ]
+    #
+    # weight table:
+    weight_table = list()
+    #
+    # covariate table: no covariates
+    covariate_table = list()
+    #
+    # mulcov table
+    mulcov_table = list()
+    #
+    # avgint table:
+    avgint_table = list()
+    #
+    # nslist_dict:
+    nslist_dict = dict()
+    # ----------------------------------------------------------------------
+    # data table:
+    data_table = list()
+    # write out data
+    row = {
+        'density':     'gaussian',
+        'weight':      '',
+        'hold_out':     False,
+        'time_lower':   2000.0,
+        'time_upper':   2000.0,
+        'age_lower':    50.0,
+        'age_upper':    50.0,
+        'integrand':    'Sincidence',
+    }
+    row['node']        = 'north_america'
+    row['meas_value']  = iota_parent_true
+    row['meas_std']    = row['meas_value'] * 1e-1
+    data_table.append( copy.copy(row) )
+    row['node']        = 'united_states'
+    row['meas_value']  = iota_parent_true * exp(+ united_states_random_effect)
+    row['meas_std']    = row['meas_value'] * 1e-1
+    data_table.append( copy.copy(row) )
+    row['node']        = 'canada'
+    row['meas_value']  = iota_parent_true * exp(- united_states_random_effect)
+    data_table.append( copy.copy(row) )
+    # ----------------------------------------------------------------------
+    # prior_table
+    prior_table = [
+        { # prior_iota_parent
+            'name':     'prior_iota_parent',
+            'density':  'uniform',
+            'lower':    iota_parent_true * 1e-2,
+            'upper':    iota_parent_true * 1e+2,
+            'mean':     iota_parent_true * 2.0
+        },{ # prior_iota_child
+            'name':     'prior_iota_child',
+            'density':  'gaussian',
+            'mean':     0.0,
+            'std':      100.0, # very large so like a uniform distribution
+        },{ # prior_parent_diff
+            'name':     'prior_parent_diff',
+            'density':  'log_gaussian',
+            'mean':     0.0,
+            'std':      0.1,
+            'eta':      1e-8
+        },{ # prior_child_diff
+            'name':     'prior_child_diff',
+            'density':  'gaussian',
+            'mean':     0.0,
+            'std':      0.1,
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # smooth table
+    last_time_id   = 2
+    smooth_table = [
+        { # smooth_iota_child
+            'name':                     'smooth_iota_child',
+            'age_id':                   [ 0 ],
+            'time_id':                  [ 0, last_time_id ],
+            'fun':                      fun_iota_child
+        },{ # smooth_iota_parent
+            'name':                     'smooth_iota_parent',
+            'age_id':                   [ 0 ],
+            'time_id':                  [ 0, last_time_id ],
+            'fun':                       fun_iota_parent
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # rate table
+    rate_table = [
+        {
+            'name':          'iota',
+            'parent_smooth': 'smooth_iota_parent',
+            'child_smooth':  'smooth_iota_child',
+        }
+    ]
+    # ----------------------------------------------------------------------
+    # option_table
+    option_table = [
+        { 'name':'parent_node_name',       'value':'north_america' },
+
+        { 'name':'quasi_fixed',            'value':'true'          },
+        { 'name':'derivative_test_fixed',  'value':'first-order'   },
+        { 'name':'max_num_iter_fixed',     'value':'100'           },
+        { 'name':'tolerance_fixed',        'value':'1e-11'         },
+
+        { 'name':'derivative_test_random', 'value':'second-order'  },
+        { 'name':'max_num_iter_random',    'value':'100'           },
+        { 'name':'tolerance_random',       'value':'1e-11'         }
+    ]
+    # ----------------------------------------------------------------------
+    # subgroup_table
+    subgroup_table = [ { 'subgroup':'world', 'group':'world' } ]
+    # ----------------------------------------------------------------------
+    # create database
+    dismod_at.create_database(
+        file_name,
+        age_list,
+        time_list,
+        integrand_table,
+        node_table,
+        subgroup_table,
+        weight_table,
+        covariate_table,
+        avgint_table,
+        data_table,
+        prior_table,
+        smooth_table,
+        nslist_dict,
+        rate_table,
+        mulcov_table,
+        option_table
+    )
+    # ----------------------------------------------------------------------
+    return
+# ===========================================================================
+# request
+def request(socket_file, request_dict) :
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    client.connect(socket_file)
+    client.sendall( (json.dumps(request_dict) + '\n').encode() )
+    response = b''
+    chunk    = client.recv(4096)
+    while len(chunk) > 0 :
+        response += chunk
+        chunk     = client.recv(4096)
+    client.close()
+    return json.loads( response.decode() )
+#
+# example.db
+file_name = 'example.db'
+example_db(file_name)
+#
+# server
+program     = '../../devel/dismod_at'
+socket_file = 'server.sock'
+if os.path.exists(socket_file) :
+    os.remove(socket_file)
+server = subprocess.Popen( [ program, '--server', socket_file ] )
+for i in range(100) :
+    if not os.path.exists(socket_file) :
+        time.sleep(0.1)
+assert os.path.exists(socket_file)
+# -----------------------------------------------------------------------
+# run the commands
+command_list = [
+    [ 'init' ],
+    [ 'fit', 'fixed' ],
+    [ 'set', 'start_var', 'fit_var' ],
+    [ 'fit', 'both' ],
+]
+for (i, command) in enumerate( command_list ) :
+    response = request(socket_file,
+        { 'database' : file_name , 'command' : command }
+    )
+    assert response['status'] == 'ok'
+    if i == 0 :
+        assert response['input_cache'] == 'miss'
+    else :
+        assert response['input_cache'] == 'hit'
+#
+# an error does not stop the server
+response = request(socket_file,
+    { 'database' : file_name , 'command' : [ 'fit', 'none' ] }
+)
+assert response['status'] == 'error'
+assert response['message'] != ''
+#
+# stop the server
+response = request(socket_file, { 'command' : [ 'stop' ] } )
+assert response['status'] == 'ok'
+assert server.wait() == 0
+assert not os.path.exists(socket_file)
+# -----------------------------------------------------------------------
+# check the fit
+connection    = dismod_at.create_connection(
+    file_name, new = False, readonly = True
+)
+var_table     = dismod_at.get_table_dict(connection, 'var')
+fit_var_table = dismod_at.get_table_dict(connection, 'fit_var')
+node_table    = dismod_at.get_table_dict(connection, 'node')
+connection.close()
+n_var = len(var_table)
+assert n_var == 6
+for var_id in range( n_var ) :
+    value   = fit_var_table[var_id]['fit_var_value']
+    node_id = var_table[var_id]['node_id']
+    name    = node_table[node_id]['node_name']
+    if name == 'north_america' :
+        err = value / iota_parent_true - 1.0
+        assert( abs(err) < 1e-5 )
+    else :
+        child_optimal = united_states_random_effect
+        if name == 'canada' :
+            child_optimal = - united_states_random_effect
+        err = value / child_optimal - 1.0
+        assert( abs(err) < 1e-4 )
+# -----------------------------------------------------------------------
+print('server.py: OK')
+# END PYTHON
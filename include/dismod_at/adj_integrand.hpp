@@ -1,18 +1,22 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-23 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_ADJ_INTEGRAND_HPP
 # define DISMOD_AT_ADJ_INTEGRAND_HPP
 
+# include <map>
+# include <vector>
 # include <cppad/utility/vector.hpp>
 # include "get_integrand_table.hpp"
+# include "rate_case.hpp"
 # include "get_covariate_table.hpp"
 # include "get_subgroup_table.hpp"
 # include "pack_info.hpp"
 # include "a1_double.hpp"
 # include "weight_info.hpp"
 # include "cov2weight_map.hpp"
+# include "grid2line.hpp"
 
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
@@ -20,7 +24,7 @@ namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 class adj_integrand {
 private:
     // constants
-    const std::string&                         rate_case_;
+    const rate_case_enum                       rate_case_;
     const CppAD::vector<double>&               age_table_;
     const CppAD::vector<double>&               time_table_;
     const CppAD::vector<covariate_struct>&     covariate_table_;
@@ -35,27 +39,85 @@ private:
     // Set by constructor and effectory const
     CppAD::vector<pack_info::subvec_info>      mulcov_pack_info_;
 
-    // temporaries
-    CppAD::vector<double>                      double_mulcov_;
-    CppAD::vector<a1_double>                   a1_double_mulcov_;
+    // Each distinct age, time grid in s_info_vec_ and w_info_vec_ is a
+    // grid_index. If grid_is_weight_[grid_index] is true (false),
+    // grid_id_[grid_index] is a weight_id (smooth_id) for the grid.
+    // Set by constructor and effectively const
+    CppAD::vector<bool>                        grid_is_weight_;
+    CppAD::vector<size_t>                      grid_id_;
     //
-    CppAD::vector< CppAD::vector<double> >     double_rate_;
-    CppAD::vector< CppAD::vector<a1_double> >  a1_double_rate_;
+    // Maps each smooth_id (weight_id) to the corresponding grid_index.
+    // Set by constructor and effectively const
+    CppAD::vector<size_t>                      smooth_grid_;
+    CppAD::vector<size_t>                      weight_grid_;
+    //
+    // grid_set_[set_index][grid_index] is true if line uses the grid for
+    // the integrands that have integrand_set_[integrand_id] == set_index.
+    // Set by constructor and effectively const
+    CppAD::vector< CppAD::vector<bool> >       grid_set_;
+    CppAD::vector<size_t>                      integrand_set_;
+
+    // temporaries used by line (so it does not allocate memory)
+    template <class Float> struct line_work {
+        CppAD::vector<Float>                   smooth_value;
+        CppAD::vector<Float>                   mulcov;
+        CppAD::vector< CppAD::vector<Float> >  rate;
+        CppAD::vector< CppAD::vector<Float> >  effect_mul;
+        CppAD::vector<Float>                   effect;
+        CppAD::vector<Float>                   temp_1;
+        CppAD::vector<Float>                   temp_2;
+        CppAD::vector<Float>                   cov_grid;
+        CppAD::vector<Float>                   s_out;
+        CppAD::vector<Float>                   c_out;
+        CppAD::vector<Float>                   result;
+    };
+    line_work<double>                          double_work_;
+    line_work<a1_double>                       a1_double_work_;
+
+    // identifies one cohort in the cohort cache
+    struct cohort_key {
+        size_t              node_id;
+        size_t              child;
+        size_t              subgroup_id;
+        double              time_ini;
+        std::vector<double> x;
+        bool operator<(const cohort_key& other) const;
+    };
+    // adjusted rates and ODE solution for one cohort in the cohort cache
+    template <class Float> struct cohort_solution {
+        CppAD::vector<double>                  line_age;
+        CppAD::vector< CppAD::vector<Float> >  rate;
+        CppAD::vector< CppAD::vector<Float> >  effect_mul;
+        CppAD::vector<Float>                   s_out;
+        CppAD::vector<Float>                   c_out;
+    };
+    //
+    // is the cohort cache on
+    bool                                                 cohort_cache_on_;
+    //
+    // cohort caches (empty when cohort_cache_on_ is false)
+    std::map< cohort_key, cohort_solution<double> >     double_cohort_cache_;
+    std::map< cohort_key, cohort_solution<a1_double> >  a1_double_cohort_cache_;
 
+public:
+    // interpolation matrix for each grid_index and one line
+    typedef CppAD::vector<grid2line_csr> line_interp;
+private:
     // template version of line
     template <class Float>
-    CppAD::vector<Float> line(
+    const CppAD::vector<Float>& line(
         size_t                                    node_id          ,
         const CppAD::vector<double>&              line_age         ,
         const CppAD::vector<double>&              line_time        ,
+        const line_interp&                        interp           ,
         size_t                                    integrand_id     ,
         size_t                                    n_child          ,
         size_t                                    child            ,
         size_t                                    subgroup_id      ,
         const CppAD::vector<double>&              x                ,
         const CppAD::vector<Float>&               pack_vec         ,
-        CppAD::vector<Float>&                     mulcov           ,
-        CppAD::vector< CppAD::vector<Float> >&    rate
+        line_work<Float>&                         work             ,
+        std::map< cohort_key, cohort_solution<Float> >& cohort_cache
     );
 public:
     // adj_integrand
@@ -73,10 +135,11 @@ public:
         const pack_info&                          pack_object
     );
     // double version of line
-    CppAD::vector<double> line(
+    const CppAD::vector<double>& line(
         size_t                                    node_id          ,
         const CppAD::vector<double>&              line_age         ,
         const CppAD::vector<double>&              line_time        ,
+        const line_interp&                        interp           ,
         size_t                                    integrand_id     ,
         size_t                                    n_child          ,
         size_t                                    child            ,
@@ -85,10 +148,11 @@ public:
         const CppAD::vector<double>&              pack_vec
     );
     // a1_double version of line
-    CppAD::vector<a1_double> line(
+    const CppAD::vector<a1_double>& line(
         size_t                                    node_id          ,
         const CppAD::vector<double>&              line_age         ,
         const CppAD::vector<double>&              line_time        ,
+        const line_interp&                        interp           ,
         size_t                                    integrand_id     ,
         size_t                                    n_child          ,
         size_t                                    child            ,
@@ -96,6 +160,17 @@ public:
         const CppAD::vector<double>&              x                ,
         const CppAD::vector<a1_double>&           pack_vec
     );
+    // interp_set
+    size_t interp_set(size_t integrand_id) const;
+    // interp_line
+    void interp_line(
+        size_t                                    integrand_id     ,
+        const CppAD::vector<double>&              line_age         ,
+        const CppAD::vector<double>&              line_time        ,
+        line_interp&                              interp
+    ) const;
+    // cohort_cache
+    void cohort_cache(bool on);
 };
 
 } // END_DISMOD_AT_NAMESPACE
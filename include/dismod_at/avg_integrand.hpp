@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_AVG_INTEGRAND_HPP
 # define DISMOD_AT_AVG_INTEGRAND_HPP
@@ -19,6 +19,9 @@ Contents
 {xrst_end devel_avg_integrand}
 */
 
+# include <map>
+# include <memory>
+# include <tuple>
 # include <cppad/utility/vector.hpp>
 # include "get_integrand_table.hpp"
 # include "get_subgroup_table.hpp"
@@ -34,6 +37,25 @@ namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 
 class avg_integrand {
 private:
+    // The part of a rectangle average that does not depend on pack_vec.
+    // The average is the sum with respect to ell and k of
+    // coefficient[ell][k] times the integrand at
+    // line_age[ell][k] and line_time[ell][k] .
+    // The interpolation from the smoothing grids to line ell is interp[ell].
+    struct rectangle_plan {
+        CppAD::vector< CppAD::vector<double> >      line_age;
+        CppAD::vector< CppAD::vector<double> >      line_time;
+        CppAD::vector< CppAD::vector<double> >      coefficient;
+        CppAD::vector< adj_integrand::line_interp > interp;
+    };
+    // age_lower, age_upper, time_lower, time_upper, weight_index, need_ode,
+    // interp_set
+    typedef std::tuple<double, double, double, double, size_t, bool, size_t>
+        plan_key;
+    //
+    // maximum number of line points in the plans in plan_map_
+    static const size_t max_plan_point_ = 1000000;
+
     // constants
     const double                              ode_step_size_;
     const CppAD::vector<double>&              age_table_;
@@ -41,20 +63,32 @@ private:
     const CppAD::vector<integrand_struct>&    integrand_table_;
     const CppAD::vector<weight_info>&         w_info_vec_;
 
+    // plans that have been computed so far (plans are not changed
+    // after they are computed so copies of this object can share them)
+    typedef std::map< plan_key, std::shared_ptr<const rectangle_plan> >
+        plan_map;
+    //
+    // The copies of this object share plan_map_ until one of them stores
+    // a new plan; it then makes its own copy of the map (copy on write).
+    std::shared_ptr<plan_map>                 plan_map_;
+    //
+    // number of line points in the plans in plan_map_
+    size_t                                    n_plan_point_;
+    //
+    // most recent plan that did not fit in plan_map_
+    std::shared_ptr<const rectangle_plan>     extra_plan_;
+
     // temporaries used to avoid memory re-allocation (need constructor)
-    time_line_vec<double>                     double_time_line_object_;
-    time_line_vec<a1_double>                  a1_double_time_line_object_;
+    time_line_vec<double>                     time_line_object_;
     //
     adj_integrand                             adjint_obj_;
 
     // other temporaries used to avoid memory re-allocation
-    CppAD::vector<double>                     line_age_;
-    CppAD::vector<double>                     line_time_;
     CppAD::vector<double>                     line_weight_;
     CppAD::vector<double>                     weight_grid_;
-    //
-    CppAD::vector<double>                     double_line_adj_;
-    CppAD::vector<a1_double>                  a1_double_line_adj_;
+    CppAD::vector<size_t>                     point_line_;
+    CppAD::vector<size_t>                     point_index_;
+    adj_integrand::line_interp                interp_;
 
     // template version of rectangle
     template <class Float>
@@ -70,30 +104,38 @@ private:
         size_t                           child            ,
         size_t                           subgroup_id      ,
         const CppAD::vector<double>&     x                ,
-        const CppAD::vector<Float>&      pack_vec         ,
-        //
-        time_line_vec<Float>&            time_line_object ,
-        CppAD::vector<Float>&            line_adj
+        const CppAD::vector<Float>&      pack_vec
     );
 
-    // add_cohort
-    template <class Float>
-    void add_cohort(
-        size_t                       node_id              ,
-        double                       time_ini             ,
-        double                       time_lower           ,
-        double                       time_upper           ,
-        size_t                       weight_id            ,
-        size_t                       integrand_id         ,
-        size_t                       n_child              ,
-        size_t                       child                ,
-        size_t                       subgroup_id          ,
-        const CppAD::vector<double>& x                    ,
-        const CppAD::vector<Float>&  pack_vec             ,
-        time_line_vec<Float>&        time_line_object     ,
-        CppAD::vector<Float>&        line_adj
+    // get_plan
+    const rectangle_plan& get_plan(
+        double                           age_lower        ,
+        double                           age_upper        ,
+        double                           time_lower       ,
+        double                           time_upper       ,
+        size_t                           weight_id        ,
+        size_t                           integrand_id
     );
 
+    // store_plan
+    const rectangle_plan& store_plan(
+        const plan_key&                               key    ,
+        const std::shared_ptr<const rectangle_plan>&  plan
+    );
+
+    // plan_cohort
+    void plan_cohort(
+        rectangle_plan&                  plan             ,
+        size_t                           integrand_id     ,
+        double                           time_ini         ,
+        double                           time_lower       ,
+        double                           time_upper       ,
+        const weight_info&               w_info
+    );
+
+    // plan_coefficient
+    void plan_coefficient(rectangle_plan& plan);
+
 public:
     // avg_integrand
     avg_integrand(
@@ -141,6 +183,17 @@ public:
         const CppAD::vector<double>&     x                ,
         const CppAD::vector<a1_double>&  pack_vec
     );
+    // plan_rectangle
+    void plan_rectangle(
+        double                           age_lower        ,
+        double                           age_upper        ,
+        double                           time_lower       ,
+        double                           time_upper       ,
+        size_t                           weight_id        ,
+        size_t                           integrand_id
+    );
+    // cohort_cache
+    void cohort_cache(bool on);
 };
 
 } // END_DISMOD_AT_NAMESPACE
@@ -1,17 +1,18 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_COHORT_ODE_HPP
 # define DISMOD_AT_COHORT_ODE_HPP
 
 # include <cppad/cppad.hpp>
+# include "rate_case.hpp"
 
 namespace dismod_at {
 
     template <class Float>
     extern void cohort_ode(
-        const std::string&           rate_case ,
+        rate_case_enum               rate_case ,
         const CppAD::vector<double>& age       ,
         const Float&                 pini      ,
         const CppAD::vector<Float>&  iota      ,
@@ -21,6 +22,7 @@ namespace dismod_at {
                 CppAD::vector<Float>&  s_out     ,
                 CppAD::vector<Float>&  c_out
     );
+    void cohort_ode_checkpoint(rate_case_enum rate_case);
 }
 
 # endif
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_CREATE_TABLE_HPP
 # define DISMOD_AT_CREATE_TABLE_HPP
@@ -20,6 +20,27 @@ namespace dismod_at {
         const CppAD::vector<std::string>&   row_value      ,
         const std::size_t&                  max_insert = 1000
     );
+    struct column_value_struct {
+        CppAD::vector<int>                  int_value;
+        CppAD::vector<double>               real_value;
+        CppAD::vector<std::string>          text_value;
+    };
+    void create_table(
+        sqlite3*                                    db          ,
+        const std::string&                          table_name  ,
+        const CppAD::vector<std::string>&           col_name    ,
+        const CppAD::vector<std::string>&           col_type    ,
+        const CppAD::vector<bool>&                  col_unique  ,
+        const CppAD::vector<column_value_struct>&   col_value
+    );
+    void insert_table(
+        sqlite3*                                    db          ,
+        const std::string&                          table_name  ,
+        const CppAD::vector<std::string>&           col_name    ,
+        const CppAD::vector<std::string>&           col_type    ,
+        const CppAD::vector<column_value_struct>&   col_value   ,
+        size_t                                      first_id
+    );
 }
 // END_PROTOTYPE
 
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-24 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_DATA_MODEL_HPP
 # define DISMOD_AT_DATA_MODEL_HPP
@@ -65,6 +65,44 @@ private:
     // (effectively const)
     avg_noise_effect             avg_noise_obj_;
 
+    // number of threads used to evaluate double version of like_all
+    // (set to one by constructor)
+    size_t                       n_thread_;
+
+    // average using the specified avg_integrand temporaries
+    template <class Float>
+    Float average(
+        size_t                        data_id    ,
+        const  CppAD::vector<Float>&  pack_vec   ,
+        avg_integrand&                avgint_obj
+    );
+    // like_one using the specified avg_noise_effect temporaries
+    template <class Float>
+    residual_struct<Float> like_one(
+        size_t                        data_id       ,
+        const  CppAD::vector<Float>&  pack_vec      ,
+        const  Float&                 avg           ,
+        Float&                        delta         ,
+        avg_noise_effect&             avg_noise_obj
+    );
+    // average and like_one for a list of data points
+    template <class Float>
+    void like_list(
+        const CppAD::vector<size_t>&              subset_list  ,
+        const CppAD::vector<Float>&               pack_vec     ,
+        CppAD::vector<Float>&                     avg_vec      ,
+        CppAD::vector<Float>&                     delta_vec    ,
+        CppAD::vector< residual_struct<Float> >&  residual_vec
+    );
+    // double version of like_list (uses n_thread_ threads)
+    void like_list(
+        const CppAD::vector<size_t>&              subset_list  ,
+        const CppAD::vector<double>&              pack_vec     ,
+        CppAD::vector<double>&                    avg_vec      ,
+        CppAD::vector<double>&                    delta_vec    ,
+        CppAD::vector< residual_struct<double> >& residual_vec
+    );
+
 public:
     template <class SubsetStruct>
     data_model(
@@ -96,6 +134,9 @@ public:
         const CppAD::vector<subset_data_struct>& subset_data_obj
     );
     //
+    // number of threads used to evaluate double version of like_all
+    void set_thread_count(size_t n_thread);
+    //
     // compute an average integrand: data_model is effectively const
     template <class Float>
     Float average(
@@ -119,6 +160,29 @@ public:
         bool                          parent   ,
         const  CppAD::vector<Float>&  pack_vec
     );
+    // weighted residual and log-likelihood for data that depends on
+    // the random effects for one child (effectively const)
+    template <class Float>
+    CppAD::vector< residual_struct<Float> > like_child(
+        size_t                        child    ,
+        const  CppAD::vector<Float>&  pack_vec
+    );
+    // average integrand, delta, and residual for all data points
+    // (effectively const)
+    void like_all_avg(
+        const CppAD::vector<double>&              pack_vec     ,
+        CppAD::vector<double>&                    avg_vec      ,
+        CppAD::vector<double>&                    delta_vec    ,
+        CppAD::vector< residual_struct<double> >& residual_vec
+    );
+    // average integrand for all samples and all data points
+    // (effectively const)
+    void average_all(
+        size_t                                    n_sample       ,
+        const CppAD::vector<double>&              variable_value ,
+        CppAD::vector<double>&                    avg_vec        ,
+        size_t&                                   error_id
+    );
 };
 
 } // END_DISMOD_AT_NAMESPACE
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_DB_INPUT_CACHE_HPP
+# define DISMOD_AT_DB_INPUT_CACHE_HPP
+
+# include <string>
+# include <sqlite3.h>
+# include <dismod_at/get_db_input.hpp>
+
+namespace dismod_at {
+    bool read_db_input_cache(
+        sqlite3*                            db              ,
+        db_input_struct&                    db_input
+    );
+    void write_db_input_cache(
+        sqlite3*                            db              ,
+        const db_input_struct&              db_input
+    );
+    std::string db_input_cache_key(
+        sqlite3*                            db
+    );
+    std::string db_input2snapshot(
+        const db_input_struct&              db_input
+    );
+    bool snapshot2db_input(
+        const char*                         data            ,
+        size_t                              n_byte          ,
+        db_input_struct&                    db_input
+    );
+}
+
+# endif
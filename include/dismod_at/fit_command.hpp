@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_FIT_COMMAND_HPP
 # define DISMOD_AT_FIT_COMMAND_HPP
@@ -31,6 +31,19 @@ namespace dismod_at {
         const dismod_at::db_input_struct&             db_input         ,
         const std::map<std::string, std::string>&     option_map
     );
+    void fit_sim_range_command(
+        const std::string&                                  variables       ,
+        const std::string&                                  first_str       ,
+        const std::string&                                  last_str        ,
+        sqlite3*                                            db              ,
+        const CppAD::vector<dismod_at::subset_data_struct>& subset_data_obj ,
+        const dismod_at::data_model&                        data_object     ,
+        const dismod_at::prior_model&                       prior_object    ,
+        const dismod_at::pack_info&                         pack_object     ,
+        const dismod_at::pack_prior&                        var2prior       ,
+        const dismod_at::db_input_struct&                   db_input        ,
+        const std::map<std::string, std::string>&           option_map
+    );
 }
 
 # endif
@@ -1,12 +1,14 @@
 // $Id:$
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_FIT_MODEL_HPP
 # define DISMOD_AT_FIT_MODEL_HPP
 
 # include <map>
+# include <memory>
+# include <vector>
 # include <sqlite3.h>
 # include <dismod_at/a1_double.hpp>
 # include <cppad/mixed/cppad_mixed.hpp>
@@ -74,6 +76,20 @@ namespace dismod_at {
         // log( fixed_vec[j] + fixed_scale_eta_[j] ) during optimization.
         CppAD::vector<bool>   fixed_is_scaled_;
         CppAD::vector<double> fixed_scale_eta_;
+        //
+        // If tape_by_child_ is true, ran_likelihood is the sum of the
+        // checkpoint functions ran_like_child_[child] for each child.
+        // The arguments to ran_like_child_[child] are the fixed effects
+        // followed by the cppad_mixed random effects with indices
+        // child_random_[child].
+        bool                                                tape_by_child_;
+        //
+        // If tape_cache_ is true, ran_like_child_ is read from (written to)
+        // the tape_cache table when it is (is not) there.
+        const bool                                          tape_cache_;
+        std::vector< std::unique_ptr< CppAD::chkpoint_two<double> > >
+                                                            ran_like_child_;
+        CppAD::vector< CppAD::vector<size_t> >              child_random_;
         // -------------------------------------------------------------------
         // solution found by run_fit and in pack_info order
         struct {
@@ -103,6 +119,12 @@ namespace dismod_at {
             const CppAD::vector<Float>& fixed_after  ,
             CppAD::vector<Float>&       fixed_before
         ) const;
+        //
+        // record ran_like_child_ (returns false if not separable by child)
+        bool record_ran_like_child(
+            const CppAD::vector<double>& fixed_vec              ,
+            const CppAD::vector<double>& cppad_mixed_random_vec
+        );
         // -------------------------------------------------------------------
         // virtual functions used by cppad_mixed base class
         a1_vector ran_likelihood(
@@ -140,7 +162,9 @@ namespace dismod_at {
             const CppAD::vector<bool>&           zero_sum_child_rate   ,
             const CppAD::vector<bool>&           zero_sum_mulcov_group ,
             data_model&                          data_object           ,
-            bool                                 trace_init = false
+            bool                                 trace_init = false    ,
+            bool                                 tape_by_child = false ,
+            bool                                 tape_cache    = false
         );
         //
         // run fit
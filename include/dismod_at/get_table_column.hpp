@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_GET_TABLE_COLUMN_HPP
 # define DISMOD_AT_GET_TABLE_COLUMN_HPP
@@ -32,6 +32,22 @@ namespace dismod_at {
         const std::string&          column_name           ,
         CppAD::vector<double>&      double_result
     );
+    extern void get_table_column(
+        sqlite3*                    db                    ,
+        const std::string&          table_name            ,
+        const std::string&          column_name           ,
+        size_t                      first_id              ,
+        size_t                      end_id                ,
+        CppAD::vector<int>&         int_result
+    );
+    extern void get_table_column(
+        sqlite3*                    db                    ,
+        const std::string&          table_name            ,
+        const std::string&          column_name           ,
+        size_t                      first_id              ,
+        size_t                      end_id                ,
+        CppAD::vector<double>&      double_result
+    );
 }
 
 # endif
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_GRID2LINE_HPP
 # define DISMOD_AT_GRID2LINE_HPP
@@ -9,6 +9,13 @@
 
 namespace dismod_at { // BEGIN_DISMOD_AT_NAMESPACE
 
+// compressed sparse row representation of the map from grid to line values
+struct grid2line_csr {
+    CppAD::vector<size_t> start;
+    CppAD::vector<size_t> col;
+    CppAD::vector<double> val;
+};
+
 template <class Grid_info, class Float>
 CppAD::vector<Float> grid2line(
     const CppAD::vector<double>& line_age     ,
@@ -19,6 +26,23 @@ CppAD::vector<Float> grid2line(
     const CppAD::vector<Float>&  grid_value
 );
 
+template <class Grid_info>
+void grid2line_matrix(
+    const CppAD::vector<double>& line_age     ,
+    const CppAD::vector<double>& line_time    ,
+    const CppAD::vector<double>& age_table    ,
+    const CppAD::vector<double>& time_table   ,
+    const Grid_info&             g_info       ,
+    grid2line_csr&               matrix
+);
+
+template <class Float>
+void grid2line_product(
+    const grid2line_csr&         matrix       ,
+    const CppAD::vector<Float>&  grid_value   ,
+    CppAD::vector<Float>&        line_value
+);
+
 
 } // END_DISMOD_AT_NAMESPACE
 
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_HASH_TABLE_HPP
+# define DISMOD_AT_HASH_TABLE_HPP
+
+# include <cstdint>
+# include <string>
+# include <sqlite3.h>
+
+namespace dismod_at {
+    // BEGIN_FNV_HASH
+    class fnv_hash {
+    private:
+        uint64_t value_;
+        uint64_t check_;
+        uint64_t n_byte_;
+        static std::string to_hex(uint64_t code)
+        {   const char* digit = "0123456789abcdef";
+            std::string result(16, '0');
+            for(size_t i = 0; i < 16; ++i)
+                result[15 - i] = digit[ (code >> (4 * i)) & 0xf ];
+            return result;
+        }
+    public:
+        fnv_hash(void)
+        : value_( 14695981039346656037ULL ), check_(0), n_byte_(0)
+        { }
+        void add(const void* data, size_t n_byte)
+        {   const unsigned char* byte =
+                reinterpret_cast<const unsigned char*>(data);
+            for(size_t i = 0; i < n_byte; ++i)
+            {   value_ ^= uint64_t( byte[i] );
+                value_ *= 1099511628211ULL;
+                check_ += uint64_t( byte[i] ) + 1;
+                check_ *= 11400714819323198485ULL;
+                check_ ^= check_ >> 29;
+            }
+            n_byte_ += n_byte;
+        }
+        uint64_t value(void) const
+        {   return value_; }
+        std::string hex(void) const
+        {   return to_hex(value_); }
+        std::string check(void) const
+        {   return to_hex(check_) + to_hex(n_byte_); }
+    };
+    // END_FNV_HASH
+    extern void hash_table(
+        sqlite3*           db         ,
+        const std::string& table_name ,
+        fnv_hash&          hash
+    );
+    extern void hash_table(
+        sqlite3*           db         ,
+        const std::string& table_name ,
+        fnv_hash&          hash       ,
+        const std::string& where
+    );
+}
+
+# endif
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_LOG_MESSAGE_HPP
 # define DISMOD_AT_LOG_MESSAGE_HPP
@@ -8,8 +8,15 @@
 # include <sqlite3.h>
 # include <string>
 # include <ctime>
+# include <cppad/utility/vector.hpp>
 
 namespace dismod_at {
+    struct log_message_struct {
+        std::string message_type;
+        std::string table_name;
+        size_t      row_id;
+        std::string message;
+    };
     extern std::time_t log_message(
         sqlite3*           db           ,
         std::ostream*      os           ,
@@ -24,6 +31,8 @@ namespace dismod_at {
         const std::string& table_name   ,
         const size_t&      row_id
     );
+    extern void log_message_finalize(sqlite3* db);
+    extern CppAD::vector<log_message_struct> log_message_saved(void);
 }
 
 # endif
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_P2_QUANTILE_HPP
+# define DISMOD_AT_P2_QUANTILE_HPP
+
+# include <cstddef>
+
+namespace dismod_at {
+    class p2_quantile {
+    private:
+        // probability for the quantile
+        double      p_;
+        //
+        // number of observations so far
+        size_t      count_;
+        //
+        // marker heights
+        double      q_[5];
+        //
+        // actual marker positions (one is the first position)
+        double      n_[5];
+        //
+        // desired marker positions
+        double      np_[5];
+        //
+        // increment in desired marker positions for each observation
+        double      dn_[5];
+    public:
+        p2_quantile(double p = 0.5);
+        void   add(double x);
+        double value(void) const;
+        size_t count(void) const;
+    };
+}
+
+# endif
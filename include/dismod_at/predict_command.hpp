@@ -21,6 +21,8 @@ void predict_command(
     const std::string&                                    source              ,
     bool                                                  zero_meas_value     ,
     double                                                fit_var_scale       ,
+    bool                                                  summary             ,
+    const std::string&                                    predict_quantile    ,
     sqlite3*                                              db                  ,
     const dismod_at::db_input_struct&                     db_input            ,
     const dismod_at::pack_info&                           pack_object         ,
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_PROCESS_TEAM_HPP
+# define DISMOD_AT_PROCESS_TEAM_HPP
+
+# include <cstddef>
+# include <string>
+# include <functional>
+# include <sqlite3.h>
+# include <cppad/utility/vector.hpp>
+# include <dismod_at/log_message.hpp>
+
+namespace dismod_at {
+    size_t process_team(
+        sqlite3*                                              db        ,
+        size_t                                                n_process ,
+        size_t                                                n_task    ,
+        const std::function<std::string(size_t, sqlite3*)>&   work      ,
+        CppAD::vector<std::string>&                           result    ,
+        log_message_struct&                                   error
+    );
+}
+
+# endif
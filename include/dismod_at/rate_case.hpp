@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_RATE_CASE_HPP
+# define DISMOD_AT_RATE_CASE_HPP
+
+# include <string>
+
+namespace dismod_at {
+    // The values 1 through 4 are the case_number used by eigen_ode2.
+    enum rate_case_enum {
+        trapezoidal_enum,
+        iota_zero_rho_zero_enum,
+        iota_zero_rho_pos_enum,
+        iota_pos_rho_zero_enum,
+        iota_pos_rho_pos_enum,
+        no_ode_enum,
+        number_rate_case_enum
+    };
+    extern rate_case_enum rate_case2enum(const std::string& rate_case);
+}
+
+# endif
@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_SERVER_REQUEST_HPP
+# define DISMOD_AT_SERVER_REQUEST_HPP
+
+# include <cctype>
+# include <string>
+# include <cppad/utility/vector.hpp>
+
+namespace dismod_at {
+    std::string parse_server_request(
+        const std::string&          request  ,
+        std::string&                database ,
+        CppAD::vector<std::string>& command
+    );
+    std::string json_string(const std::string& str);
+}
+
+# endif
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_SET_DB_PROFILE_HPP
+# define DISMOD_AT_SET_DB_PROFILE_HPP
+
+# include <sqlite3.h>
+# include <string>
+
+namespace dismod_at {
+    extern void set_db_profile(sqlite3* db, const std::string& db_profile);
+}
+
+# endif
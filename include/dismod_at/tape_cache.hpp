@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_TAPE_CACHE_HPP
+# define DISMOD_AT_TAPE_CACHE_HPP
+
+# include <sqlite3.h>
+# include <string>
+# include <cppad/utility/vector.hpp>
+
+namespace dismod_at {
+    std::string tape_cache_key(
+        sqlite3*                            db              ,
+        int                                 simulate_index  ,
+        const CppAD::vector<double>&        value           ,
+        std::string&                        check_key
+    );
+    bool read_tape_cache(
+        sqlite3*                            db              ,
+        const std::string&                  cache_key       ,
+        const std::string&                  check_key       ,
+        CppAD::vector<std::string>&         tape
+    );
+    void write_tape_cache(
+        sqlite3*                            db              ,
+        const std::string&                  cache_key       ,
+        const std::string&                  check_key       ,
+        const CppAD::vector<std::string>&   tape
+    );
+}
+
+# endif
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_THREAD_TEAM_HPP
+# define DISMOD_AT_THREAD_TEAM_HPP
+
+# include <cstddef>
+# include <functional>
+
+namespace dismod_at {
+    void thread_team(
+        size_t                                 n_thread ,
+        const std::function<void(size_t)>&     work
+    );
+}
+
+# endif
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # ifndef DISMOD_AT_TIME_LINE_VEC_HPP
 # define DISMOD_AT_TIME_LINE_VEC_HPP
@@ -32,9 +32,17 @@ private:
     double time_lower_;
     double time_upper_;
     //
-    // vec_ has the same size as sub_grid_ and
-    // vec_[j] contains the line for sub_grid_[j]
-    CppAD::vector< CppAD::vector<time_point> >  vec_;
+    // The time line for extend_grid_[sub_lower_ + i] is
+    // time_[k], weight_[k], value_[k] for start_[i] <= k < start_[i]+size_[i].
+    // It is sorted by time and start_[i+1] - start_[i] is its capacity.
+    CppAD::vector<size_t> start_;
+    CppAD::vector<size_t> size_;
+    CppAD::vector<double> time_;
+    CppAD::vector<double> weight_;
+    CppAD::vector<Float>  value_;
+    //
+    // increase the capacity for the time line with index i in start_
+    void grow(size_t i);
 public:
     // near_equal
     static bool near_equal(double x, double y);
@@ -63,10 +71,17 @@ public:
         const size_t&     age_index ,
         const time_point& point
     );
-    // time_line
-    const CppAD::vector<time_point>& time_line(
-        const size_t& age_index
-    ) const;
+    // line_size
+    size_t line_size(const size_t& age_index) const;
+    //
+    // line_time
+    const double* line_time(const size_t& age_index) const;
+    //
+    // line_weight
+    const double* line_weight(const size_t& age_index) const;
+    //
+    // line_value
+    const Float* line_value(const size_t& age_index) const;
     //
     // max_time_diff
     double max_time_diff(size_t& age_index, size_t& time_index) const;
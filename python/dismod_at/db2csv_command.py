@@ -1,6 +1,6 @@
 # SPDX-License-Identifier: AGPL-3.0-or-later
 # SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-# SPDX-FileContributor: 2014-25 Bradley M. Bell
+# SPDX-FileContributor: 2014-26 Bradley M. Bell
 # ----------------------------------------------------------------------------
 # {xrst_begin db2csv_command}
 # {xrst_spell
@@ -1172,6 +1172,9 @@ def db2csv_command(database_file_arg) :
             tmp     = message.find('warm_start')
             if tmp > 0 :
                 message = message[0 : tmp - 1]
+            # fit with sim_range does not create a fit_var table
+            if message.find('sim_range') > 0 :
+                message = ''
             if message.startswith('begin fit fixed') :
                 simulate_index = message[ len('begin fit fixed') : ].strip()
             if message.startswith('begin fit random') :
@@ -1225,6 +1228,8 @@ def db2csv_command(database_file_arg) :
         [ "bound_random",                      ""],
         [ "compress_interval",                 "0 0"],
         [ "data_extra_columns",                ""],
+        [ "db_input_cache",                    "false"],
+        [ "db_profile",                        "default"],
         [ "derivative_test_fixed",             "none"],
         [ "derivative_test_random",            "none"],
         [ "hold_out_integrand",                ""],
@@ -1238,12 +1243,16 @@ def db2csv_command(database_file_arg) :
         [ "other_input_table",                 ""],
         [ "parent_node_id",                    ""],
         [ "parent_node_name",                  ""],
+        [ "predict_quantile",                  "0.025 0.5 0.975"],
         [ "print_level_fixed",                 "0"],
         [ "print_level_random",                "0"],
         [ "quasi_fixed",                       "true"],
         [ "random_seed",                       "0"],
         [ "rate_case",                         "iota_pos_rho_zero"],
         [ "splitting_covariate",               ""],
+        [ "tape_by_child",                     "false"],
+        [ "tape_cache",                        "false"],
+        [ "thread_count",                      "1"],
         [ "tolerance_fixed",                   "1e-8"],
         [ "tolerance_random",                  "1e-8"],
         [ "trace_init_fit_model",              "false"],
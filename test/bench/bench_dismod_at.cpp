@@ -0,0 +1,530 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+{xrst_begin bench_dismod_at dev}
+{xrst_spell
+  json
+}
+
+Timing the dismod_at Integrand and Likelihood Routines
+######################################################
+
+Syntax
+******
+| ``bench_dismod_at``
+| ``bench_dismod_at`` *n_child* *ode_step_size* *n_data* *min_time*
+
+Purpose
+*******
+The :ref:`user_speed.py-name` example times all of the dismod_at
+commands for one database.
+This program times the routines below separately,
+using synthetic models, so that changes in their speed can be tracked.
+
+Build
+*****
+This program is not built by the ``check`` target. It is built by
+``make bench_dismod_at`` in the cmake build directory and the
+executable is ``test/bench/bench_dismod_at`` in that directory.
+
+Model
+*****
+The synthetic model has a parent node with *n_child* children.
+Each rate, other than pini, has a random effect for each child
+at every point of its smoothing grid.
+The data is divided between the parent and the children and
+includes integrands that require solving the ODE
+(e.g., prevalence) and integrands that do not (e.g., Sincidence).
+The rate case is ``iota_pos_rho_pos`` .
+
+n_child
+=======
+is the number of children of the parent node.
+
+ode_step_size
+=============
+is the :ref:`option_table@Age Average Grid@ode_step_size`
+for the model.
+
+n_data
+======
+is the number of rows in the data table.
+
+min_time
+========
+is the minimum time in seconds for each timing.
+A routine is repeated, doubling the number of calls,
+until the total time is greater than or equal *min_time* .
+
+Default
+=======
+If there are no arguments,
+every combination of the following values is used:
+*n_child* in {0, 20} ,
+*ode_step_size* in {5, 1} ,
+*n_data* in {100, 1000} .
+In this case *min_time* is 0.1.
+
+Routines
+********
+Each of the routines below is timed using both
+``double`` and :ref:`a1_double-name` .
+The ``a1_double`` times include recording the operation sequence
+for the routine and creating the corresponding CppAD function object.
+
+.. csv-table::
+    :widths: auto
+
+    *name*, timing
+    avg_integrand::rectangle, :ref:`avg_integrand_rectangle-name` for all data
+    cohort_ode, :ref:`cohort_ode-name` from age zero to age 100
+    grid2line, :ref:`grid2line-name` from parent iota grid to age avg grid
+    time_line_vec::age_time_avg, fill in and average a :ref:`time_line_vec-name`
+    data_model::like_all, :ref:`data_model_like_all-name` for all the data
+    prior_model::fixed, :ref:`prior_model-name` fixed effects prior
+    prior_model::random, :ref:`prior_model-name` random effects prior
+
+Tape Cache
+**********
+The following timings are used to estimate the savings for the
+:ref:`option_table@tape_cache` option.
+The function for ``data_model::like_all`` is recorded using ``a1_double`` ,
+it is optimized, and it is converted to its json representation.
+(The cached functions are the part of this function, plus the
+random effects prior, that corresponds to each child.)
+
+.. csv-table::
+    :widths: auto
+
+    *name*, *float*, timing
+    tape_cache::record, a1_double, record and optimize the function
+    tape_cache::from_json, json, create the function from its json
+
+The cache replaces the recording with reading the json from the database
+(a cache hit) and adds computing the :ref:`tape_cache@cache_key`
+(every fit).
+The key hashes the input tables, so its cost grows with the size
+of the data table.
+The functions and sparsity patterns that cppad_mixed creates
+(which are the larger part of the time to initialize a fit)
+are not cached.
+
+Output
+******
+The results are written to standard output using the
+`json <https://www.json.org>`_ format.
+The top level object has the following members:
+
+.. csv-table::
+    :widths: auto
+
+    program, ``"bench_dismod_at"``
+    version, the dismod_at version
+    min_time, the value of *min_time*
+    result, an array with one element per timing
+
+Each element of *result* is an object with the following members:
+
+.. csv-table::
+    :widths: auto
+
+    name, the name of the routine
+    float, ``"double"`` , ``"a1_double"`` , or ``"json"``
+    n_child, the value of *n_child* for this timing
+    ode_step_size, the value of *ode_step_size* for this timing
+    n_data, the value of *n_data* for this timing
+    n_call, number of calls used for this timing
+    seconds, seconds per call
+
+{xrst_end bench_dismod_at}
+*/
+# include <chrono>
+# include <cstdlib>
+# include <iomanip>
+# include <iostream>
+# include <string>
+# include <dismod_at/a1_double.hpp>
+# include <dismod_at/configure.hpp>
+# include <dismod_at/cohort_ode.hpp>
+# include <dismod_at/grid2line.hpp>
+# include <dismod_at/time_line_vec.hpp>
+# include "bench_model.hpp"
+
+namespace { // BEGIN_EMPTY_NAMESPACE
+    //
+    // sink
+    // results are added here so the calls cannot be skipped
+    double sink_ = 0.0;
+    //
+    // residual_sum
+    template <class Float>
+    Float residual_sum(
+        const CppAD::vector< dismod_at::residual_struct<Float> >& residual
+    )
+    {   Float sum = Float(0);
+        for(size_t i = 0; i < residual.size(); ++i)
+            sum += residual[i].logden_smooth;
+        return sum;
+    }
+    // ------------------------------------------------------------------------
+    // kernels: each one returns a value that depends on pack_vec
+    //
+    // rectangle
+    template <class Float>
+    Float rectangle(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   CppAD::vector<double> x(0);
+        Float sum = Float(0);
+        for(size_t i = 0; i < model.subset_data_obj.size(); ++i)
+        {   const dismod_at::subset_data_struct& row =
+                model.subset_data_obj[i];
+            size_t child = model.child_info4data->table_id2child(
+                size_t( row.original_id )
+            );
+            sum += model.avgint_object->rectangle(
+                size_t( row.node_id )      ,
+                row.age_lower              ,
+                row.age_upper              ,
+                row.time_lower             ,
+                row.time_upper             ,
+                size_t( row.weight_id )    ,
+                size_t( row.integrand_id ) ,
+                model.n_child              ,
+                child                      ,
+                size_t( row.subgroup_id )  ,
+                x                          ,
+                pack_vec
+            );
+        }
+        return sum;
+    }
+    //
+    // cohort_ode
+    template <class Float>
+    Float cohort_ode(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   using CppAD::vector;
+        size_t n_var = pack_vec.size();
+        size_t n_age = size_t( 100.0 / model.ode_step_size ) + 1;
+        vector<double> age(n_age);
+        vector<Float> iota(n_age), rho(n_age), chi(n_age), omega(n_age);
+        for(size_t i = 0; i < n_age; ++i)
+        {   age[i]   = double(i) * model.ode_step_size;
+            iota[i]  = pack_vec[ (4 * i + 0) % n_var ];
+            rho[i]   = pack_vec[ (4 * i + 1) % n_var ];
+            chi[i]   = pack_vec[ (4 * i + 2) % n_var ];
+            omega[i] = pack_vec[ (4 * i + 3) % n_var ];
+        }
+        Float pini = Float(0);
+        vector<Float> s_out(n_age), c_out(n_age);
+        dismod_at::rate_case_enum rate_case = dismod_at::iota_pos_rho_pos_enum;
+        dismod_at::cohort_ode(
+            rate_case, age, pini, iota, rho, chi, omega, s_out, c_out
+        );
+        return s_out[n_age - 1] + c_out[n_age - 1];
+    }
+    //
+    // grid2line
+    template <class Float>
+    Float grid2line(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   using CppAD::vector;
+        //
+        // grid_value: parent iota
+        dismod_at::pack_info::subvec_info info =
+            model.pack_object->node_rate_value_info(
+                dismod_at::iota_enum, model.n_child
+        );
+        const dismod_at::smooth_info& s_info = model.s_info_vec[info.smooth_id];
+        vector<Float> grid_value(info.n_var);
+        for(size_t k = 0; k < info.n_var; ++k)
+            grid_value[k] = pack_vec[info.offset + k];
+        //
+        // line_age, line_time: age_avg_grid at three times
+        const vector<double>& age_avg_grid = model.age_avg_grid;
+        vector<double> line_age, line_time;
+        for(size_t j = 0; j < 3; ++j)
+        {   for(size_t i = 0; i < age_avg_grid.size(); ++i)
+            {   line_age.push_back( age_avg_grid[i] );
+                line_time.push_back( 1985.0 + 10.0 * double(j) );
+            }
+        }
+        vector<Float> line_value = dismod_at::grid2line(
+            line_age,
+            line_time,
+            model.age_table,
+            model.time_table,
+            s_info,
+            grid_value
+        );
+        Float sum = Float(0);
+        for(size_t k = 0; k < line_value.size(); ++k)
+            sum += line_value[k];
+        return sum;
+    }
+    //
+    // age_time_avg
+    template <class Float>
+    Float age_time_avg(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   typedef typename dismod_at::time_line_vec<Float>::time_point time_point;
+        size_t n_var = pack_vec.size();
+        dismod_at::time_line_vec<Float> vec(model.age_avg_grid);
+        double time_lower = 1990.0;
+        double time_upper = 2000.0;
+        vec.specialize(0.0, 100.0, time_lower, time_upper);
+        size_t k = 0;
+        for(size_t i = vec.sub_lower(); i <= vec.sub_upper(); ++i)
+        {   for(size_t j = 0; j < 3; ++j)
+            {   time_point point;
+                point.time   = time_lower + 5.0 * double(j);
+                point.weight = 1.0 + double(j);
+                point.value  = pack_vec[ k++ % n_var ];
+                vec.add_point(i, point);
+            }
+        }
+        return vec.age_time_avg();
+    }
+    //
+    // like_all
+    template <class Float>
+    Float like_all(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   bool hold_out = false;
+        Float sum = residual_sum(
+            model.data_object->like_all(hold_out, false, pack_vec)
+        );
+        sum += residual_sum(
+            model.data_object->like_all(hold_out, true, pack_vec)
+        );
+        return sum;
+    }
+    //
+    // prior_fixed
+    template <class Float>
+    Float prior_fixed(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   return residual_sum( model.prior_object->fixed(pack_vec) );
+    }
+    //
+    // prior_random
+    template <class Float>
+    Float prior_random(bench_model& model, const CppAD::vector<Float>& pack_vec)
+    {   return residual_sum( model.prior_object->random(pack_vec) );
+    }
+    // ------------------------------------------------------------------------
+    // tape_json_
+    // json representation of the like_all function for the current model
+    std::string tape_json_;
+    //
+    // tape_record
+    void tape_record(bench_model& model)
+    {   using dismod_at::a1_double;
+        size_t n_var = model.pack_vec.size();
+        CppAD::vector<a1_double> ax(n_var), ay(1);
+        for(size_t j = 0; j < n_var; ++j)
+            ax[j] = model.pack_vec[j];
+        CppAD::Independent(ax);
+        ay[0] = like_all(model, ax);
+        CppAD::ADFun<double> fun(ax, ay);
+        fun.optimize();
+        sink_ += double( fun.size_var() );
+        tape_json_ = fun.to_json();
+    }
+    //
+    // tape_from_json
+    void tape_from_json(bench_model& /* model */)
+    {   CppAD::ADFun<double> fun;
+        fun.from_json(tape_json_);
+        sink_ += double( fun.size_var() );
+    }
+    // ------------------------------------------------------------------------
+    typedef void (*tape_kernel)(bench_model& model);
+    typedef double (*double_kernel)(
+        bench_model& model, const CppAD::vector<double>& pack_vec
+    );
+    typedef dismod_at::a1_double (*a1_kernel)(
+        bench_model& model, const CppAD::vector<dismod_at::a1_double>& pack_vec
+    );
+    //
+    // call_kernel: tape
+    void call_kernel(tape_kernel kernel, bench_model& model)
+    {   kernel(model);
+    }
+    //
+    // call_kernel: double
+    void call_kernel(double_kernel kernel, bench_model& model)
+    {   sink_ += kernel(model, model.pack_vec);
+    }
+    //
+    // call_kernel: a1_double
+    void call_kernel(a1_kernel kernel, bench_model& model)
+    {   using dismod_at::a1_double;
+        size_t n_var = model.pack_vec.size();
+        CppAD::vector<a1_double> ax(n_var), ay(1);
+        for(size_t j = 0; j < n_var; ++j)
+            ax[j] = model.pack_vec[j];
+        CppAD::Independent(ax);
+        ay[0] = kernel(model, ax);
+        CppAD::ADFun<double> fun(ax, ay);
+        sink_ += double( fun.size_var() );
+    }
+    //
+    // time_kernel
+    template <class Kernel>
+    double time_kernel(
+        Kernel       kernel   ,
+        bench_model& model    ,
+        double       min_time ,
+        size_t&      n_call   )
+    {   typedef std::chrono::steady_clock clock;
+        n_call = 1;
+        while( true )
+        {   clock::time_point start = clock::now();
+            for(size_t i = 0; i < n_call; ++i)
+                call_kernel(kernel, model);
+            std::chrono::duration<double> elapsed = clock::now() - start;
+            if( elapsed.count() >= min_time )
+                return elapsed.count() / double(n_call);
+            n_call *= 2;
+        }
+    }
+    // ------------------------------------------------------------------------
+    // print_result
+    void print_result(
+        const char* name          ,
+        const char* float_name    ,
+        size_t      n_child       ,
+        double      ode_step_size ,
+        size_t      n_data        ,
+        size_t      n_call        ,
+        double      seconds       ,
+        bool&       first_result  )
+    {   if( ! first_result )
+            std::cout << ",\n";
+        first_result = false;
+        std::cout << "    { \"name\" : \"" << name;
+        std::cout << "\", \"float\" : \"" << float_name;
+        std::cout << "\", \"n_child\" : " << n_child;
+        std::cout << ", \"ode_step_size\" : " << ode_step_size;
+        std::cout << ", \"n_data\" : " << n_data;
+        std::cout << ", \"n_call\" : " << n_call;
+        std::cout << ", \"seconds\" : " << seconds << " }";
+    }
+    // ------------------------------------------------------------------------
+    // run_case
+    void run_case(
+        size_t  n_child         ,
+        double  ode_step_size   ,
+        size_t  n_data          ,
+        double  min_time        ,
+        bool&   first_result    )
+    {   using dismod_at::a1_double;
+        bench_model model(n_child, ode_step_size, n_data);
+        //
+        struct {
+            const char*   name;
+            double_kernel double_fun;
+            a1_kernel     a1_fun;
+        } kernel_list[] = {
+            { "avg_integrand::rectangle",
+                rectangle<double>,    rectangle<a1_double>    },
+            { "cohort_ode",
+                cohort_ode<double>,   cohort_ode<a1_double>   },
+            { "grid2line",
+                grid2line<double>,    grid2line<a1_double>    },
+            { "time_line_vec::age_time_avg",
+                age_time_avg<double>, age_time_avg<a1_double> },
+            { "data_model::like_all",
+                like_all<double>,     like_all<a1_double>     },
+            { "prior_model::fixed",
+                prior_fixed<double>,  prior_fixed<a1_double>  },
+            { "prior_model::random",
+                prior_random<double>, prior_random<a1_double> }
+        };
+        size_t n_kernel = sizeof(kernel_list) / sizeof(kernel_list[0]);
+        for(size_t k = 0; k < n_kernel; ++k)
+        {   for(size_t f = 0; f < 2; ++f)
+            {   size_t n_call;
+                double seconds;
+                if( f == 0 ) seconds = time_kernel(
+                    kernel_list[k].double_fun, model, min_time, n_call
+                );
+                else seconds = time_kernel(
+                    kernel_list[k].a1_fun, model, min_time, n_call
+                );
+                print_result(
+                    kernel_list[k].name,
+                    f == 0 ? "double" : "a1_double",
+                    n_child, ode_step_size, n_data, n_call, seconds,
+                    first_result
+                );
+            }
+        }
+        //
+        // tape_cache
+        size_t n_call;
+        double seconds = time_kernel(tape_record, model, min_time, n_call);
+        print_result("tape_cache::record", "a1_double",
+            n_child, ode_step_size, n_data, n_call, seconds, first_result
+        );
+        seconds = time_kernel(tape_from_json, model, min_time, n_call);
+        print_result("tape_cache::from_json", "json",
+            n_child, ode_step_size, n_data, n_call, seconds, first_result
+        );
+    }
+} // END_EMPTY_NAMESPACE
+
+int main(int n_arg, const char** argv)
+{   using std::string;
+    //
+    if( n_arg != 1 && n_arg != 5 )
+    {   std::cerr << "usage: bench_dismod_at\n";
+        std::cerr << "usage: bench_dismod_at "
+            "n_child ode_step_size n_data min_time\n";
+        return 1;
+    }
+    //
+    // n_child_vec, ode_step_size_vec, n_data_vec, min_time
+    CppAD::vector<size_t> n_child_vec, n_data_vec;
+    CppAD::vector<double> ode_step_size_vec;
+    double min_time = 0.1;
+    if( n_arg == 1 )
+    {   n_child_vec.push_back(0);
+        n_child_vec.push_back(20);
+        ode_step_size_vec.push_back(5.0);
+        ode_step_size_vec.push_back(1.0);
+        n_data_vec.push_back(100);
+        n_data_vec.push_back(1000);
+    }
+    else
+    {   n_child_vec.push_back( size_t( std::atoi( argv[1] ) ) );
+        ode_step_size_vec.push_back( std::atof( argv[2] ) );
+        n_data_vec.push_back( size_t( std::atoi( argv[3] ) ) );
+        min_time = std::atof( argv[4] );
+        if( ode_step_size_vec[0] <= 0.0 || n_data_vec[0] == 0 )
+        {   std::cerr << "bench_dismod_at: ode_step_size <= 0 or n_data = 0\n";
+            return 1;
+        }
+    }
+    //
+    std::cout << std::setprecision(6);
+    std::cout << "{ \"program\" : \"bench_dismod_at\",\n";
+    std::cout << "  \"version\" : \"" << DISMOD_AT_VERSION << "\",\n";
+    std::cout << "  \"min_time\" : " << min_time << ",\n";
+    std::cout << "  \"result\" : [\n";
+    bool first_result = true;
+    for(size_t i = 0; i < n_child_vec.size(); ++i)
+    for(size_t j = 0; j < ode_step_size_vec.size(); ++j)
+    for(size_t k = 0; k < n_data_vec.size(); ++k)
+    {   run_case(
+            n_child_vec[i],
+            ode_step_size_vec[j],
+            n_data_vec[k],
+            min_time,
+            first_result
+        );
+    }
+    std::cout << "\n  ]\n}\n";
+    //
+    // sink_ is not used, but the compiler does not know that
+    if( sink_ == 0.0 )
+        std::cerr << "bench_dismod_at: sink = 0\n";
+    return 0;
+}
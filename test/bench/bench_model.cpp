@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+Construct the synthetic model used by bench_dismod_at.
+The parent has n_child children, each rate other than pini has a random
+effect for each child, and the data is divided between the parent and
+children.
+*/
+# include <cassert>
+# include <limits>
+# include <map>
+# include <dismod_at/null_int.hpp>
+# include <dismod_at/age_avg_grid.hpp>
+# include "bench_model.hpp"
+
+bench_model::bench_model(
+    size_t n_child_in, double ode_step_size_in, size_t n_data_in
+) :
+n_child       ( n_child_in )       ,
+ode_step_size ( ode_step_size_in ) ,
+n_data        ( n_data_in )
+{   using CppAD::vector;
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    double inf = std::numeric_limits<double>::infinity();
+    //
+    // age_table
+    age_table.push_back(0.0);
+    age_table.push_back(1.0);
+    age_table.push_back(5.0);
+    for(size_t i = 1; i <= 10; ++i)
+        age_table.push_back( double(i) * 10.0 );
+    size_t n_age_table = age_table.size();
+    //
+    // time_table
+    for(size_t j = 0; j <= 4; ++j)
+        time_table.push_back( 1980.0 + double(j) * 10.0 );
+    size_t n_time_table = time_table.size();
+    //
+    // density table
+    size_t n_density = dismod_at::number_density_enum;
+    density_table.resize(n_density);
+    for(size_t density_id = 0; density_id < n_density; ++density_id)
+        density_table[density_id] = dismod_at::density_enum(density_id);
+    //
+    // prior_table
+    // 0: parent rate values, 1: child rate values, 2: age and time differences
+    prior_table.resize(3);
+    prior_table[0].prior_name = "parent_value";
+    prior_table[0].density_id = int( dismod_at::uniform_enum );
+    prior_table[0].lower      = 1e-6;
+    prior_table[0].upper      = 1.0;
+    prior_table[0].mean       = 0.01;
+    prior_table[0].std        = nan;
+    prior_table[0].eta        = nan;
+    prior_table[0].nu         = nan;
+    //
+    prior_table[1].prior_name = "child_value";
+    prior_table[1].density_id = int( dismod_at::gaussian_enum );
+    prior_table[1].lower      = -inf;
+    prior_table[1].upper      = +inf;
+    prior_table[1].mean       = 0.0;
+    prior_table[1].std        = 0.5;
+    prior_table[1].eta        = nan;
+    prior_table[1].nu         = nan;
+    //
+    prior_table[2].prior_name = "difference";
+    prior_table[2].density_id = int( dismod_at::gaussian_enum );
+    prior_table[2].lower      = -inf;
+    prior_table[2].upper      = +inf;
+    prior_table[2].mean       = 0.0;
+    prior_table[2].std        = 0.1;
+    prior_table[2].eta        = nan;
+    prior_table[2].nu         = nan;
+    //
+    // age_id, time_id
+    vector<size_t> age_id(n_age_table), time_id(n_time_table);
+    for(size_t i = 0; i < n_age_table; ++i)
+        age_id[i] = i;
+    for(size_t j = 0; j < n_time_table; ++j)
+        time_id[j] = j;
+    //
+    // w_info_vec
+    vector<double> weight(n_age_table * n_time_table);
+    for(size_t k = 0; k < weight.size(); ++k)
+        weight[k] = 1.0 + double(k % 3);
+    w_info_vec.resize(2);
+    w_info_vec[0] = dismod_at::weight_info(
+        age_table, time_table, age_id, time_id, weight
+    );
+    //
+    // s_info_vec
+    // smooth_id = 0 parent rates, 1 pini, 2 child rates
+    size_t mulstd = DISMOD_AT_NULL_SIZE_T;
+    bool all_const_value = false;
+    s_info_vec.resize(3);
+    for(size_t smooth_id = 0; smooth_id < 3; ++smooth_id)
+    {   vector<size_t> age_id_tmp = age_id;
+        if( smooth_id == 1 )
+            age_id_tmp.resize(1);
+        size_t n_age  = age_id_tmp.size();
+        size_t n_time = n_time_table;
+        size_t n_si   = n_age * n_time;
+        //
+        vector<size_t> value_prior_id(n_si);
+        vector<size_t> dage_prior_id(n_si), dtime_prior_id(n_si);
+        vector<double> const_value(n_si);
+        for(size_t i = 0; i < n_age; ++i)
+        {   for(size_t j = 0; j < n_time; ++j)
+            {   size_t k          = i * n_time + j;
+                value_prior_id[k] = smooth_id == 2 ? 1 : 0;
+                dage_prior_id[k]  = 2;
+                dtime_prior_id[k] = 2;
+                if( i + 1 == n_age )
+                    dage_prior_id[k] = DISMOD_AT_NULL_SIZE_T;
+                if( j + 1 == n_time )
+                    dtime_prior_id[k] = DISMOD_AT_NULL_SIZE_T;
+                const_value[k] = nan;
+            }
+        }
+        s_info_vec[smooth_id] = dismod_at::smooth_info(
+            age_table, time_table, age_id_tmp, time_id,
+            value_prior_id, dage_prior_id, dtime_prior_id, const_value,
+            mulstd, mulstd, mulstd, all_const_value
+        );
+    }
+    //
+    // integrand_table
+    size_t n_integrand = dismod_at::number_integrand_enum;
+    integrand_table.resize(n_integrand);
+    for(size_t i = 0; i < n_integrand; ++i)
+    {   integrand_table[i].integrand       = dismod_at::integrand_enum(i);
+        integrand_table[i].minimum_meas_cv = 0.0;
+        integrand_table[i].mulcov_id       = DISMOD_AT_NULL_INT;
+    }
+    //
+    // node_table
+    size_t n_node = 1 + n_child;
+    node_table.resize(n_node);
+    node_table[0].node_name = "parent";
+    node_table[0].parent    = DISMOD_AT_NULL_INT;
+    for(size_t node_id = 1; node_id < n_node; ++node_id)
+    {   node_table[node_id].node_name = "child_" + CppAD::to_string(node_id);
+        node_table[node_id].parent    = 0;
+    }
+    size_t parent_node_id = 0;
+    //
+    // cov2weight_obj
+    size_t n_covariate = 0;
+    size_t n_weight    = 1;
+    std::string splitting_covariate = "";
+    vector<dismod_at::rate_eff_cov_struct> rate_eff_cov_table(0);
+    cov2weight_obj.reset( new dismod_at::cov2weight_map(
+        n_node,
+        n_weight,
+        splitting_covariate,
+        covariate_table,
+        rate_eff_cov_table
+    ) );
+    //
+    // data_table
+    // integrands that require solving the ODE and some that do not
+    dismod_at::integrand_enum integrand[] = {
+        dismod_at::prevalence_enum,
+        dismod_at::Sincidence_enum,
+        dismod_at::mtspecific_enum,
+        dismod_at::mtexcess_enum,
+        dismod_at::prevalence_enum,
+        dismod_at::mtall_enum
+    };
+    size_t n_cycle = sizeof(integrand) / sizeof(integrand[0]);
+    data_table.resize(n_data);
+    for(size_t data_id = 0; data_id < n_data; ++data_id)
+    {   dismod_at::data_struct& row = data_table[data_id];
+        double age_lower = 5.0 * double( data_id % 19 );
+        double time_lower = 1985.0 + double( data_id % 25 );
+        row.integrand_id = int( integrand[ data_id % n_cycle ] );
+        row.node_id      = int( data_id % n_node );
+        row.subgroup_id  = 0;
+        row.weight_id    = 0;
+        row.age_lower    = age_lower;
+        row.age_upper    = age_lower + 5.0 * double( data_id % 3 );
+        row.time_lower   = time_lower;
+        row.time_upper   = time_lower + double( data_id % 5 );
+        row.hold_out     = 0;
+        row.density_id   = int( dismod_at::gaussian_enum );
+        row.meas_value   = 0.01;
+        row.meas_std     = 0.001;
+        row.eta          = 1e-4;
+        row.nu           = 5.0;
+        row.sample_size  = DISMOD_AT_NULL_INT;
+    }
+    //
+    // subgroup_table
+    subgroup_table.resize(1);
+    subgroup_table[0].subgroup_name = "world";
+    subgroup_table[0].group_id      = 0;
+    subgroup_table[0].group_name    = "world";
+    //
+    // smooth_table
+    smooth_table.resize( s_info_vec.size() );
+    for(size_t smooth_id = 0; smooth_id < s_info_vec.size(); ++smooth_id)
+    {   dismod_at::smooth_struct& row = smooth_table[smooth_id];
+        row.smooth_name           = "smooth_" + CppAD::to_string(smooth_id);
+        row.n_age                 = int( s_info_vec[smooth_id].age_size() );
+        row.n_time                = int( s_info_vec[smooth_id].time_size() );
+        row.mulstd_value_prior_id = DISMOD_AT_NULL_INT;
+        row.mulstd_dage_prior_id  = DISMOD_AT_NULL_INT;
+        row.mulstd_dtime_prior_id = DISMOD_AT_NULL_INT;
+    }
+    //
+    // rate_table
+    rate_table.resize( dismod_at::number_rate_enum );
+    for(size_t rate_id = 0; rate_id < rate_table.size(); ++rate_id)
+    {   dismod_at::rate_struct& row = rate_table[rate_id];
+        row.rate             = dismod_at::rate_enum(rate_id);
+        row.parent_smooth_id = 0;
+        row.child_smooth_id  = 2;
+        row.child_nslist_id  = DISMOD_AT_NULL_INT;
+        if( rate_id == dismod_at::pini_enum )
+        {   row.parent_smooth_id = 1;
+            row.child_smooth_id  = DISMOD_AT_NULL_INT;
+        }
+    }
+    //
+    // child_info4data
+    child_info4data.reset( new dismod_at::child_info(
+        parent_node_id, node_table, data_table
+    ) );
+    assert( child_info4data->child_size() == n_child );
+    //
+    // pack_object
+    vector<size_t> child_id2node_id(n_child);
+    for(size_t child = 0; child < n_child; ++child)
+        child_id2node_id[child] = child_info4data->child_id2node_id(child);
+    vector<dismod_at::nslist_pair_struct> nslist_pair(0);
+    pack_object.reset( new dismod_at::pack_info(
+        n_integrand,
+        child_id2node_id,
+        subgroup_table,
+        smooth_table,
+        mulcov_table,
+        rate_table,
+        nslist_pair
+    ) );
+    //
+    // subset_data_obj, subset_data_cov_value
+    std::map<std::string, std::string> option_map;
+    vector<dismod_at::data_subset_struct> data_subset_table(n_data);
+    for(size_t i = 0; i < n_data; ++i)
+    {   data_subset_table[i].data_id     = int(i);
+        data_subset_table[i].hold_out    = 0;
+        data_subset_table[i].density_id  = data_table[i].density_id;
+        data_subset_table[i].sample_size = data_table[i].sample_size;
+        data_subset_table[i].eta         = data_table[i].eta;
+        data_subset_table[i].nu          = data_table[i].nu;
+    }
+    dismod_at::subset_data(
+        option_map,
+        data_subset_table,
+        integrand_table,
+        density_table,
+        data_table,
+        data_cov_value,
+        covariate_table,
+        *child_info4data,
+        subset_data_obj,
+        subset_data_cov_value
+    );
+    //
+    // var2prior
+    double bound_random = inf;
+    vector<size_t> n_child_data_in_fit(n_child);
+    for(size_t child = 0; child < n_child; ++child)
+        n_child_data_in_fit[child] = 0;
+    for(size_t data_id = 0; data_id < n_data; ++data_id)
+    {   size_t child = child_info4data->table_id2child(data_id);
+        if( child < n_child )
+            ++n_child_data_in_fit[child];
+    }
+    var2prior.reset( new dismod_at::pack_prior(
+        bound_random, n_child_data_in_fit, prior_table, *pack_object, s_info_vec
+    ) );
+    //
+    // age_avg_grid
+    std::string age_avg_split = "";
+    age_avg_grid = dismod_at::age_avg_grid(
+        ode_step_size, age_avg_split, age_table
+    );
+    //
+    // avgint_object
+    std::string rate_case = "iota_pos_rho_pos";
+    avgint_object.reset( new dismod_at::avg_integrand(
+        *cov2weight_obj,
+        ode_step_size,
+        rate_case,
+        age_avg_grid,
+        age_table,
+        time_table,
+        covariate_table,
+        subgroup_table,
+        integrand_table,
+        mulcov_table,
+        w_info_vec,
+        s_info_vec,
+        *pack_object
+    ) );
+    //
+    // data_object
+    bool        fit_simulated_data = false;
+    std::string meas_noise_effect  = "add_std_scale_all";
+    data_object.reset( new dismod_at::data_model(
+        *cov2weight_obj,
+        n_covariate,
+        fit_simulated_data,
+        meas_noise_effect,
+        rate_case,
+        bound_random,
+        ode_step_size,
+        age_avg_grid,
+        age_table,
+        time_table,
+        covariate_table,
+        subgroup_table,
+        integrand_table,
+        mulcov_table,
+        prior_table,
+        subset_data_obj,
+        subset_data_cov_value,
+        w_info_vec,
+        s_info_vec,
+        *pack_object,
+        *child_info4data
+    ) );
+    data_object->replace_like(subset_data_obj);
+    //
+    // prior_object
+    prior_object.reset( new dismod_at::prior_model(
+        *pack_object, *var2prior, prior_table, density_table
+    ) );
+    //
+    // pack_vec
+    // rates that vary with age and time, random effects that are small
+    pack_vec.resize( pack_object->size() );
+    for(size_t i = 0; i < pack_vec.size(); ++i)
+        pack_vec[i] = 0.01 * double(1 + i % 7);
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+# ifndef DISMOD_AT_BENCH_MODEL_HPP
+# define DISMOD_AT_BENCH_MODEL_HPP
+
+# include <memory>
+# include <dismod_at/child_info.hpp>
+# include <dismod_at/data_model.hpp>
+# include <dismod_at/prior_model.hpp>
+# include <dismod_at/avg_integrand.hpp>
+
+// A synthetic model used by bench_dismod_at.
+// The objects below keep references to the tables, so the tables are
+// members of this class and it cannot be copied.
+class bench_model {
+public:
+    // arguments to the constructor
+    const size_t n_child;
+    const double ode_step_size;
+    const size_t n_data;
+    //
+    // tables
+    CppAD::vector<double>                          age_table;
+    CppAD::vector<double>                          time_table;
+    CppAD::vector<dismod_at::density_enum>         density_table;
+    CppAD::vector<dismod_at::prior_struct>         prior_table;
+    CppAD::vector<dismod_at::weight_info>          w_info_vec;
+    CppAD::vector<dismod_at::smooth_info>          s_info_vec;
+    CppAD::vector<dismod_at::integrand_struct>     integrand_table;
+    CppAD::vector<dismod_at::node_struct>          node_table;
+    CppAD::vector<dismod_at::covariate_struct>     covariate_table;
+    CppAD::vector<dismod_at::data_struct>          data_table;
+    CppAD::vector<double>                          data_cov_value;
+    CppAD::vector<dismod_at::subgroup_struct>      subgroup_table;
+    CppAD::vector<dismod_at::smooth_struct>        smooth_table;
+    CppAD::vector<dismod_at::mulcov_struct>        mulcov_table;
+    CppAD::vector<dismod_at::rate_struct>          rate_table;
+    CppAD::vector<dismod_at::subset_data_struct>   subset_data_obj;
+    CppAD::vector<double>                          subset_data_cov_value;
+    CppAD::vector<double>                          age_avg_grid;
+    //
+    // objects
+    std::unique_ptr<dismod_at::cov2weight_map>     cov2weight_obj;
+    std::unique_ptr<dismod_at::child_info>         child_info4data;
+    std::unique_ptr<dismod_at::pack_info>          pack_object;
+    std::unique_ptr<dismod_at::pack_prior>         var2prior;
+    std::unique_ptr<dismod_at::avg_integrand>      avgint_object;
+    std::unique_ptr<dismod_at::data_model>         data_object;
+    std::unique_ptr<dismod_at::prior_model>        prior_object;
+    //
+    // value for all the model variables
+    CppAD::vector<double>                          pack_vec;
+    //
+    // ctor
+    bench_model(size_t n_child, double ode_step_size, size_t n_data);
+    bench_model(const bench_model&) = delete;
+    bench_model& operator=(const bench_model&) = delete;
+};
+
+# endif
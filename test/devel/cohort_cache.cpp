@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: AGPL-3.0-or-later
+// SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
+// ----------------------------------------------------------------------------
+/*
+Test that like_all, which uses the cohort cache, gives the same results
+as computing each average integrand separately (without the cache).
+Also test that like_all_avg and average_all do not depend on the
+number of threads.
+*/
+# include <limits>
+# include <dismod_at/data_model.hpp>
+# include <dismod_at/null_int.hpp>
+# include <dismod_at/age_avg_grid.hpp>
+# include <dismod_at/cov2weight_map.hpp>
+
+bool cohort_cache(void)
+{   bool   ok = true;
+    using CppAD::vector;
+    typedef double Float;
+    //
+    // ode_step_size
+    double ode_step_size = 5.0;
+    //
+    // age_table
+    vector<double> age_table;
+    for(size_t i = 0; i <= 5; ++i)
+        age_table.push_back( double(i) * 20.0 );
+    size_t n_age_table = age_table.size();
+    //
+    // time_table
+    vector<double> time_table(2);
+    time_table[0] = 1980.0;
+    time_table[1] = 2020.0;
+    size_t n_time_table = time_table.size();
+    //
+    // density table
+    size_t n_density = dismod_at::number_density_enum;
+    vector<dismod_at::density_enum> density_table(n_density);
+    for(size_t density_id = 0; density_id < n_density; ++density_id)
+        density_table[density_id] = dismod_at::density_enum(density_id);
+    //
+    // age and time smoothing grid indices
+    size_t n_age_si   = n_age_table;
+    size_t n_time_si  = n_time_table;
+    vector<size_t> age_id(n_age_si), time_id(n_time_si);
+    for(size_t i = 0; i < n_age_si; ++i)
+        age_id[i] = i;
+    for(size_t j = 0; j < n_time_si; ++j)
+        time_id[j] = j;
+    //
+    // w_info_vec
+    size_t n_si = n_age_si * n_time_si;
+    vector<double> weight(n_si);
+    for(size_t k = 0; k < n_si; k++)
+        weight[k] = 1.0 + double(k);
+    dismod_at::weight_info w_info(
+        age_table, time_table, age_id, time_id, weight
+    );
+    vector<dismod_at::weight_info> w_info_vec(2);
+    w_info_vec[0] = w_info;
+    //
+    // prior table
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    vector<dismod_at::prior_struct> prior_table(1);
+    prior_table[0].prior_name = "prior_zero";
+    prior_table[0].density_id = size_t( dismod_at::uniform_enum );
+    prior_table[0].lower      = 0.0;
+    prior_table[0].upper      = 1.0;
+    prior_table[0].mean       = 0.1;
+    prior_table[0].std        = nan;
+    prior_table[0].eta        = nan;
+    //
+    // s_info_vec
+    // smooth_id = 0 is for rates, smooth_id = 1 is for pini
+    vector<dismod_at::smooth_info> s_info_vec(2);
+    size_t mulstd_value = 1, mulstd_dage = 1, mulstd_dtime = 1;
+    bool all_const_value = false;
+    for(size_t smooth_id = 0; smooth_id < 2; smooth_id++)
+    {   vector<size_t> age_id_tmp;
+        if( smooth_id == 0 )
+        {   n_si       = n_age_si * n_time_si;
+            age_id_tmp = age_id;
+        }
+        else
+        {   n_si = n_time_si;
+            age_id_tmp.resize(1);
+            age_id_tmp[0] = 0;
+        }
+        //
+        vector<size_t> value_prior_id(n_si),
+            dage_prior_id(n_si), dtime_prior_id(n_si);
+        for(size_t i = 0; i < n_si; i++)
+            value_prior_id[i] = 0;
+        vector<double> const_value(n_si);
+        for(size_t i = 0; i < n_si; ++i)
+            const_value[i] = nan;
+        dismod_at::smooth_info s_info(
+            age_table, time_table, age_id_tmp, time_id,
+            value_prior_id, dage_prior_id, dtime_prior_id, const_value,
+            mulstd_value, mulstd_dage, mulstd_dtime, all_const_value
+        );
+        s_info_vec[smooth_id] = s_info;
+    }
+    //
+    // integrand_table
+    size_t n_integrand = dismod_at::number_integrand_enum;
+    vector<dismod_at::integrand_struct> integrand_table(n_integrand);
+    for(size_t i = 0; i < n_integrand; i++)
+    {   integrand_table[i].integrand       = dismod_at::integrand_enum(i);
+        integrand_table[i].minimum_meas_cv = 0.0;
+    }
+    //
+    // n_node, node_table:
+    size_t n_node = 1;
+    CppAD::vector<dismod_at::node_struct> node_table(n_node);
+    node_table[0].parent = DISMOD_AT_NULL_INT;
+    //
+    // parent_node_id
+    size_t parent_node_id = 0;
+    //
+    // covariate table
+    size_t n_covariate = 0;
+    vector<dismod_at::covariate_struct> covariate_table(n_covariate);
+    //
+    // cov2weight_obj
+    size_t n_weight = 1;
+    std::string splitting_covariate = "";
+    CppAD::vector<dismod_at::rate_eff_cov_struct> rate_eff_cov_table(0);
+    dismod_at::cov2weight_map cov2weight_obj(
+        n_node,
+        n_weight,
+        splitting_covariate,
+        covariate_table,
+        rate_eff_cov_table
+    );
+    //
+    // data_table
+    // Many of these data points have cohorts in common; e.g., all the data
+    // with the same time_lower share the cohorts that start at time_lower.
+    dismod_at::integrand_enum integrand[] = {
+        dismod_at::prevalence_enum,
+        dismod_at::prevalence_enum,
+        dismod_at::Tincidence_enum,
+        dismod_at::mtspecific_enum,
+        dismod_at::prevalence_enum,
+        dismod_at::mtall_enum,
+        dismod_at::prevalence_enum,
+        dismod_at::mtother_enum
+    };
+    double age_lower[]  = { 20., 20., 40.,   0., 60., 10., 20., 20. };
+    double age_upper[]  = { 40., 60., 60., 100., 60., 90., 40., 60. };
+    double time_lower[] = {
+        1990., 1990., 1990., 1990., 2000., 1995., 1990., 1990.
+    };
+    double time_upper[] = {
+        2000., 2000., 1990., 2010., 2000., 2005., 2000., 2000.
+    };
+    size_t n_data = sizeof(age_lower) / sizeof(age_lower[0]);
+    vector<dismod_at::data_struct> data_table(n_data);
+    vector<double> data_cov_value(n_data * n_covariate);
+    for(size_t data_id = 0; data_id < n_data; data_id++)
+    {   data_table[data_id].integrand_id = int( integrand[data_id] );
+        data_table[data_id].node_id      = int( 0 );
+        data_table[data_id].subgroup_id  = int( 0 );
+        data_table[data_id].weight_id    = int( 0 );
+        data_table[data_id].age_lower    = age_lower[data_id];
+        data_table[data_id].age_upper    = age_upper[data_id];
+        data_table[data_id].time_lower   = time_lower[data_id];
+        data_table[data_id].time_upper   = time_upper[data_id];
+        data_table[data_id].meas_value   = 0.01;
+        data_table[data_id].meas_std     = 0.001;
+        data_table[data_id].eta          = 1e-4;
+        data_table[data_id].nu           = 5.0;
+        data_table[data_id].density_id   = int( dismod_at::gaussian_enum );
+        data_table[data_id].hold_out     = 0;
+        data_table[data_id].sample_size  = DISMOD_AT_NULL_INT;
+    }
+    //
+    // subgroup_table
+    size_t n_subgroup = 1;
+    vector<dismod_at::subgroup_struct> subgroup_table(n_subgroup);
+    subgroup_table[0].subgroup_name = "world";
+    subgroup_table[0].group_id      = 0;
+    subgroup_table[0].group_name    = "world";
+    //
+    // smooth_table
+    vector<dismod_at::smooth_struct> smooth_table(s_info_vec.size());
+    for(size_t smooth_id = 0; smooth_id < s_info_vec.size(); smooth_id++)
+    {   smooth_table[smooth_id].n_age  =
+            int( s_info_vec[smooth_id].age_size() );
+        smooth_table[smooth_id].n_time =
+            int( s_info_vec[smooth_id].time_size() );
+    }
+    // mulcov_table
+    vector<dismod_at::mulcov_struct> mulcov_table(0);
+    // rate_table
+    vector<dismod_at::rate_struct>   rate_table(dismod_at::number_rate_enum);
+    for(size_t rate_id = 0; rate_id < rate_table.size(); rate_id++)
+    {   size_t smooth_id = 0;
+        if( rate_id == dismod_at::pini_enum )
+            smooth_id = 1; // only one age
+        rate_table[rate_id].parent_smooth_id =  int( smooth_id );
+        rate_table[rate_id].child_smooth_id  =  int( smooth_id );
+        rate_table[rate_id].child_nslist_id  =  int( DISMOD_AT_NULL_INT );
+    }
+    // child_info
+    dismod_at::child_info child_info4data(
+        parent_node_id ,
+        node_table     ,
+        data_table
+    );
+    size_t n_child = child_info4data.child_size();
+    assert( n_child == 0 );
+    // pack_object
+    vector<size_t> child_id2node_id(n_child);
+    vector<dismod_at::nslist_pair_struct> nslist_pair(0);
+    dismod_at::pack_info pack_object(
+        n_integrand,
+        child_id2node_id,
+        subgroup_table,
+        smooth_table,
+        mulcov_table,
+        rate_table,
+        nslist_pair
+    );
+    // subset_data
+    vector<dismod_at::subset_data_struct> subset_data_obj;
+    vector<double> subset_data_cov_value;
+    std::map<std::string, std::string> option_map;
+    vector<dismod_at::data_subset_struct> data_subset_table(n_data);
+    for(size_t i = 0; i < n_data; ++i)
+    {   data_subset_table[i].data_id    = int(i);
+        data_subset_table[i].hold_out   = 0;
+        data_subset_table[i].density_id = data_table[i].density_id;
+        data_subset_table[i].eta        = data_table[i].eta;
+        data_subset_table[i].nu         = data_table[i].nu;
+    }
+    subset_data(
+        option_map,
+        data_subset_table,
+        integrand_table,
+        density_table,
+        data_table,
+        data_cov_value,
+        covariate_table,
+        child_info4data,
+        subset_data_obj,
+        subset_data_cov_value
+    );
+    //
+    // data_model
+    double bound_random = std::numeric_limits<double>::infinity();
+    bool        fit_simulated_data = false;
+    std::string meas_noise_effect = "add_std_scale_all";
+    std::string rate_case       = "iota_pos_rho_pos";
+    std::string age_avg_split   = "";
+    vector<double> age_avg_grid = dismod_at::age_avg_grid(
+        ode_step_size, age_avg_split, age_table
+    );
+    dismod_at::data_model data_object(
+        cov2weight_obj,
+        n_covariate,
+        fit_simulated_data,
+        meas_noise_effect,
+        rate_case,
+        bound_random,
+        ode_step_size,
+        age_avg_grid,
+        age_table,
+        time_table,
+        covariate_table,
+        subgroup_table,
+        integrand_table,
+        mulcov_table,
+        prior_table,
+        subset_data_obj,
+        subset_data_cov_value,
+        w_info_vec,
+        s_info_vec,
+        pack_object,
+        child_info4data
+    );
+    data_object.replace_like(subset_data_obj);
+    //
+    // pack_vec
+    // rates that vary with age and time
+    vector<Float> pack_vec( pack_object.size() );
+    for(size_t i = 0; i < pack_object.size(); ++i)
+        pack_vec[i] = 0.01 * double(1 + i % 7);
+    //
+    // residual_vec
+    bool hold_out      = false;
+    bool random_depend = false;
+    CppAD::vector< dismod_at::residual_struct<Float> > residual_vec =
+        data_object.like_all(hold_out, random_depend, pack_vec);
+    ok &= residual_vec.size() == n_data;
+    //
+    // check that the cohort cache does not change the results
+    for(size_t subset_id = 0; subset_id < n_data; ++subset_id)
+    {   Float avg = data_object.average(subset_id, pack_vec);
+        Float not_used;
+        dismod_at::residual_struct<Float> check =
+            data_object.like_one(subset_id, pack_vec, avg, not_used);
+        ok &= residual_vec[subset_id].index         == check.index;
+        ok &= residual_vec[subset_id].wres          == check.wres;
+        ok &= residual_vec[subset_id].logden_smooth == check.logden_smooth;
+        ok &= residual_vec[subset_id].logden_sub_abs == check.logden_sub_abs;
+    }
+    //
+    // second call to like_all with a different pack_vec
+    for(size_t i = 0; i < pack_object.size(); ++i)
+        pack_vec[i] *= 2.0;
+    residual_vec = data_object.like_all(hold_out, random_depend, pack_vec);
+    for(size_t subset_id = 0; subset_id < n_data; ++subset_id)
+    {   Float avg = data_object.average(subset_id, pack_vec);
+        Float not_used;
+        dismod_at::residual_struct<Float> check =
+            data_object.like_one(subset_id, pack_vec, avg, not_used);
+        ok &= residual_vec[subset_id].wres == check.wres;
+    }
+    //
+    // check that the number of threads does not change the results
+    size_t n_thread = 3;
+    vector<double> avg_vec, delta_vec, avg_thread, delta_thread;
+    CppAD::vector< dismod_at::residual_struct<double> > residual_thread;
+    data_object.like_all_avg(pack_vec, avg_vec, delta_vec, residual_vec);
+    data_object.set_thread_count(n_thread);
+    data_object.like_all_avg(
+        pack_vec, avg_thread, delta_thread, residual_thread
+    );
+    for(size_t subset_id = 0; subset_id < n_data; ++subset_id)
+    {   ok &= avg_vec[subset_id]   == avg_thread[subset_id];
+        ok &= delta_vec[subset_id] == delta_thread[subset_id];
+        ok &= residual_vec[subset_id].wres == residual_thread[subset_id].wres;
+    }
+    //
+    // average_all
+    size_t n_sample = 5;
+    size_t n_var    = pack_object.size();
+    vector<double> variable_value(n_sample * n_var);
+    for(size_t sample_index = 0; sample_index < n_sample; ++sample_index)
+    {   for(size_t var_id = 0; var_id < n_var; ++var_id)
+            variable_value[sample_index * n_var + var_id] =
+                pack_vec[var_id] * double(1 + sample_index);
+    }
+    size_t error_id;
+    data_object.average_all(n_sample, variable_value, avg_thread, error_id);
+    ok &= avg_thread.size() == n_sample * n_data;
+    data_object.set_thread_count(1);
+    for(size_t sample_index = 0; sample_index < n_sample; ++sample_index)
+    {   for(size_t var_id = 0; var_id < n_var; ++var_id)
+            pack_vec[var_id] = variable_value[sample_index * n_var + var_id];
+        for(size_t subset_id = 0; subset_id < n_data; ++subset_id)
+        {   double avg = data_object.average(subset_id, pack_vec);
+            ok &= avg == avg_thread[sample_index * n_data + subset_id];
+        }
+    }
+    //
+    return ok;
+}
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 // BEGIN C++
 # include <limits>
@@ -104,6 +104,25 @@ bool grid2line(void)
         // std::cout << ", check = " << check;
         // std::cout << ", result = " << result << std::endl;
     }
+    //
+    // check the sparse matrix representation of the interpolation
+    dismod_at::grid2line_csr matrix;
+    dismod_at::grid2line_matrix(
+        line_age, line_time, age_table, time_table, w_info, matrix
+    );
+    ok &= matrix.start.size() == n_line + 1;
+    for(size_t k = 0; k < n_line; k++)
+    {   size_t n_nonzero = matrix.start[k+1] - matrix.start[k];
+        ok &= 0 < n_nonzero && n_nonzero <= 4;
+        double sum = 0.0;
+        for(size_t m = matrix.start[k]; m < matrix.start[k+1]; ++m)
+            sum += matrix.val[m];
+        ok &= fabs( 1.0 - sum ) < eps99;
+    }
+    CppAD::vector<double> product_value;
+    dismod_at::grid2line_product(matrix, weight_value, product_value);
+    for(size_t k = 0; k < n_line; k++)
+        ok &= product_value[k] == line_value[k];
     return ok;
 }
 // END C++
@@ -1,6 +1,6 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 // SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-// SPDX-FileContributor: 2014-22 Bradley M. Bell
+// SPDX-FileContributor: 2014-26 Bradley M. Bell
 // ----------------------------------------------------------------------------
 # include <iostream>
 # include <cassert>
@@ -8,6 +8,7 @@
 
 // this directory
 extern bool age_time_order(void);
+extern bool cohort_cache(void);
 extern bool data_model_subset(void);
 extern bool grid2line(void);
 extern bool meas_mulcov(void);
@@ -50,6 +51,7 @@ int main(void)
 {
     // this directory
     RUN(age_time_order);
+    RUN(cohort_cache);
     RUN(data_model_subset);
     RUN(grid2line);
     RUN(meas_mulcov);
@@ -1,10 +1,11 @@
 # SPDX-License-Identifier: AGPL-3.0-or-later
 # SPDX-FileCopyrightText: University of Washington <https://www.washington.edu>
-# SPDX-FileContributor: 2014-25 Bradley M. Bell
+# SPDX-FileContributor: 2014-26 Bradley M. Bell
 # ----------------------------------------------------------------------------
 # Simulate a data set and fit it. In addition, using sample table
 # as the source in a set command.
 # Test a case where sim_std is much different from meas_std.
+# Fit both simulated data sets at the same time using sim_range.
 #
 # values used to simulate data
 iota_parent_true          = 0.01
@@ -215,6 +216,7 @@ def example_db (file_name) :
         { 'name':'ode_step_size',          'value':'10.0'              },
         { 'name':'random_seed',            'value':random_seed_str     },
         { 'name':'zero_sum_child_rate',    'value':'iota'              },
+        { 'name':'thread_count',           'value':'2'                 },
 
         { 'name':'quasi_fixed',            'value':'true'              },
         { 'name':'derivative_test_fixed',  'value':'none'              },
@@ -338,6 +340,23 @@ if max_error > 5e-2 :
     print('max_error = ', max_error)
     assert(False)
 # -----------------------------------------------------------------------------
+# fit both simulated data sets using two threads
+command = [ program, file_name, 'fit', 'both', 'sim_range', '0', '1' ]
+dismod_at.system_command_prc( command )
+fit_var_sim_table = dismod_at.get_table_dict(connection, 'fit_var_sim')
+n_var             = len(var_table)
+assert len(fit_var_sim_table) == 2 * n_var
+for simulate_index in range(2) :
+    for var_id in range( n_var ) :
+        row = fit_var_sim_table[ simulate_index * n_var + var_id ]
+        assert row['simulate_index'] == simulate_index
+        assert row['var_id'] == var_id
+        if simulate_index == 0 :
+            # same as the fit above except for the optimizer tolerance
+            fit_value = fit_var_table[var_id]['fit_var_value']
+            sim_value = row['fit_var_value']
+            assert abs(fit_value - sim_value) <= 1e-3 * abs(fit_value) + 1e-6
+# -----------------------------------------------------------------------------
 # set start_var so it corresponds to second set of model variables
 command = [ program, file_name, 'sample', 'simulate', 'both', '2' ]
 dismod_at.system_command_prc(command)